@@ -0,0 +1,127 @@
+// Copyright 2022 gab
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+// Benchmark of what logging costs the thread that logs, like the audio and network threads do: the synchronous
+// logger the plugin had, the asynchronous one of init_logging(), a rate limited call site that's mostly skipped and a
+// call below the logger's level. "nothing" is the loop and its two clock reads alone. All write to log file, the
+// null device by default, give a file on a slow disk to see what a blocking write costs.
+//
+//   logging_bench [logging threads] [messages per thread] [log file]
+//
+// Built with -DS2T_OBS_BUILD_BENCHMARKS=ON, needs no OBS, Qt or gRPC.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <spdlog/sinks/basic_file_sink.h>
+
+#include "backend/logging.h"
+
+#if _WIN32
+#define NULL_DEVICE "NUL"
+#else
+#define NULL_DEVICE "/dev/null"
+#endif
+
+struct RunResult {
+    double ns_per_message = 0;
+    double max_us = 0;
+};
+
+// every thread logs messages, the slowest single call is kept
+static RunResult run(int threads, int messages, const std::function<void(int thread, int i)> &log_one) {
+    std::vector<double> max_us(threads * 8, 0);
+
+    const auto started_at = std::chrono::steady_clock::now();
+    std::vector<std::thread> loggers;
+    for (int t = 0; t < threads; t++) {
+        loggers.emplace_back([&, t]() {
+            double thread_max_us = 0;
+            for (int i = 0; i < messages; i++) {
+                const auto before = std::chrono::steady_clock::now();
+                log_one(t, i);
+                thread_max_us = std::max(thread_max_us, std::chrono::duration<double, std::micro>(
+                    std::chrono::steady_clock::now() - before).count());
+            }
+            // one cache line apart
+            max_us[t * 8] = thread_max_us;
+        });
+    }
+    for (auto &thread: loggers)
+        thread.join();
+    const double took_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - started_at).count();
+
+    RunResult result;
+    // per message on each thread, the threads log at the same time
+    result.ns_per_message = took_ns / messages;
+    for (int t = 0; t < threads; t++)
+        result.max_us = std::max(result.max_us, max_us[t * 8]);
+    return result;
+}
+
+static void print(const char *name, int threads, const RunResult &result) {
+    printf("%-14s %3d threads  %9.1f ns/message  max %9.1f us\n", name, threads, result.ns_per_message, result.max_us);
+}
+
+static void log_result(spdlog::logger &logger, int thread, int i) {
+    logger.info("result {} from stream {}: '{}', stability {}", i, thread, "the quick brown fox", 0.9);
+}
+
+int main(int argc, char **argv) {
+    const unsigned int cores = std::max(1u, std::thread::hardware_concurrency());
+    const int max_threads = argc > 1 ? atoi(argv[1]) : (int) cores;
+    const int messages = argc > 2 ? atoi(argv[2]) : 100000;
+    const char *log_file = argc > 3 ? argv[3] : NULL_DEVICE;
+    if (max_threads < 1 || messages < 1) {
+        fprintf(stderr, "usage: %s [logging threads] [messages per thread] [log file]\n", argv[0]);
+        return 1;
+    }
+
+    auto file_sink = std::make_shared<spdlog::sinks::basic_file_sink_mt>(log_file, true);
+    spdlog::logger sync_logger("sync", file_sink);
+    sync_logger.set_level(spdlog::level::info);
+
+    backend::init_logging(file_sink);
+    spdlog::logger &async_logger = *spdlog::default_logger();
+
+    printf("%u cores, %d messages per thread to %s, queue of %d\n", cores, messages, log_file, PLUGIN_LOG_QUEUE_SIZE);
+    for (int threads = 1; threads <= max_threads; threads *= 2) {
+        print("nothing", threads, run(threads, messages, [](int, int) {}));
+        print("sync", threads, run(threads, messages, [&](int t, int i) { log_result(sync_logger, t, i); }));
+
+        const uint64_t dropped_before = backend::log_stats().dropped;
+        print("async", threads, run(threads, messages, [&](int t, int i) { log_result(async_logger, t, i); }));
+        backend::flush_logging();
+        printf("%-14s %llu dropped with the queue full\n", "",
+               (unsigned long long) (backend::log_stats().dropped - dropped_before));
+
+        print("rate limited", threads, run(threads, messages, [](int t, int i) {
+            S2T_INFO_EVERY_MS(1000, "result {} from stream {}: '{}', stability {}", i, t, "the quick brown fox", 0.9);
+        }));
+        print("below level", threads, run(threads, messages, [](int t, int i) {
+            spdlog::debug("result {} from stream {}: '{}', stability {}", i, t, "the quick brown fox", 0.9);
+        }));
+    }
+
+    backend::shutdown_logging();
+    return 0;
+}
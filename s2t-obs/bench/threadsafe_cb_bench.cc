@@ -0,0 +1,154 @@
+// Copyright 2022 gab
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+// Benchmark of ThreadsafeCb against the recursive mutex version it replaced: N threads calling the callback
+// like the audio and result paths do, while another thread keeps replacing and clearing it.
+//
+//   threadsafe_cb_bench [invoker threads] [seconds per run] [microseconds between set()/clear()]
+//
+// Built with -DS2T_OBS_BUILD_BENCHMARKS=ON, needs no OBS, Qt or gRPC.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "backend/threadsafe_cb.h"
+
+using AudioCb = std::function<void(int id, const uint8_t *data, size_t size)>;
+
+// ThreadsafeCb before it went lock free, callers took the mutex around every call
+template<typename T>
+class RecursiveMutexCb {
+public:
+    T callback_fn;
+    std::recursive_mutex mutex;
+
+    void clear() {
+        std::lock_guard<std::recursive_mutex> lock(mutex);
+        callback_fn = nullptr;
+    }
+
+    void set(T new_callback_fn) {
+        clear();
+        std::lock_guard<std::recursive_mutex> lock(mutex);
+        callback_fn = new_callback_fn;
+    }
+
+    template<typename... Args>
+    bool invoke(Args &&... args) {
+        std::lock_guard<std::recursive_mutex> lock(mutex);
+        if (!callback_fn)
+            return false;
+
+        callback_fn(std::forward<Args>(args)...);
+        return true;
+    }
+};
+
+struct RunResult {
+    uint64_t calls = 0;
+    uint64_t called = 0;
+    uint64_t replacements = 0;
+    double max_replace_us = 0;
+};
+
+static std::atomic<uint64_t> sink{0};
+
+static AudioCb make_callback() {
+    return [](int id, const uint8_t *data, size_t size) {
+        sink.fetch_add(id + data[size - 1], std::memory_order_relaxed);
+    };
+}
+
+template<typename Cb>
+static RunResult run(int invokers, double seconds, int replace_every_us) {
+    Cb cb;
+    cb.set(make_callback());
+
+    std::atomic<bool> stop{false};
+    std::vector<uint64_t> calls(invokers * 8, 0);
+    std::vector<uint64_t> called(invokers * 8, 0);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < invokers; t++) {
+        threads.emplace_back([&, t]() {
+            uint8_t buffer[64] = {1};
+            uint64_t thread_calls = 0, thread_called = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                thread_called += cb.invoke(t, buffer, sizeof(buffer));
+                thread_calls++;
+            }
+            // one cache line apart, counting shouldn't be what's measured
+            calls[t * 8] = thread_calls;
+            called[t * 8] = thread_called;
+        });
+    }
+
+    RunResult result;
+    const auto end = std::chrono::steady_clock::now() + std::chrono::duration<double>(seconds);
+    bool set_next = false;
+    while (std::chrono::steady_clock::now() < end) {
+        std::this_thread::sleep_for(std::chrono::microseconds(replace_every_us));
+        const auto before = std::chrono::steady_clock::now();
+        if (set_next)
+            cb.set(make_callback());
+        else
+            cb.clear();
+        const double took_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - before).count();
+        result.max_replace_us = std::max(result.max_replace_us, took_us);
+        result.replacements++;
+        set_next = !set_next;
+    }
+    stop = true;
+    for (auto &thread : threads)
+        thread.join();
+
+    for (int t = 0; t < invokers; t++) {
+        result.calls += calls[t * 8];
+        result.called += called[t * 8];
+    }
+    return result;
+}
+
+static void print(const char *name, int invokers, double seconds, const RunResult &result) {
+    printf("%-20s %3d threads  %8.2f M calls/s  %6.1f%% called  %7llu set/clear  max %9.1f us\n",
+           name, invokers, result.calls / seconds / 1e6, result.calls ? 100.0 * result.called / result.calls : 0.0,
+           (unsigned long long) result.replacements, result.max_replace_us);
+}
+
+int main(int argc, char **argv) {
+    const unsigned int cores = std::max(1u, std::thread::hardware_concurrency());
+    const int invokers = argc > 1 ? atoi(argv[1]) : (int) cores;
+    const double seconds = argc > 2 ? atof(argv[2]) : 2.0;
+    const int replace_every_us = argc > 3 ? atoi(argv[3]) : 1000;
+    if (invokers < 1 || seconds <= 0 || replace_every_us < 0) {
+        fprintf(stderr, "usage: %s [invoker threads] [seconds per run] [microseconds between set()/clear()]\n", argv[0]);
+        return 1;
+    }
+
+    printf("%u cores, set()/clear() every %d us\n", cores, replace_every_us);
+    for (int threads = 1; threads <= invokers; threads *= 2) {
+        print("ThreadsafeCb", threads, seconds, run<backend::ThreadsafeCb<AudioCb>>(threads, seconds, replace_every_us));
+        print("recursive_mutex", threads, seconds, run<RecursiveMutexCb<AudioCb>>(threads, seconds, replace_every_us));
+    }
+    return 0;
+}
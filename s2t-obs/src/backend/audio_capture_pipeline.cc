@@ -18,6 +18,9 @@
 
 #include "spdlog/spdlog.h"
 
+#include "logging.h"
+#include "trace.h"
+
 namespace backend {
 
 static void audio_captured(void *param, obs_source_t *source, const struct audio_data *audio, bool muted) {
@@ -73,7 +76,7 @@ AudioCapturePipeline::AudioCapturePipeline(
             obs_audio->speakers
         };
 
-        spdlog::info("creating new resampler (%d, %d, %d) -> (%d, %d, %d)", src.samples_per_sec, src.format, src.speakers,
+        spdlog::info("creating new resampler ({}, {}, {}) -> ({}, {}, {})", src.samples_per_sec, src.format, src.speakers,
                  resample_to.samples_per_sec, resample_to.format, resample_to.speakers);
 
         // All audio data from sources gets resampled to the main OBS audio settings before given to the
@@ -86,16 +89,16 @@ AudioCapturePipeline::AudioCapturePipeline(
     }
 
     const char *name = obs_source_get_name(audio_source);
-    spdlog::info("source %s active: %d", name, obs_source_active(audio_source));
+    spdlog::info("source {} active: {}", name, obs_source_active(audio_source));
 
     if (muting_source) {
         use_multiple_cb_signal = false;
 
         const char *muting_name = obs_source_get_name(muting_source);
-        spdlog::info("using separate muting source %s active: %d", muting_name, obs_source_active(muting_source));
+        spdlog::info("using separate muting source {} active: {}", muting_name, obs_source_active(muting_source));
     } else {
         muting_source = audio_source;
-        spdlog::info("using direct source %s active: %d", muting_name, obs_source_active(audio_source));       
+        spdlog::info("using direct source {} active: {}", muting_name, obs_source_active(audio_source));       
     }
 
     if (!muting_source)
@@ -120,13 +123,9 @@ void AudioCapturePipeline::state_changed_check(bool always_signal) {
     if (!always_signal && new_status == capture_status)
         return;
 
-    spdlog::debug("AudioCapturePipeline %d status changed %s %d", id, obs_source_get_name(muting_source), new_status);
+    spdlog::debug("AudioCapturePipeline {} status changed {} {}", id, obs_source_get_name(muting_source), new_status);
     capture_status = new_status;
-    {
-        std::lock_guard<std::recursive_mutex> lock(on_status_cb_handle.mutex);
-        if (on_status_cb_handle.callback_fn)
-            on_status_cb_handle.callback_fn(id, new_status);
-    }
+    on_status_cb_handle.invoke(id, new_status);
 }
 
 audio_source_capture_status AudioCapturePipeline::check_source_status() {
@@ -145,12 +144,14 @@ audio_source_capture_status AudioCapturePipeline::check_source_status() {
 }
 
 void AudioCapturePipeline::audio_capture_cb(obs_source_t *source, const struct audio_data *audio, bool muted) {
-    if (!on_caption_cb_handle.callback_fn)
+    if (on_caption_cb_handle.empty())
         return;
 
     if (!audio || !audio->frames)
         return;
 
+    S2T_TRACE_SPAN("audio_capture_cb");
+
     if (muted && !use_muting_cb_signal)
         muted = false;
 
@@ -162,11 +163,7 @@ void AudioCapturePipeline::audio_capture_cb(obs_source_t *source, const struct a
             const unsigned int size = audio->frames * bytes_per_channel;
             uint8_t *buffer = new uint8_t[size];
             memset(buffer, 0, size);
-            {
-                std::lock_guard<std::recursive_mutex> lock(on_caption_cb_handle.mutex);
-                if (on_caption_cb_handle.callback_fn)
-                    on_caption_cb_handle.callback_fn(id, buffer, size);
-            }
+            on_caption_cb_handle.invoke(id, buffer, size);
 
             delete[] buffer;
             return;
@@ -179,11 +176,7 @@ void AudioCapturePipeline::audio_capture_cb(obs_source_t *source, const struct a
     if (!resampler) {
         // correct format already, no need to resample;
         unsigned int size = audio->frames * bytes_per_channel;
-        {
-            std::lock_guard<std::recursive_mutex> lock(on_caption_cb_handle.mutex);
-            if (on_caption_cb_handle.callback_fn)
-                on_caption_cb_handle.callback_fn(id, audio->data[0], size);
-        }
+        on_caption_cb_handle.invoke(id, audio->data[0], size);
     } else {
         uint8_t *out[MAX_AV_PLANES];
         memset(out, 0, sizeof(out));
@@ -197,16 +190,12 @@ void AudioCapturePipeline::audio_capture_cb(obs_source_t *source, const struct a
         bool success = audio_resampler_resample(resampler, out, &out_frames, &ts_offset, (const uint8_t *const *) audio->data, audio->frames);
 
         if (!success || !out[0]) {
-            spdlog::warn("failed resampling audio data");
+            S2T_WARN_EVERY_MS(1000, "failed resampling audio data");
             return;
         }
 
         unsigned int size = out_frames * bytes_per_channel;
-        {
-            std::lock_guard<std::recursive_mutex> lock(on_caption_cb_handle.mutex);
-            if (on_caption_cb_handle.callback_fn)
-                on_caption_cb_handle.callback_fn(id, out[0], size);
-        }
+        on_caption_cb_handle.invoke(id, out[0], size);
     }
 }
 
@@ -46,7 +46,7 @@ AudioConverterPipeline::AudioConverterPipeline(
     if (!obs_get_audio_info(&backend_audio_settings))
         throw std::string("Failed to get OBS audio info");
 
-    spdlog::debug("output audio_info track %d: %d, %d", track_index, backend_audio_settings.samples_per_sec, backend_audio_settings.speakers);
+    spdlog::debug("output audio_info track {}: {}, {}", track_index, backend_audio_settings.samples_per_sec, backend_audio_settings.speakers);
 
     if (!bytes_per_channel)
         throw std::string("Failed to get frame bytes size per channel");
@@ -64,18 +64,14 @@ AudioConverterPipeline::AudioConverterPipeline(
 }
 
 void AudioConverterPipeline::audio_capture_cb(size_t mix_idx, const struct audio_data *audio) {
-    if (!on_caption_cb_handle.callback_fn)
+    if (on_caption_cb_handle.empty())
         return;
 
     if (!audio || !audio->frames)
         return;
 
     unsigned int size = audio->frames * bytes_per_channel;
-    {
-        std::lock_guard<std::recursive_mutex> lock(on_caption_cb_handle.mutex);
-        if (on_caption_cb_handle.callback_fn)
-            on_caption_cb_handle.callback_fn(id, audio->data[0], size);
-    }
+    on_caption_cb_handle.invoke(id, audio->data[0], size);
 }
 
 AudioConverterPipeline::~OutputAudioCaptureSession() {
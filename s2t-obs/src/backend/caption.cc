@@ -13,42 +13,61 @@
 // limitations under the License.
 
 #include <memory>
+#include <util/platform.h>
 
 #include "caption.h"
+#include "logging.h"
+#include "shutdown.h"
+#include "trace.h"
 #include "transcript.h"
 
 namespace backend {
 
 typedef std::tuple<std::string, std::string> TextOutputTup;
 
-void set_text_source_text(const std::string &text_source_name, const std::string &caption_text) {
-    obs_source_t *text_source = obs_get_source_by_name(text_source_name.c_str());
-    if (!text_source){
-        spdlog::debug("text source: {} not found, can't set caption text", text_source_name.c_str());
-        return;
+static CaptionOutputQueueMode transcript_queue_mode(const TranscriptOutputSettings &transcript_settings) {
+    // raw transcripts and journals log every single result
+    for (const auto &format: transcript_settings.formats()) {
+        if (format == "raw" || format == "journal")
+            return CAPTION_OUTPUT_QUEUE_MODE_ALL;
     }
 
-    obs_data_t *text_settings = obs_data_create();
-    obs_data_set_string(text_settings, "text", caption_text.c_str());
-    obs_source_update(text_source, text_settings);
-    obs_data_release(text_settings);
-    obs_source_release(text_source);
+    return CAPTION_OUTPUT_QUEUE_MODE_LATEST_INTERIM;
+}
+
+static uint64_t video_frame_interval_ns() {
+    obs_video_info ovi;
+    if (!obs_get_video_info(&ovi) || !ovi.fps_num)
+        return 0;
+
+    return 1000000000ULL * ovi.fps_den / ovi.fps_num;
 }
 
 SourceCaptioner::SourceCaptioner(const bool enabled, const SourceCaptionerSettings &settings, const std::string &scene_collection_name, bool start) :
         QObject(),
         base_enabled(enabled),
-        settings(settings),
-        selected_scene_collection_name(scene_collection_name),
+        settings_snapshot(std::make_shared<SourceCaptionerSettingsSnapshot>(1, settings, scene_collection_name)),
         last_caption_at(std::chrono::steady_clock::now()),
-        last_caption_cleared(true) {
+        last_caption_cleared(true),
+        output_executor("caption outputs") {
     
-    QObject::connect(&timer, &QTimer::timeout, this, &SourceCaptioner::clear_output_timer_cb);
-    QObject::connect(this, &SourceCaptioner::received_caption_result, this, &SourceCaptioner::process_caption_result, Qt::QueuedConnection);
+    processing_thread.setObjectName("s2t caption processing");
+    processing_context.moveToThread(&processing_thread);
+    held_interim_timer.moveToThread(&processing_thread);
+    held_interim_timer.setSingleShot(true);
+
+    QObject::connect(&processing_thread, &QThread::finished, &held_interim_timer, &QTimer::stop, Qt::DirectConnection);
+    QObject::connect(&held_interim_timer, &QTimer::timeout, &processing_context, [this]() {
+        held_interim_timer_cb();
+    });
+    QObject::connect(this, &SourceCaptioner::received_caption_result, &processing_context,
+                     [this](RawResultPtr caption_result, bool interrupted) {
+        process_caption_result(caption_result, interrupted);
+    }, Qt::QueuedConnection);
     QObject::connect(this, &SourceCaptioner::audio_capture_status_changed, this, &SourceCaptioner::process_audio_capture_status_change);
-    timer.start(1000);
+    processing_thread.start();
 
-    const SceneCollectionSettings &scene_col_settings = this->settings.get_scene_collection_settings(scene_collection_name);
+    const SceneCollectionSettings &scene_col_settings = settings.get_scene_collection_settings(scene_collection_name);
     spdlog::debug("SourceCaptioner, source '{}'", scene_col_settings.caption_source_settings.caption_source_name.c_str());
 
     if (start)
@@ -60,60 +79,91 @@ void SourceCaptioner::stop_caption_stream(bool send_signal) {
         std::lock_guard<recursive_mutex> lock(settings_change_mutex);
         source_audio_capture_session = nullptr;
         output_audio_capture_session = nullptr;
-        caption_result_handler = nullptr;
+        std::atomic_store(&caption_result_handler, std::shared_ptr<CaptionResultHandler>());
         continuous_captions = nullptr;
         audio_capture_id++;
+        reset_interim_pacing();
         return;
     }
 
     settings_change_mutex.lock();
 
-    SourceCaptionerSettings cur_settings = settings;
-    string cur_scene_collection_name = this->selected_scene_collection_name;
+    const auto cur_settings = current_settings();
 
     source_audio_capture_session = nullptr;
     output_audio_capture_session = nullptr;
-    caption_result_handler = nullptr;
+    std::atomic_store(&caption_result_handler, std::shared_ptr<CaptionResultHandler>());
+    ResultPoolStats pool_stats;
+    if (continuous_captions)
+        pool_stats = continuous_captions->result_pool_stats();
     continuous_captions = nullptr;
     audio_capture_id++;
+    reset_interim_pacing();
 
     settings_change_mutex.unlock();
 
+    const InterimPacingStats pacing_stats = interim_pacer.stats();
+    spdlog::info("caption results so far: {} finals, {} interim updates, {} interims dropped unstable, {} superseded while held back",
+                 pacing_stats.finals, pacing_stats.interim_updates, pacing_stats.dropped_unstable, pacing_stats.dropped_superseded);
+    spdlog::info("caption result pool: {} results, {} heap allocations", pool_stats.results, pool_stats.heap_allocations);
+
     if (send_signal) {
         emit source_capture_status_changed(std::make_shared<SourceCaptionerStatus>(
             SOURCE_CAPTIONER_STATUS_EVENT_STOPPED,
             false,
             false,
-            cur_settings,
-            cur_scene_collection_name,
+            cur_settings->settings,
+            cur_settings->scene_collection_name,
             AUDIO_SOURCE_NOT_STREAMED,
             false
         ));
     }
 }
 
+void SourceCaptioner::apply_settings_live(const SourceCaptionerSettingsSnapshot &previous) {
+    const auto cur_settings = current_settings();
+
+    // text outputs, the stream/recording outputs and transcripts are read from the snapshot for every result,
+    // only the formatter keeps its own copy of the settings
+    if (previous.settings.format_settings != cur_settings->settings.format_settings)
+        std::atomic_store(&caption_result_handler, std::make_shared<CaptionResultHandler>(cur_settings->settings.format_settings));
+
+    spdlog::info("SourceCaptioner applied settings v{} live, inference stream kept", cur_settings->version);
+}
+
 bool SourceCaptioner::set_settings(const SourceCaptionerSettings &new_settings, const string &scene_collection_name) {
     bool settings_equal;
     bool stream_settings_equal;
+    bool applied_live = false;
+    audio_source_capture_status audio_cap_status = AUDIO_SOURCE_NOT_STREAMED;
     {
         std::lock_guard<recursive_mutex> lock(settings_change_mutex);
-        stop_caption_stream(false);
+        const bool capturing = is_capturing();
 
-        settings_equal = settings == new_settings;
-        stream_settings_equal = settings.stream_settings == new_settings.stream_settings;
+        const auto previous = publish_settings(new_settings, scene_collection_name);
+        settings_equal = previous->settings == new_settings;
+        stream_settings_equal = previous->settings.stream_settings == new_settings.stream_settings;
 
-        settings = new_settings;
-        selected_scene_collection_name = scene_collection_name;
+        if (capturing && previous->change_to(new_settings, scene_collection_name).live()) {
+            apply_settings_live(*previous);
+            applied_live = true;
+            if (source_audio_capture_session)
+                audio_cap_status = source_audio_capture_session->get_current_capture_status();
+            else
+                audio_cap_status = AUDIO_SOURCE_CAPTURING;
+        } else {
+            stop_caption_stream(false);
+        }
     }
 
     emit source_capture_status_changed(std::make_shared<SourceCaptionerStatus>(
-        SOURCE_CAPTIONER_STATUS_EVENT_NEW_SETTINGS_STOPPED,
+        applied_live ? SOURCE_CAPTIONER_STATUS_EVENT_NEW_SETTINGS_APPLIED : SOURCE_CAPTIONER_STATUS_EVENT_NEW_SETTINGS_STOPPED,
         !settings_equal,
         !stream_settings_equal,
         new_settings,
         scene_collection_name,
-        AUDIO_SOURCE_NOT_STREAMED,
-        false
+        audio_cap_status,
+        applied_live
     ));
 
     return true;
@@ -127,18 +177,32 @@ bool SourceCaptioner::start_caption_stream(const SourceCaptionerSettings &new_se
 
     {
         std::lock_guard<recursive_mutex> lock(settings_change_mutex);
-        settings_equal = settings == new_settings;
-        stream_settings_equal = settings.stream_settings == new_settings.stream_settings;
-
-        settings = new_settings;
-        selected_scene_collection_name = scene_collection_name;
-
-        source_audio_capture_session = nullptr;
-        output_audio_capture_session = nullptr;
-        caption_result_handler = nullptr;
-        audio_capture_id++;
+        const bool capturing = is_capturing();
+        const auto previous = publish_settings(new_settings, scene_collection_name);
+        settings_equal = previous->settings == new_settings;
+        stream_settings_equal = previous->settings.stream_settings == new_settings.stream_settings;
+        const SourceCaptionerSettingsChange change = previous->change_to(new_settings, scene_collection_name);
+
+        if (capturing && change.live()) {
+            apply_settings_live(*previous);
+            started_ok = true;
+        } else if (capturing && !change.stream) {
+            // other caption or mute source, the inference stream stays connected
+            source_audio_capture_session = nullptr;
+            output_audio_capture_session = nullptr;
+            audio_capture_id++;
+
+            started_ok = _start_caption_stream(false, false);
+            if (started_ok)
+                apply_settings_live(*previous);
+        } else {
+            source_audio_capture_session = nullptr;
+            output_audio_capture_session = nullptr;
+            std::atomic_store(&caption_result_handler, std::shared_ptr<CaptionResultHandler>());
+            audio_capture_id++;
 
-        started_ok = _start_caption_stream(!stream_settings_equal);
+            started_ok = _start_caption_stream(!stream_settings_equal, true);
+        }
 
         if (!started_ok)
             stop_caption_stream(false);
@@ -180,10 +244,11 @@ bool SourceCaptioner::start_caption_stream(const SourceCaptionerSettings &new_se
     return started_ok;
 }
 
-bool SourceCaptioner::_start_caption_stream(bool restart_stream) {
+bool SourceCaptioner::_start_caption_stream(bool restart_stream, bool new_formatter) {
     bool caption_settings_equal;
     {
-        const SceneCollectionSettings &scene_col_settings = this->settings.get_scene_collection_settings(selected_scene_collection_name);
+        const auto cur_settings = current_settings();
+        const SceneCollectionSettings &scene_col_settings = cur_settings->scene_collection_settings();
         const CaptionSourceSettings &selected_caption_source_settings = scene_col_settings.caption_source_settings;
 
         spdlog::debug("SourceCaptioner start_caption_stream, source '{}'", selected_caption_source_settings.caption_source_name.c_str());
@@ -223,15 +288,17 @@ bool SourceCaptioner::_start_caption_stream(bool restart_stream) {
         if (!continuous_captions || restart_stream) {
             try {
                 auto caption_cb = std::bind(&SourceCaptioner::on_caption_text_callback, this, std::placeholders::_1, std::placeholders::_2);
-                continuous_captions = std::make_unique<ContinuousCaptions>(settings_copy);
-                continuous_captions->on_caption_cb_handle.set(caption_cb, true);
+                continuous_captions = std::make_unique<ContinuousCaptions>(cur_settings->settings.stream_settings);
+                reset_interim_pacing();
+                continuous_captions->on_caption_cb_handle.set(caption_cb);
             }
             catch (...) {
                 spdlog::warn("couldn't create ContinuousCaptions");
                 return false;
             }
         }
-        caption_result_handler = std::make_unique<CaptionResultHandler>(settings.format_settings);
+        if (new_formatter)
+            std::atomic_store(&caption_result_handler, std::make_shared<CaptionResultHandler>(cur_settings->settings.format_settings));
 
         try {
             resample_info resample_to = {16000, AUDIO_FORMAT_16BIT, SPEAKERS_MONO};
@@ -284,8 +351,6 @@ void SourceCaptioner::process_audio_capture_status_change(const int cb_audio_cap
     settings_change_mutex.lock();
 
     bool is_old_audio_session = cb_audio_capture_id != audio_capture_id;
-    SourceCaptionerSettings cur_settings = settings;
-    string cur_scene_collection_name = selected_scene_collection_name;
     bool active = continuous_captions != nullptr;
 
     settings_change_mutex.unlock();
@@ -295,12 +360,14 @@ void SourceCaptioner::process_audio_capture_status_change(const int cb_audio_cap
         return;
     }
 
+    const auto cur_settings = current_settings();
+
     emit source_capture_status_changed(std::make_shared<SourceCaptionerStatus>(
         SOURCE_CAPTIONER_STATUS_EVENT_AUDIO_CAPTURE_STATUS_CHANGE,
         false,
         false,
-        cur_settings,
-        cur_scene_collection_name,
+        cur_settings->settings,
+        cur_settings->scene_collection_name,
         (audio_source_capture_status) new_status,
         active
     ));
@@ -314,21 +381,38 @@ void SourceCaptioner::on_audio_data_callback(const int id, const uint8_t *data,
     audio_chunk_count++;
 }
 
-void SourceCaptioner::clear_output_timer_cb() {
+void SourceCaptioner::schedule_clearance_check(const std::chrono::steady_clock::time_point &check_at) {
+    // clearance_mutex held
+    clearance_check_scheduled = true;
+    output_executor.schedule_at(check_at, [this]() {
+        clear_output_timeout_cb();
+    });
+}
+
+void SourceCaptioner::clear_output_timeout_cb() {
     bool to_stream, to_recording, to_transcript_streaming, to_transcript_recording;
     std::vector<string> text_source_names;
     {
-        std::lock_guard<recursive_mutex> lock(settings_change_mutex);
-        if (!this->settings.format_settings.caption_timeout_enabled || this->last_caption_cleared)
+        const auto cur_settings = current_settings();
+        const SourceCaptionerSettings &settings = cur_settings->settings;
+
+        std::lock_guard<std::mutex> lock(clearance_mutex);
+        clearance_check_scheduled = false;
+        if (!settings.format_settings.caption_timeout_enabled || this->last_caption_cleared)
             return;
 
+        const auto timeout = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>(settings.format_settings.caption_timeout_seconds));
         double secs_since_last_caption = std::chrono::duration_cast<std::chrono::duration<double >>(
                 std::chrono::steady_clock::now() - this->last_caption_at).count();
 
-        if (secs_since_last_caption <= this->settings.format_settings.caption_timeout_seconds)
+        if (secs_since_last_caption <= settings.format_settings.caption_timeout_seconds) {
+            // captions went out since this check got scheduled
+            schedule_clearance_check(this->last_caption_at + timeout);
             return;
+        }
 
-        spdlog::info("last caption line was sent {} secs ago, > {}, clearing", secs_since_last_caption, this->settings.format_settings.caption_timeout_seconds);
+        spdlog::info("last caption line was sent {} secs ago, > {}, clearing", secs_since_last_caption, settings.format_settings.caption_timeout_seconds);
 
         this->last_caption_cleared = true;
         to_stream = settings.streaming_output_enabled;
@@ -336,7 +420,7 @@ void SourceCaptioner::clear_output_timer_cb() {
         to_transcript_streaming = settings.transcript_settings.enabled && settings.transcript_settings.streaming_transcripts_enabled;
         to_transcript_recording = settings.transcript_settings.enabled && settings.transcript_settings.recording_transcripts_enabled;
 
-        const SceneCollectionSettings &scene_col_settings = this->settings.get_scene_collection_settings(selected_scene_collection_name);
+        const SceneCollectionSettings &scene_col_settings = cur_settings->scene_collection_settings();
         for (const auto &text_out: scene_col_settings.text_outputs) {
             if (!text_out.isValidEnabled())
                 continue;
@@ -345,7 +429,7 @@ void SourceCaptioner::clear_output_timer_cb() {
     }
 
     auto now = std::chrono::steady_clock::now();
-    auto clearance = CaptionOutput(std::make_shared<OutputCaptionResult>(CaptionResult(0, false, 0, "", "", now, now), false), true);
+    auto clearance = CaptionOutput(std::make_shared<OutputCaptionResult>(std::make_shared<const RawResult>(0, false, 0, "", "", now, now), false), true);
     output_caption_writers(
         clearance,
         to_stream,
@@ -359,7 +443,7 @@ void SourceCaptioner::clear_output_timer_cb() {
     for (const auto &to_clear: text_source_names) {
         set_text_source_text(to_clear, " ");
     }
-    emit caption_result_received(nullptr, true, "");
+    emit caption_result_received(nullptr, true, nullptr);
 }
 
 void SourceCaptioner::store_result(shared_ptr<OutputCaptionResult> output_result) {
@@ -367,40 +451,17 @@ void SourceCaptioner::store_result(shared_ptr<OutputCaptionResult> output_result
         return;
 
     if (output_result->caption_result.final) {
-        results_history.push_back(output_result);
+        results_history.append(output_result->clean_caption_text, output_result->caption_result.received_at);
+        search_index.add(*output_result);
         held_nonfinal_caption_result = nullptr;
-        spdlog::debug("final, adding to history: {} {}", (int) results_history.size(), output_result->clean_caption_text.c_str());
+        SPDLOG_DEBUG("final, adding to history: {} {}", (int) results_history.size(), output_result->clean_caption_text);
     } else {
         held_nonfinal_caption_result = output_result;
     }
-
-    if (results_history.size() > HISTORY_ENTRIES_HIGH_WM) {
-        results_history.erase(results_history.begin(), results_history.begin() + HISTORY_ENTRIES_LOW_WM);
-    }
 }
 
 void SourceCaptioner::prepare_recent(string &recent_captions_output) {
-    for (auto i = results_history.rbegin(); i != results_history.rend(); ++i) {
-        if (!(*i))
-            break;
-
-        if (!(*i)->caption_result.final)
-            break;
-
-        if (recent_captions_output.size() + (*i)->clean_caption_text.size() >= MAX_HISTORY_VIEW_LENGTH)
-            break;
-
-        if ((*i)->clean_caption_text.empty())
-            continue;
-
-        if (recent_captions_output.empty()) {
-            recent_captions_output.insert(0, 1, '.');
-        } else {
-            recent_captions_output.insert(0, ". ");
-        }
-
-        recent_captions_output.insert(0, (*i)->clean_caption_text);
-    }
+    results_history.recent_text(recent_captions_output);
 
     if (held_nonfinal_caption_result) {
         if (!recent_captions_output.empty())
@@ -410,35 +471,83 @@ void SourceCaptioner::prepare_recent(string &recent_captions_output) {
     }
 }
 
-void SourceCaptioner::on_caption_text_callback(const CaptionResult &caption_result, bool interrupted) {
-    // emit qt signal to avoid possible thread deadlock
-    // this callback comes from the captioner thread, result processing needs settings_change_mutex, so does clearing captioner,
-    // but that waits for the captioner callback to finish which might be waiting on the lock otherwise.
+void SourceCaptioner::on_caption_text_callback(const RawResultPtr &caption_result, bool interrupted) {
+    // emit qt signal to hand the result over to processing_thread, also avoids a possible thread deadlock:
+    // this callback comes from the captioner thread and clearing the captioner waits for it to return,
+    // so it only hands the result over.
 
     emit received_caption_result(caption_result, interrupted);
 }
 
-void SourceCaptioner::process_caption_result(const CaptionResult caption_result, bool interrupted) {
-    std::shared_ptr<OutputCaptionResult> native_output_result;
-    std::string recent_caption_text;
-    bool to_stream, to_recording, to_transcript_streaming, to_transcript_recording, to_transcript_virtualcam;
+void SourceCaptioner::process_caption_result(const RawResultPtr &caption_result, bool interrupted) {
+    if (last_caption_result && last_caption_result->caption_text == caption_result->caption_text
+        && last_caption_result->final == caption_result->final) {
+        return;
+    }
+    last_caption_result = caption_result;
+
+    const auto cur_settings = current_settings();
+    interim_pacer.configure(cur_settings->settings.format_settings.interim_updates_per_second,
+                            cur_settings->settings.format_settings.interim_min_stability,
+                            video_frame_interval_ns());
+
+    if (!interim_pacer.admit(caption_result, interrupted, os_gettime_ns(), obs_get_video_frame_time())) {
+        if (interim_pacer.has_held_result() && !held_interim_timer.isActive())
+            schedule_held_interim();
+        return;
+    }
+    if (!interim_pacer.has_held_result())
+        held_interim_timer.stop();
+
+    output_caption_result(caption_result, interrupted);
+}
+
+void SourceCaptioner::schedule_held_interim() {
+    const uint64_t now_ns = os_gettime_ns();
+    const uint64_t slot_ns = interim_pacer.next_slot_ns();
+    const uint64_t wait_ns = slot_ns > now_ns ? slot_ns - now_ns : 0;
 
-    if (this->last_caption_text == caption_result.caption_text && this->last_caption_final == caption_result.final) {
+    // round up, waking up early would only mean sleeping again
+    held_interim_timer.start((int) ((wait_ns + 999999) / 1000000));
+}
+
+void SourceCaptioner::reset_interim_pacing() {
+    // queued behind the results the old stream already handed over, so an interim it held back is never output
+    // once captions stopped or after the restarted stream's first results
+    QMetaObject::invokeMethod(&processing_context, [this]() {
+        held_interim_timer.stop();
+        interim_pacer.reset();
+    }, Qt::QueuedConnection);
+}
+
+void SourceCaptioner::held_interim_timer_cb() {
+    RawResultPtr held_result;
+    if (interim_pacer.take_held(held_result, os_gettime_ns(), obs_get_video_frame_time())) {
+        output_caption_result(held_result, false);
         return;
     }
-    this->last_caption_text = caption_result.caption_text;
-    this->last_caption_final = caption_result.final;
+
+    if (interim_pacer.has_held_result())
+        schedule_held_interim();
+}
+
+void SourceCaptioner::output_caption_result(const RawResultPtr &caption_result, bool interrupted) {
+    std::shared_ptr<OutputCaptionResult> native_output_result;
+    std::string recent_caption_text;
+    bool to_stream, to_recording, to_transcript_streaming, to_transcript_recording, to_transcript_virtualcam;
 
     std::vector<TextOutputTup> text_source_sets;
     {
-        std::lock_guard<recursive_mutex> lock(settings_change_mutex);
+        const auto cur_settings = current_settings();
+        const SourceCaptionerSettings &settings = cur_settings->settings;
 
-        if (!caption_result_handler) {
+        const auto result_handler = std::atomic_load(&caption_result_handler);
+        if (!result_handler) {
             spdlog::warn("no caption_result_handler, shouldn't happen, there should be no AudioCaptureSession running");
             return;
         }
 
-        native_output_result = caption_result_handler->prepare_caption_output(
+        native_output_result = result_handler->prepare_caption_output(
             caption_result,
             true,
             settings.format_settings.caption_insert_newlines,
@@ -452,12 +561,12 @@ void SourceCaptioner::process_caption_result(const CaptionResult caption_result,
         if (!native_output_result)
             return;
 
-        const SceneCollectionSettings &scene_col_settings = this->settings.get_scene_collection_settings(selected_scene_collection_name);
+        const SceneCollectionSettings &scene_col_settings = cur_settings->scene_collection_settings();
         for (const auto &text_out: scene_col_settings.text_outputs) {
             if (!text_out.isValidEnabled())
                 continue;
 
-            auto text_output_result = caption_result_handler->prepare_caption_output(
+            auto text_output_result = result_handler->prepare_caption_output(
                 caption_result,
                 true,
                 true,
@@ -496,7 +605,7 @@ void SourceCaptioner::process_caption_result(const CaptionResult caption_result,
         set_text_source_text(std::get<0>(text_out), std::get<1>(text_out));
     }
 
-    emit caption_result_received(native_output_result, false, recent_caption_text);
+    emit caption_result_received(native_output_result, false, std::make_shared<const std::string>(std::move(recent_caption_text)));
 }
 
 void SourceCaptioner::output_caption_writers(
@@ -538,69 +647,73 @@ void SourceCaptioner::output_caption_writers(
 }
 
 void SourceCaptioner::caption_was_output() {
+    const auto cur_settings = current_settings();
+    const CaptionFormatSettings &format_settings = cur_settings->settings.format_settings;
+
+    std::lock_guard<std::mutex> lock(clearance_mutex);
     this->last_caption_at = std::chrono::steady_clock::now();
     this->last_caption_cleared = false;
+
+    if (!format_settings.caption_timeout_enabled || clearance_check_scheduled)
+        return;
+
+    schedule_clearance_check(this->last_caption_at + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(format_settings.caption_timeout_seconds)));
 }
 
 void SourceCaptioner::stream_started_event() {
-    settings_change_mutex.lock();
-    SourceCaptionerSettings cur_settings = settings;
-    settings_change_mutex.unlock();
+    search_index.output_started(CAPTION_SEARCH_OUTPUT_STREAM, std::chrono::steady_clock::now());
+    const auto snapshot = current_settings();
+    const SourceCaptionerSettings &cur_settings = snapshot->settings;
 
-    auto control_output = std::make_shared<CaptionOutputControl<int>>(0);
-    streaming_output.set_control(control_output);
-    std::thread th(caption_output_writer_loop, control_output, true);
-    th.detach();
+    streaming_output.set_control(std::make_shared<CaptionOutputControl>(
+        output_executor, std::make_unique<StreamCaptionOutputHandler>(true)));
 
     if (this->base_enabled && cur_settings.transcript_settings.enabled && cur_settings.transcript_settings.streaming_transcripts_enabled) {
-        auto control_transcript = std::make_shared<CaptionOutputControl<TranscriptOutputSettings>>(cur_settings.transcript_settings);
-        transcript_streaming_output.set_control(control_transcript);
-
-        std::thread th2(transcript_writer_loop, control_transcript, "stream", cur_settings.transcript_settings);
-        th2.detach();
+        transcript_streaming_output.set_control(std::make_shared<CaptionOutputControl>(
+            output_executor,
+            std::make_unique<TranscriptOutputHandler>("stream", cur_settings.transcript_settings, &segment_compressor),
+            transcript_queue_mode(cur_settings.transcript_settings)));
     }
 }
 
 void SourceCaptioner::stream_stopped_event() {
+    search_index.output_stopped(CAPTION_SEARCH_OUTPUT_STREAM, std::chrono::steady_clock::now());
     streaming_output.clear();
     transcript_streaming_output.clear();
 }
 
 void SourceCaptioner::recording_started_event() {
-    settings_change_mutex.lock();
-    SourceCaptionerSettings cur_settings = settings;
-    settings_change_mutex.unlock();
+    search_index.output_started(CAPTION_SEARCH_OUTPUT_RECORDING, std::chrono::steady_clock::now());
+    const auto snapshot = current_settings();
+    const SourceCaptionerSettings &cur_settings = snapshot->settings;
 
-    auto control_output = std::make_shared<CaptionOutputControl<int>>(0);
-    recording_output.set_control(control_output);
-    std::thread th(caption_output_writer_loop, control_output, false);
-    th.detach();
+    recording_output.set_control(std::make_shared<CaptionOutputControl>(
+        output_executor, std::make_unique<StreamCaptionOutputHandler>(false)));
 
     if (this->base_enabled && cur_settings.transcript_settings.enabled && cur_settings.transcript_settings.recording_transcripts_enabled) {
-        auto control_transcript = std::make_shared<CaptionOutputControl<TranscriptOutputSettings>>(cur_settings.transcript_settings);
-        transcript_recording_output.set_control(control_transcript);
-
-        std::thread th2(transcript_writer_loop, control_transcript, "recording", cur_settings.transcript_settings);
-        th2.detach();
+        transcript_recording_output.set_control(std::make_shared<CaptionOutputControl>(
+            output_executor,
+            std::make_unique<TranscriptOutputHandler>("recording", cur_settings.transcript_settings, &segment_compressor),
+            transcript_queue_mode(cur_settings.transcript_settings)));
     }
 }
 
 void SourceCaptioner::recording_stopped_event() {
+    search_index.output_stopped(CAPTION_SEARCH_OUTPUT_RECORDING, std::chrono::steady_clock::now());
     recording_output.clear();
     transcript_recording_output.clear();
 }
 
 void SourceCaptioner::virtualcam_started_event() {
-    settings_change_mutex.lock();
-    SourceCaptionerSettings cur_settings = settings;
-    settings_change_mutex.unlock();
+    const auto snapshot = current_settings();
+    const SourceCaptionerSettings &cur_settings = snapshot->settings;
 
     if (this->base_enabled && cur_settings.transcript_settings.enabled && cur_settings.transcript_settings.virtualcam_transcripts_enabled) {
-        auto control_transcript = std::make_shared<CaptionOutputControl<TranscriptOutputSettings>>(cur_settings.transcript_settings);
-        transcript_virtualcam_output.set_control(control_transcript);
-
-        std::thread th2(transcript_writer_loop, control_transcript, "virtualcam", cur_settings.transcript_settings);
-        th2.detach();
+        transcript_virtualcam_output.set_control(std::make_shared<CaptionOutputControl>(
+            output_executor,
+            std::make_unique<TranscriptOutputHandler>("virtualcam", cur_settings.transcript_settings, &segment_compressor),
+            transcript_queue_mode(cur_settings.transcript_settings)));
     }
 }
 
@@ -609,32 +722,262 @@ void SourceCaptioner::virtualcam_stopped_event() {
 }
 
 void SourceCaptioner::set_text_source_text(const string &text_source_name, const string &caption_text) {
-    if (std::get<0>(last_text_source_set) == caption_text && std::get<1>(last_text_source_set) == text_source_name) {
+    text_sources.set_text(text_source_name, caption_text);
+}
+
+static std::mutex transcript_recovery_mutex;
+static WorkerThread transcript_recovery_thread;
+
+void SourceCaptioner::recover_interrupted_transcripts_in_background() {
+    std::vector<TranscriptWalSession> sessions = find_interrupted_transcript_sessions(transcript_wal_directory());
+    if (sessions.empty())
         return;
+    // new transcripts in the same files wait for these, the recovery thread ends each
+    begin_transcript_recovery(sessions);
+
+    std::lock_guard<std::mutex> lock(transcript_recovery_mutex);
+    transcript_recovery_thread = WorkerThread("s2t recovery", WORKER_ROLE_DISK_IO, [sessions = std::move(sessions)]() {
+        const auto started_at = std::chrono::steady_clock::now();
+        const uint recovered = recover_transcript_sessions(sessions);
+        spdlog::info("recovered {} of {} interrupted transcripts in {} ms", recovered, sessions.size(),
+                     std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started_at).count());
+    });
+}
+
+void SourceCaptioner::wait_for_transcript_recovery() {
+    std::lock_guard<std::mutex> lock(transcript_recovery_mutex);
+    transcript_recovery_thread.join();
+}
+
+bool SourceCaptioner::export_caption_journal(const QString &journal_path, const QString &output_path,
+                                             const TranscriptOutputSettings &settings) {
+    // the format goes by the file picked, the subtitle settings are the current ones
+    const std::string extension = QFileInfo(output_path).suffix().toLower().toStdString();
+    std::string format;
+    for (const char *a_format: {"srt", "vtt", "txt"}) {
+        if (transcript_format_extension(a_format, "") == extension)
+            format = a_format;
+    }
+    if (format.empty()) {
+        spdlog::error("caption journal export error, no transcript format for '{}'", output_path.toStdString());
+        return false;
     }
 
-    ::set_text_source_text(text_source_name, caption_text);
-    last_text_source_set = std::tuple<string, string>(caption_text, text_source_name);
+    TranscriptOutputSettings export_settings = settings;
+    export_settings.format = format;
+    export_settings.extra_formats.clear();
+    export_settings.segment_minutes = 0;
+    export_settings.segment_megabytes = 0;
+    return backend::export_caption_journal(journal_path, output_path, export_settings);
 }
 
 SourceCaptioner::~SourceCaptioner() {
     stream_stopped_event();
     recording_stopped_event();
-    stop_caption_stream(false);
+    virtualcam_stopped_event();
+    {
+        // cancels the streams' calls, their threads don't wait for a timeout
+        ShutdownTimer timer("caption stream");
+        stop_caption_stream(false);
+    }
+    {
+        ShutdownTimer timer("caption processing");
+        processing_thread.quit();
+        processing_thread.wait();
+    }
+    {
+        // lets the writers finish their files, pending timers like the caption clearance get dropped.
+        // Not bounded by the shutdown budget, past it only what's journaled for recovery is skipped
+        ShutdownTimer timer("caption outputs");
+        output_executor.stop();
+    }
+    {
+        // the last segments closed by the writers above
+        ShutdownTimer timer("segment compressor");
+        segment_compressor.stop();
+    }
 }
 
-template<class T>
-void CaptionOutputControl<T>::stop_soon() {
-    spdlog::debug("CaptionOutputControl stop_soon()");
+CaptionOutputControl::CaptionOutputControl(OutputExecutor &executor, std::unique_ptr<CaptionOutputHandler> handler,
+                                           CaptionOutputQueueMode queue_mode) :
+        executor(executor),
+        handler(std::move(handler)),
+        caption_queue(queue_mode) {}
+
+void CaptionOutputControl::start() {
+    executor.post([self = shared_from_this()]() {
+        if (self->stop)
+            return;
+
+        self->handler->start();
+        self->update_wake();
+    });
+}
+
+void CaptionOutputControl::enqueue(const CaptionOutput &output) {
+    handler->journal(output);
+    caption_queue.enqueue(output);
+
+    // one drain task takes care of everything queued up until it runs
+    if (!drain_posted.exchange(true)) {
+        executor.post([self = shared_from_this()]() {
+            self->drain();
+        });
+    }
+}
+
+void CaptionOutputControl::drain() {
+    drain_posted = false;
+
+    // what was queued before stop_soon() still gets written, finish() comes after
+    CaptionOutput caption_output;
+    uint64_t skipped = 0;
+    while (caption_queue.try_dequeue(caption_output)) {
+        if (!skipping && PluginShutdown::past_deadline())
+            skipping = handler->skip_at_shutdown();
+        if (skipping) {
+            skipped++;
+            continue;
+        }
+
+        S2T_TRACE_SPAN("caption output");
+        handler->on_caption_output(caption_output);
+    }
+    if (skipped)
+        spdlog::warn("CaptionOutputControl shutdown deadline passed, skipped {} queued captions", skipped);
+
+    if (!stop)
+        update_wake();
+}
+
+void CaptionOutputControl::update_wake() {
+    auto wake_at = handler->wake_at();
+    while (!stop && wake_at <= std::chrono::steady_clock::now()) {
+        S2T_TRACE_SPAN("caption output wake");
+        handler->on_wake();
+        wake_at = handler->wake_at();
+    }
+
+    if (stop || wake_at == scheduled_wake_at)
+        return;
+
+    if (wake_timer) {
+        executor.cancel(wake_timer);
+        wake_timer = 0;
+    }
+
+    scheduled_wake_at = wake_at;
+    if (wake_at == std::chrono::steady_clock::time_point::max())
+        return;
+
+    wake_timer = executor.schedule_at(wake_at, [self = shared_from_this()]() {
+        self->wake_timer = 0;
+        self->scheduled_wake_at = std::chrono::steady_clock::time_point::max();
+        self->update_wake();
+    });
+}
+
+void CaptionOutputControl::stop_soon() {
+    spdlog::debug("CaptionOutputControl stop_soon(), {} interims coalesced, {} interims dropped queue full, {} finals queued over the limit",
+                  caption_queue.coalesced(), caption_queue.dropped(), caption_queue.over_limit());
     stop = true;
-    caption_queue.enqueue(CaptionOutput());
+    executor.post([self = shared_from_this()]() {
+        self->finish();
+    });
 }
 
-template<class T>
-CaptionOutputControl<T>::~CaptionOutputControl() {
+void CaptionOutputControl::finish() {
+    if (wake_timer) {
+        executor.cancel(wake_timer);
+        wake_timer = 0;
+    }
+    drain();
+    handler->finish();
+}
+
+CaptionOutputControl::~CaptionOutputControl() {
     spdlog::debug("~CaptionOutputControl");
 }
 
+StreamCaptionOutputHandler::StreamCaptionOutputHandler(bool to_stream) :
+        to_stream(to_stream),
+        to_what(to_stream ? "streaming" : "recording") {
+    spdlog::info("caption output {} starting", to_what);
+}
+
+void StreamCaptionOutputHandler::on_caption_output(const CaptionOutput &caption_output) {
+    if (!caption_output.output_result) {
+        spdlog::info("got empty CaptionOutput.output_result???");
+        return;
+    }
+    if (!caption_output.is_clearance && caption_output.output_result->output_line.empty()) {
+        SPDLOG_DEBUG("ignoring empty non clearance, {}", to_what);
+        return;
+    }
+
+    // the frontend output object stays the same for the whole session, only look it up again once it went inactive
+    if (!output || !obs_output_active(output)) {
+        if (output)
+            obs_output_release(output);
+        output = to_stream ? obs_frontend_get_streaming_output() : obs_frontend_get_recording_output();
+    }
+    if (!output) {
+        S2T_INFO_EVERY_MS(1000, "built caption lines, no output, not sending, not {}?: '{}'", to_what, caption_output.output_result->output_line);
+        return;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    const std::chrono::seconds wanted_delay(obs_output_get_active_delay(output));
+    auto release_at = caption_output.output_result->caption_result.received_at + wanted_delay;
+    if (release_at > now + wanted_delay) {
+        spdlog::info("capping delay, received_at is in the future?");
+        release_at = now + wanted_delay;
+    }
+
+    // anything still waiting to go out after this one would only replace it with older text
+    auto superseded = delayed.lower_bound(release_at);
+    coalesced_count += std::distance(superseded, delayed.end());
+    delayed.erase(superseded, delayed.end());
+
+    delayed.emplace(release_at, caption_output);
+}
+
+void StreamCaptionOutputHandler::on_wake() {
+    const auto due_end = delayed.upper_bound(std::chrono::steady_clock::now());
+    if (due_end == delayed.begin())
+        return;
+
+    // of everything that is due only the newest would stay on screen
+    const CaptionOutput due = std::prev(due_end)->second;
+    coalesced_count += std::distance(delayed.begin(), due_end) - 1;
+    delayed.erase(delayed.begin(), due_end);
+
+    if (due.output_result->output_line == previous_line)
+        return;
+    if (!output) {
+        S2T_INFO_EVERY_MS(1000, "no output anymore, not sending, not {}?: '{}'", to_what, due.output_result->output_line);
+        return;
+    }
+
+    previous_line = due.output_result->output_line;
+    SPDLOG_DEBUG("sending caption {} line now: '{}'", to_what, previous_line);
+    obs_output_output_caption_text2(output, previous_line.c_str(), 0.0);
+}
+
+void StreamCaptionOutputHandler::finish() {
+    spdlog::info("caption output {} done, {} pending captions dropped, {} coalesced", to_what, delayed.size(), coalesced_count);
+    delayed.clear();
+    if (output) {
+        obs_output_release(output);
+        output = nullptr;
+    }
+}
+
+StreamCaptionOutputHandler::~StreamCaptionOutputHandler() {
+    if (output)
+        obs_output_release(output);
+}
+
 bool TranscriptOutputSettings::hasBaseSettings() const {
     if (!enabled || output_path.empty() || format.empty())
         return false;
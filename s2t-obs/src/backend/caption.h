@@ -19,8 +19,19 @@
 #include "audio_capture_pipeline.h"
 #include "audio_converter_pipeline.h"
 #include "post_caption_handler.h"
+#include "caption_history.h"
+#include "caption_search_index.h"
+#include "caption_output_queue.h"
+#include "interim_pacer.h"
+#include "output_executor.h"
+#include "text_source_registry.h"
+#include "transcript_segments.h"
+
+#include <algorithm>
+#include <map>
 
 #include <QObject>
+#include <QThread>
 #include <QTimer>
 
 namespace backend {
@@ -31,11 +42,12 @@ Q_DECLARE_METATYPE(std::string)
 
 Q_DECLARE_METATYPE(shared_ptr<OutputCaptionResult>)
 
-Q_DECLARE_METATYPE(CaptionResult)
+Q_DECLARE_METATYPE(RawResultPtr)
+
+// built once per result and shared by every queued connection, a string would be copied for each of them
+typedef std::shared_ptr<const std::string> RecentCaptionTextPtr;
 
-#define MAX_HISTORY_VIEW_LENGTH 1000
-#define HISTORY_ENTRIES_LOW_WM 40
-#define HISTORY_ENTRIES_HIGH_WM 80
+Q_DECLARE_METATYPE(RecentCaptionTextPtr)
 
 enum CaptionSourceMuteType {
     CAPTION_SOURCE_MUTE_TYPE_FROM_OWN_SOURCE,
@@ -131,6 +143,8 @@ struct TranscriptOutputSettings {
     bool enabled;
     std::string output_path;
     std::string format;
+    // written alongside format by the same writer, each to its own file
+    std::vector<std::string> extra_formats;
 
     std::string recording_filename_type;
     std::string recording_filename_custom;
@@ -154,8 +168,13 @@ struct TranscriptOutputSettings {
     bool recording_transcripts_enabled;
     bool virtualcam_transcripts_enabled;
 
+    // continue in a new numbered file after this many minutes or megabytes, 0: never
+    uint segment_minutes;
+    uint segment_megabytes;
+    bool segment_compress;
 
     TranscriptOutputSettings(bool enabled, const std::string &outputPath, const std::string &format,
+                             const std::vector<std::string> &extraFormats,
                              const std::string &recordingFilenameType,
                              const std::string &recordingFilenameCustom, const std::string &recordingFilenameExists,
                              const std::string &streamingFilenameType, const std::string &streamingFilenameCustom,
@@ -165,8 +184,9 @@ struct TranscriptOutputSettings {
                              bool srtAddPunctuation, bool srtSplitSingleSentences,
                              CapitalizationType srtCapitalization,
                              bool streamingTranscriptsEnabled, bool recordingTranscriptsEnabled,
-                             bool virtualcamTranscriptsEnabled)
-            : enabled(enabled), output_path(outputPath), format(format),
+                             bool virtualcamTranscriptsEnabled,
+                             uint segmentMinutes, uint segmentMegabytes, bool segmentCompress)
+            : enabled(enabled), output_path(outputPath), format(format), extra_formats(extraFormats),
               recording_filename_type(recordingFilenameType),
               recording_filename_custom(recordingFilenameCustom),
               recording_filename_exists(recordingFilenameExists),
@@ -183,13 +203,17 @@ struct TranscriptOutputSettings {
               srt_capitalization(srtCapitalization),
               streaming_transcripts_enabled(streamingTranscriptsEnabled),
               recording_transcripts_enabled(recordingTranscriptsEnabled),
-              virtualcam_transcripts_enabled(virtualcamTranscriptsEnabled) {}
+              virtualcam_transcripts_enabled(virtualcamTranscriptsEnabled),
+              segment_minutes(segmentMinutes),
+              segment_megabytes(segmentMegabytes),
+              segment_compress(segmentCompress) {}
 
 
     bool operator==(const TranscriptOutputSettings &rhs) const {
         return enabled == rhs.enabled &&
                output_path == rhs.output_path &&
                format == rhs.format &&
+               extra_formats == rhs.extra_formats &&
                recording_filename_type == rhs.recording_filename_type &&
                recording_filename_custom == rhs.recording_filename_custom &&
                recording_filename_exists == rhs.recording_filename_exists &&
@@ -206,7 +230,10 @@ struct TranscriptOutputSettings {
                srt_capitalization == rhs.srt_capitalization &&
                streaming_transcripts_enabled == rhs.streaming_transcripts_enabled &&
                recording_transcripts_enabled == rhs.recording_transcripts_enabled &&
-               virtualcam_transcripts_enabled == rhs.virtualcam_transcripts_enabled;
+               virtualcam_transcripts_enabled == rhs.virtualcam_transcripts_enabled &&
+               segment_minutes == rhs.segment_minutes &&
+               segment_megabytes == rhs.segment_megabytes &&
+               segment_compress == rhs.segment_compress;
     }
 
     bool operator!=(const TranscriptOutputSettings &rhs) const {
@@ -215,11 +242,23 @@ struct TranscriptOutputSettings {
 
     bool hasBaseSettings() const;
 
+    // format first, then the extra formats without duplicates
+    std::vector<std::string> formats() const {
+        std::vector<std::string> all{format};
+        for (const auto &extra_format: extra_formats) {
+            if (!extra_format.empty() && std::find(all.begin(), all.end(), extra_format) == all.end())
+                all.push_back(extra_format);
+        }
+        return all;
+    }
+
     void print(const char *line_prefix = "") {
         printf("%sTranscriptSettings\n", line_prefix);
         printf("%s  enabled: %d\n", line_prefix, enabled);
         printf("%s  output_path: %s\n", line_prefix, output_path.c_str());
         printf("%s  format: %s\n", line_prefix, format.c_str());
+        for (const auto &extra_format: extra_formats)
+            printf("%s  extra_format: %s\n", line_prefix, extra_format.c_str());
 
         printf("%s  recording_filename_type: %s\n", line_prefix, recording_filename_type.c_str());
         printf("%s  recording_filename_custom: %s\n", line_prefix, recording_filename_custom.c_str());
@@ -241,9 +280,36 @@ struct TranscriptOutputSettings {
         printf("%s  streaming_transcripts_enabled: %d\n", line_prefix, streaming_transcripts_enabled);
         printf("%s  recording_transcripts_enabled: %d\n", line_prefix, recording_transcripts_enabled);
         printf("%s  virtualcam_transcripts_enabled: %d\n", line_prefix, virtualcam_transcripts_enabled);
+        printf("%s  segment_minutes: %d\n", line_prefix, segment_minutes);
+        printf("%s  segment_megabytes: %d\n", line_prefix, segment_megabytes);
+        printf("%s  segment_compress: %d\n", line_prefix, segment_compress);
     }
 };
 
+static std::string transcript_format_extension(const std::string &format, const std::string &default_extension) {
+    if (format == "srt")
+        return "srt";
+    if (format == "vtt")
+        return "vtt";
+    if (format == "txt" || format == "txt_plain")
+        return "txt";
+    if (format == "raw")
+        return "log";
+    if (format == "journal")
+        return "s2tj";
+
+    return default_extension;
+}
+
+// appended to a custom transcript name for an extra format written next to it, "[custom].[suffix]".
+// txt and txt_plain share an extension, the plain one gets its format id in too so they never write the same file
+static std::string transcript_format_custom_suffix(const std::string &format) {
+    const std::string extension = transcript_format_extension(format, "");
+    if (format == "txt_plain")
+        return format + "." + extension;
+    return extension;
+}
+
 struct SourceCaptionerSettings {
     bool streaming_output_enabled;
     bool recording_output_enabled;
@@ -320,34 +386,73 @@ struct SourceCaptionerSettings {
 
 };
 
-struct CaptionOutput {
-    std::shared_ptr<OutputCaptionResult> output_result;
-    bool is_clearance;
+// Gets the captions of one output, every call happens on the OutputExecutor thread
+class CaptionOutputHandler {
+public:
+    virtual void start() {}
+
+    virtual void on_caption_output(const CaptionOutput &caption_output) = 0;
 
-    CaptionOutput(std::shared_ptr<OutputCaptionResult> output_result, bool is_clearance) :
-            output_result(output_result),
-            is_clearance(is_clearance) {};
+    // called by whoever enqueues the output, before it's queued, while the executor thread may be running the
+    // other calls. For what has to be on disk even if the queue never gets drained.
+    virtual void journal(const CaptionOutput &caption_output) {}
 
-    CaptionOutput() : is_clearance(false) {}
+    // OBS is exiting and past the shutdown deadline: true if the outputs still queued can be skipped, because
+    // journal() has them for recovery or they're useless once OBS is gone. finish() still gets called after.
+    virtual bool skip_at_shutdown() {
+        return false;
+    }
+
+    // when on_wake() should get called next, time_point::max() for not at all. Checked after every other call.
+    virtual std::chrono::steady_clock::time_point wake_at() const {
+        return std::chrono::steady_clock::time_point::max();
+    }
+
+    virtual void on_wake() {}
+
+    // output stopped, last call
+    virtual void finish() {}
+
+    virtual ~CaptionOutputHandler() = default;
 };
 
-template<typename T>
-struct CaptionOutputControl {
-    moodycamel::BlockingConcurrentQueue<CaptionOutput> caption_queue;
-    volatile bool stop = false;
-    T arg;
+class CaptionOutputControl : public std::enable_shared_from_this<CaptionOutputControl> {
+    OutputExecutor &executor;
+    std::unique_ptr<CaptionOutputHandler> handler;
+    std::atomic<bool> drain_posted{false};
+
+    // executor thread only, the handler agreed to skip the rest once the shutdown deadline passed
+    bool skipping = false;
+
+    // executor thread only
+    std::chrono::steady_clock::time_point scheduled_wake_at = std::chrono::steady_clock::time_point::max();
+    OutputTimerId wake_timer = 0;
+
+    void drain();
+
+    void update_wake();
 
-    CaptionOutputControl(T arg) : arg(arg) {}
+    void finish();
+
+public:
+    CaptionOutputQueue caption_queue;
+    std::atomic<bool> stop{false};
+
+    CaptionOutputControl(OutputExecutor &executor, std::unique_ptr<CaptionOutputHandler> handler,
+                         CaptionOutputQueueMode queue_mode = CAPTION_OUTPUT_QUEUE_MODE_LATEST_INTERIM);
+
+    void start();
+
+    void enqueue(const CaptionOutput &output);
 
     void stop_soon();
 
     ~CaptionOutputControl();
 };
 
-template<typename T>
 struct OutputWriter {
     std::recursive_mutex control_change_mutex;
-    std::shared_ptr<CaptionOutputControl<T>> control;
+    std::shared_ptr<CaptionOutputControl> control;
 
     void clear() {
         std::lock_guard<recursive_mutex> lock(control_change_mutex);
@@ -357,22 +462,59 @@ struct OutputWriter {
         }
     }
 
-    void set_control(const std::shared_ptr<CaptionOutputControl<T>> &set_control) {
+    void set_control(const std::shared_ptr<CaptionOutputControl> &set_control) {
         std::lock_guard<recursive_mutex> lock(control_change_mutex);
         clear();
         this->control = set_control;
+        this->control->start();
     }
 
     bool enqueue(const CaptionOutput &output) {
         std::lock_guard<recursive_mutex> lock(control_change_mutex);
         if (control && !control->stop) {
-            control->caption_queue.enqueue(output);
+            control->enqueue(output);
             return true;
         }
         return false;
     }
 };
 
+// Sends captions to the stream or recording output once the output's delay passed since they were received
+class StreamCaptionOutputHandler : public CaptionOutputHandler {
+    const bool to_stream;
+    const std::string to_what;
+
+    std::string previous_line;
+    obs_output_t *output = nullptr;
+
+    // captions waiting for the output delay to pass, ordered by release time, equal times keep arrival order
+    std::multimap<std::chrono::steady_clock::time_point, CaptionOutput> delayed;
+    uint64_t coalesced_count = 0;
+
+public:
+    explicit StreamCaptionOutputHandler(bool to_stream);
+
+    void on_caption_output(const CaptionOutput &caption_output) override;
+
+    std::chrono::steady_clock::time_point wake_at() const override {
+        if (delayed.empty())
+            return std::chrono::steady_clock::time_point::max();
+
+        return delayed.begin()->first;
+    }
+
+    void on_wake() override;
+
+    // captions for an output that's going away with OBS
+    bool skip_at_shutdown() override {
+        return true;
+    }
+
+    void finish() override;
+
+    ~StreamCaptionOutputHandler() override;
+};
+
 enum SourceCaptionerStatusEvent {
     SOURCE_CAPTIONER_STATUS_EVENT_STOPPED,
 
@@ -380,6 +522,8 @@ enum SourceCaptionerStatusEvent {
     SOURCE_CAPTIONER_STATUS_EVENT_STARTED_ERROR,
 
     SOURCE_CAPTIONER_STATUS_EVENT_NEW_SETTINGS_STOPPED,
+    // captioning kept running, the new settings are used from the next result on
+    SOURCE_CAPTIONER_STATUS_EVENT_NEW_SETTINGS_APPLIED,
 
     SOURCE_CAPTIONER_STATUS_EVENT_AUDIO_CAPTURE_STATUS_CHANGE,
 };
@@ -404,94 +548,49 @@ struct SourceCaptionerStatus {
               scene_collection_name(scene_collection_name), audio_capture_status(audioCaptureStatus), active(active) {}
 };
 
-static void caption_output_writer_loop(std::shared_ptr<CaptionOutputControl<int>> control, bool to_stream) {
-    std::string to_what(to_stream ? "streaming" : "recording");
-    spdlog::info("caption_output_writer_loop {} starting", to_what.c_str());
+Q_DECLARE_METATYPE(std::shared_ptr<SourceCaptionerStatus>)
 
-    std::string previous_line;
-    CaptionOutput caption_output;
-    int active_delay_sec;
-    bool got_item;
-    obs_output_t *output = nullptr;
+// what a settings change touches, a running SourceCaptioner only rebuilds those stages
+struct SourceCaptionerSettingsChange {
+    bool stream = false;    // inference stream settings, it has to reconnect
+    bool capture = false;   // caption or mute source, the audio capture pipelines get rebuilt
+    bool format = false;    // formatting, text outputs and outputs, picked up by the next result
 
-    double waited_left_secs = 0;
-    while (!control->stop) {
-        control->caption_queue.wait_dequeue(caption_output);
-        if (control->stop)
-            break;
-        if (!caption_output.output_result) {
-            spdlog::info("got empty CaptionOutput.output_result???");
-            continue;
-        }
-        if (output) {
-            obs_output_release(output);
-            output = nullptr;
-        }
-        if (to_stream)
-            output = obs_frontend_get_streaming_output();
-        else
-            output = obs_frontend_get_recording_output();
-
-        if (!output) {
-            spdlog::info("built caption lines, no output 1, not sending, not {}?: '{}'", to_what.c_str(),
-                     caption_output.output_result->output_line.c_str());
-            continue;
-        }
-        if (!caption_output.is_clearance && caption_output.output_result->output_line.empty()) {
-            spdlog::log("ingoring empty non clearance, {}", to_what.c_str());
-            continue;
-        }
-        if (caption_output.output_result->output_line == previous_line) {
-            continue;
-        }
+    bool live() const {
+        return !stream && !capture;
+    }
+};
 
-        previous_line = caption_output.output_result->output_line;
-        waited_left_secs = 0;
-        active_delay_sec = obs_output_get_active_delay(output);
-        if (active_delay_sec) {
-            auto since_creation = chrono::steady_clock::now() - caption_output.output_result->caption_result.received_at;
-            chrono::seconds wanted_delay(active_delay_sec);
-            auto wait_left = wanted_delay - since_creation;
-            if (wait_left > wanted_delay) {
-                spdlog::info("capping delay, wtf, negative duration?, got {}, max {}",
-                    std::chrono::duration_cast<std::chrono::duration<double >>(wait_left).count(),
-                    std::chrono::duration_cast<std::chrono::duration<double >>(wanted_delay).count()
-                );
-                wait_left = wanted_delay;
-            }
-
-            waited_left_secs = std::chrono::duration_cast<std::chrono::duration<double >>(wait_left).count();
-            spdlog::debug("caption_output_writer_loop {} sleeping for {} seconds", to_what.c_str(), waited_left_secs);
-    
-            // release output before possible long thread sleep to not block a possible shutdown (or output change?)
-            obs_output_release(output);
-            output = nullptr;
-            std::this_thread::sleep_for(wait_left);
-            if (control->stop)
-                break;
-
-            if (to_stream)
-                output = obs_frontend_get_streaming_output();
-            else
-                output = obs_frontend_get_recording_output();
-
-            if (!output) {
-                spdlog::info("built caption lines, no output 2, not sending, not {}?: '{}'", to_what.c_str(), caption_output.output_result->output_line.c_str());
-                continue;
-            }
-        }
+// settings of a SourceCaptioner as of one change, never modified once published
+struct SourceCaptionerSettingsSnapshot {
+    const uint64_t version;
+    const SourceCaptionerSettings settings;
+    const string scene_collection_name;
 
-        spdlog::debug("sending caption {} line now, waited {}: '{}'", to_what.c_str(), waited_left_secs, caption_output.output_result->output_line.c_str());
-        obs_output_output_caption_text2(output, caption_output.output_result->output_line.c_str(), 0.0);
-    }
-    if (output) {
-        obs_output_release(output);
-        output = nullptr;
+    SourceCaptionerSettingsSnapshot(uint64_t version, const SourceCaptionerSettings &settings, const string &scene_collection_name)
+            : version(version), settings(settings), scene_collection_name(scene_collection_name) {}
+
+    const SceneCollectionSettings &scene_collection_settings() const {
+        return settings.get_scene_collection_settings(scene_collection_name);
     }
-    spdlog::info("caption_output_writer_loop {} done", to_what.c_str());
-}
 
-Q_DECLARE_METATYPE(std::shared_ptr<SourceCaptionerStatus>)
+    SourceCaptionerSettingsChange change_to(const SourceCaptionerSettings &new_settings,
+                                            const string &new_scene_collection_name) const {
+        const SceneCollectionSettings &scene_settings = scene_collection_settings();
+        const SceneCollectionSettings &new_scene_settings = new_settings.get_scene_collection_settings(new_scene_collection_name);
+
+        SourceCaptionerSettingsChange change;
+        change.stream = settings.stream_settings != new_settings.stream_settings;
+        change.capture = scene_collection_name != new_scene_collection_name
+            || scene_settings.caption_source_settings != new_scene_settings.caption_source_settings;
+        change.format = settings.format_settings != new_settings.format_settings
+            || scene_settings.text_outputs != new_scene_settings.text_outputs
+            || settings.streaming_output_enabled != new_settings.streaming_output_enabled
+            || settings.recording_output_enabled != new_settings.recording_output_enabled
+            || settings.transcript_settings != new_settings.transcript_settings;
+        return change;
+    }
+};
 
 class SourceCaptioner : public QObject {
 Q_OBJECT
@@ -502,35 +601,74 @@ Q_OBJECT
     std::unique_ptr<ContinuousCaptions> continuous_captions;
     uint audio_chunk_count = 0;
 
-    SourceCaptionerSettings settings;
-    string selected_scene_collection_name;
+    // Only ever replaced as a whole, through current_settings() and publish_settings(), so the caption processing
+    // reads settings without locking and keeps a consistent snapshot for as long as it holds on to it.
+    std::shared_ptr<const SourceCaptionerSettingsSnapshot> settings_snapshot;
+
+    // same for the formatter of the running caption stream
+    std::shared_ptr<CaptionResultHandler> caption_result_handler;
 
-    std::unique_ptr<CaptionResultHandler> caption_result_handler;
+    // starting and stopping the caption stream, settings changes are serialized by it too
     std::recursive_mutex settings_change_mutex;
 
+    // caption timeout state, shared by the processing thread and the output executor
+    std::mutex clearance_mutex;
     std::chrono::steady_clock::time_point last_caption_at;
     bool last_caption_cleared;
-    QTimer timer;
+    bool clearance_check_scheduled = false;
+
+    std::shared_ptr<const SourceCaptionerSettingsSnapshot> current_settings() const {
+        return std::atomic_load(&settings_snapshot);
+    }
+
+    // settings_change_mutex held, returns the replaced snapshot
+    std::shared_ptr<const SourceCaptionerSettingsSnapshot> publish_settings(const SourceCaptionerSettings &new_settings,
+                                                                            const string &scene_collection_name) {
+        const auto previous = current_settings();
+        std::atomic_store(&settings_snapshot, std::shared_ptr<const SourceCaptionerSettingsSnapshot>(
+            std::make_shared<SourceCaptionerSettingsSnapshot>(previous ? previous->version + 1 : 1,
+                                                              new_settings, scene_collection_name)));
+        return previous;
+    }
+
+    // Caption results get formatted and sent to the outputs on their own thread so UI load can't stall them.
+    // Everything touching the result state below runs on it, only the display update goes back to the UI thread.
+    QThread processing_thread;
+    QObject processing_context;
+
+    InterimPacer interim_pacer;
+    QTimer held_interim_timer;
 
-    std::vector<std::shared_ptr<OutputCaptionResult>> results_history; // final ones + last ones before interruptions
+    CaptionHistory results_history; // final ones + last ones before interruptions
+    CaptionSearchIndex search_index; // all final ones, for the dock's search
     std::shared_ptr<OutputCaptionResult> held_nonfinal_caption_result;
 
-    OutputWriter<int> streaming_output;
-    OutputWriter<int> recording_output;
+    // declared before the executor, the transcript writers running on it hand it their finished segments
+    TranscriptSegmentCompressor segment_compressor;
 
-    OutputWriter<TranscriptOutputSettings> transcript_streaming_output;
-    OutputWriter<TranscriptOutputSettings> transcript_recording_output;
-    OutputWriter<TranscriptOutputSettings> transcript_virtualcam_output;
+    // runs all the writers below and the caption timeout clearance
+    OutputExecutor output_executor;
 
-    std::tuple<string, string> last_text_source_set;
+    OutputWriter streaming_output;
+    OutputWriter recording_output;
+
+    OutputWriter transcript_streaming_output;
+    OutputWriter transcript_recording_output;
+    OutputWriter transcript_virtualcam_output;
+
+    TextSourceRegistry text_sources;
 
     int audio_capture_id = 0;
 
-    string last_caption_text;
-    bool last_caption_final = false;
+    // last result processed, only compared against
+    RawResultPtr last_caption_result;
 
     void caption_was_output();
 
+    void schedule_clearance_check(const std::chrono::steady_clock::time_point &check_at);
+
+    void clear_output_timeout_cb();
+
     void output_caption_writers(
             const CaptionOutput &output,
             bool to_stream,
@@ -549,11 +687,28 @@ Q_OBJECT
 
     void on_audio_capture_status_change_callback(const int id, const audio_source_capture_status status);
 
-    void on_caption_text_callback(const CaptionResult &caption_result, bool interrupted);
+    void on_caption_text_callback(const RawResultPtr &caption_result, bool interrupted);
+
+    // restart_stream: new inference stream even if there is one, new_formatter: new CaptionResultHandler
+    bool _start_caption_stream(bool restart_stream, bool new_formatter);
+
+    bool is_capturing() const {
+        return (source_audio_capture_session || output_audio_capture_session) && continuous_captions;
+    }
+
+    // settings_change_mutex held, captioning keeps running, only a new formatter if it has to be
+    void apply_settings_live(const SourceCaptionerSettingsSnapshot &previous);
 
-    bool _start_caption_stream(bool restart_stream);
+    void process_caption_result(const RawResultPtr &caption_result, bool interrupted);
 
-    void process_caption_result(const CaptionResult, bool interrupted);
+    void output_caption_result(const RawResultPtr &caption_result, bool interrupted);
+
+    void schedule_held_interim();
+
+    void held_interim_timer_cb();
+
+    // the old stream's callbacks must be done, i.e. its ContinuousCaptions gone
+    void reset_interim_pacing();
 
     void process_audio_capture_status_change(const int id, const int new_status);
 
@@ -561,18 +716,16 @@ Q_OBJECT
 
 private slots:
 
-    void clear_output_timer_cb();
-
 //    void send_caption_text(const string text, int send_in_secs);
 
 signals:
 
-    void received_caption_result(const CaptionResult, bool interrupted);
+    void received_caption_result(RawResultPtr caption_result, bool interrupted);
 
     void caption_result_received(
             shared_ptr<OutputCaptionResult> caption,
             bool cleared,
-            string recent_caption_text);
+            RecentCaptionTextPtr recent_caption_text);
 
     void audio_capture_status_changed(const int id, const int new_status);
 
@@ -598,10 +751,31 @@ public:
     void virtualcam_started_event();
     void virtualcam_stopped_event();
 
+    // newest first, see CaptionSearchIndex. Can read from disk, not for the UI thread
+    void search_captions(const std::string &query, size_t max_hits, std::vector<CaptionSearchHit> &hits) {
+        search_index.search(query, max_hits, hits);
+    }
+
+    InterimPacingStats interim_pacing_stats() const {
+        return interim_pacer.stats();
+    }
+
     void set_enabled(const bool enabled) {
         base_enabled = enabled;
     }
 
+    // lists the transcripts a crash left behind, call before any captioner is started so no new transcript is
+    // taken for one of them. They are finished on a disk I/O worker, OBS doesn't wait for it.
+    static void recover_interrupted_transcripts_in_background();
+
+    // at exit, the recovery stops between transcripts once the shutdown began
+    static void wait_for_transcript_recovery();
+
+    // writes a caption journal as a .srt, .vtt or .txt transcript, picked by output_path, with the subtitle settings
+    // from settings. Reads the whole journal, not for the UI thread
+    static bool export_caption_journal(const QString &journal_path, const QString &output_path,
+                                       const TranscriptOutputSettings &settings);
+
 };
 
 }
@@ -0,0 +1,161 @@
+// Copyright 2022 gab
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef OBS_SPEECH2TEXT_PLUGIN_CAPTION_HISTORY_H
+#define OBS_SPEECH2TEXT_PLUGIN_CAPTION_HISTORY_H
+
+#include <array>
+#include <chrono>
+#include <string>
+
+namespace backend {
+
+#define MAX_HISTORY_VIEW_LENGTH 1000
+#define HISTORY_ENTRIES_CAPACITY 64
+
+struct CaptionHistoryEntry {
+    std::string clean_caption_text;
+    std::chrono::steady_clock::time_point received_at;
+
+    // size of this entry in the recent view, "text. ", 0 if not part of it
+    size_t view_size = 0;
+};
+
+/*
+ Fixed capacity ring of the last final caption results.
+
+ Slots get reused once the ring is full so their string buffers are kept around and steady state appends
+ don't allocate. The "recent captions" view ("first. second. third.") is kept up to date on every append
+ instead of being rebuilt from the whole history for every result.
+*/
+class CaptionHistory {
+    std::array<CaptionHistoryEntry, HISTORY_ENTRIES_CAPACITY> entries;
+    size_t head = 0;    // index of the newest entry
+    size_t count = 0;
+
+    // view entries, oldest first, each followed by ". ", starting at view_offset.
+    // Dropped leading entries are only skipped over and get erased once enough of them piled up.
+    std::string view_buffer;
+    size_t view_offset = 0;
+    size_t view_entries = 0;
+    size_t view_tail = 0;   // index of the oldest entry in the view
+
+    bool view_fits() const {
+        // same cut off as building the view newest to oldest and stopping at the first entry that
+        // wouldn't fit anymore: the oldest entry has to fit on top of everything newer than it.
+        const size_t view_size = view_buffer.size() - view_offset;
+        if (view_entries == 1)
+            return view_size - 2 < MAX_HISTORY_VIEW_LENGTH;
+
+        return view_size - 3 < MAX_HISTORY_VIEW_LENGTH;
+    }
+
+    void drop_oldest_view_entry() {
+        CaptionHistoryEntry &oldest = entries[view_tail];
+        view_offset += oldest.view_size;
+        oldest.view_size = 0;
+        view_entries--;
+
+        if (view_offset >= MAX_HISTORY_VIEW_LENGTH) {
+            view_buffer.erase(0, view_offset);
+            view_offset = 0;
+        }
+
+        if (!view_entries) {
+            view_buffer.clear();
+            view_offset = 0;
+            return;
+        }
+
+        // skip empty results, they were never part of the view
+        do {
+            view_tail = (view_tail + 1) % HISTORY_ENTRIES_CAPACITY;
+        } while (!entries[view_tail].view_size);
+    }
+
+public:
+    CaptionHistory() {
+        view_buffer.reserve(3 * MAX_HISTORY_VIEW_LENGTH);
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+    bool empty() const {
+        return count == 0;
+    }
+
+    // 0 is the newest entry
+    const CaptionHistoryEntry &from_newest(size_t index) const {
+        return entries[(head + HISTORY_ENTRIES_CAPACITY - index) % HISTORY_ENTRIES_CAPACITY];
+    }
+
+    void append(const std::string &clean_caption_text, const std::chrono::steady_clock::time_point &received_at) {
+        if (count == HISTORY_ENTRIES_CAPACITY) {
+            // slot of the oldest entry gets reused, make sure it's not in the view anymore
+            if (entries[(head + 1) % HISTORY_ENTRIES_CAPACITY].view_size)
+                drop_oldest_view_entry();
+        }
+
+        head = (head + 1) % HISTORY_ENTRIES_CAPACITY;
+        if (count < HISTORY_ENTRIES_CAPACITY)
+            count++;
+
+        CaptionHistoryEntry &entry = entries[head];
+        entry.clean_caption_text.assign(clean_caption_text);
+        entry.received_at = received_at;
+        entry.view_size = 0;
+
+        if (clean_caption_text.empty())
+            return;
+
+        entry.view_size = clean_caption_text.size() + 2;
+        if (!view_entries)
+            view_tail = head;
+        view_buffer.append(clean_caption_text);
+        view_buffer.append(". ");
+        view_entries++;
+
+        while (view_entries && !view_fits())
+            drop_oldest_view_entry();
+    }
+
+    void clear() {
+        for (auto &entry: entries) {
+            entry.clean_caption_text.clear();
+            entry.view_size = 0;
+        }
+        head = 0;
+        count = 0;
+        view_buffer.clear();
+        view_offset = 0;
+        view_entries = 0;
+        view_tail = 0;
+    }
+
+    // "first. second. third." for as many of the newest entries as fit into MAX_HISTORY_VIEW_LENGTH
+    void recent_text(std::string &output) const {
+        if (!view_entries) {
+            output.clear();
+            return;
+        }
+        // skip trailing space of the last ". "
+        output.assign(view_buffer, view_offset, view_buffer.size() - view_offset - 1);
+    }
+};
+
+}
+
+#endif //OBS_SPEECH2TEXT_PLUGIN_CAPTION_HISTORY_H
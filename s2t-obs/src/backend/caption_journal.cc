@@ -0,0 +1,334 @@
+// Copyright 2022 gab
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "caption_journal.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "spdlog/spdlog.h"
+
+#if _WIN32
+#define journal_fseek _fseeki64
+#define journal_ftell _ftelli64
+#else
+#define journal_fseek fseeko
+#define journal_ftell ftello
+#endif
+
+namespace backend {
+
+static const char JOURNAL_MAGIC[4] = {'S', '2', 'T', 'J'};
+static const char INDEX_MAGIC[4] = {'S', '2', 'T', 'I'};
+static const size_t JOURNAL_HEADER_SIZE = 16;
+static const size_t INDEX_HEADER_SIZE = 8;
+static const size_t INDEX_ENTRY_SIZE = 16;
+
+static void append_le(std::string &out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; i++)
+        out.push_back((char) ((value >> (8 * i)) & 0xff));
+}
+
+static void append_sized_string(std::string &out, const std::string &str) {
+    append_le(out, str.size(), 4);
+    out.append(str);
+}
+
+static uint64_t read_le(const char *data, int bytes) {
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; i++)
+        value |= (uint64_t) (unsigned char) data[i] << (8 * i);
+    return value;
+}
+
+static void append_file_header(std::string &out, const char magic[4]) {
+    out.append(magic, 4);
+    append_le(out, CAPTION_JOURNAL_VERSION, 2);
+    append_le(out, 0, 2);
+}
+
+static FILE *open_for_reading(const QString &path) {
+#if _WIN32
+    return _wfopen(path.toStdWString().c_str(), L"rb");
+#else
+    return fopen(path.toStdString().c_str(), "rb");
+#endif
+}
+
+QString caption_journal_index_path(const QString &journal_path) {
+    return journal_path + ".idx";
+}
+
+CaptionJournalWriter::CaptionJournalWriter(const std::chrono::steady_clock::time_point &started_at) :
+        started_at(started_at) {}
+
+bool CaptionJournalWriter::open(const QString &path, int64_t started_at_unix_ms) {
+    if (!journal.open(path, true) || !index.open(caption_journal_index_path(path), true))
+        return false;
+
+    std::string &out = journal.append_buffer();
+    append_file_header(out, JOURNAL_MAGIC);
+    append_le(out, (uint64_t) started_at_unix_ms, 8);
+    journal_size = out.size();
+    journal.entry_appended();
+
+    append_file_header(index.append_buffer(), INDEX_MAGIC);
+    index.entry_appended();
+    return true;
+}
+
+void CaptionJournalWriter::append(const OutputCaptionResult &result) {
+    const int64_t first_received_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        result.caption_result.first_received_at - started_at).count();
+    const int64_t received_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        result.caption_result.received_at - started_at).count();
+
+    if (received_ms >= next_index_ms) {
+        std::string &index_out = index.append_buffer();
+        append_le(index_out, (uint64_t) received_ms, 8);
+        append_le(index_out, journal_size, 8);
+        index.entry_appended();
+        next_index_ms = received_ms - received_ms % CAPTION_JOURNAL_INDEX_INTERVAL_MS + CAPTION_JOURNAL_INDEX_INTERVAL_MS;
+    }
+
+    std::string &out = journal.append_buffer();
+    const size_t record_start = out.size();
+    append_le(out, 0, 4);   // payload size, filled in below
+
+    uint8_t flags = 0;
+    if (result.caption_result.final)
+        flags |= 1;
+    if (result.interrupted)
+        flags |= 2;
+    out.push_back((char) flags);
+
+    uint64_t stability_bits;
+    std::memcpy(&stability_bits, &result.caption_result.stability, sizeof(stability_bits));
+
+    append_le(out, (uint32_t) result.caption_result.index, 4);
+    append_le(out, stability_bits, 8);
+    append_le(out, (uint64_t) first_received_ms, 8);
+    append_le(out, (uint64_t) received_ms, 8);
+    append_sized_string(out, result.caption_result.caption_text);
+    append_sized_string(out, result.clean_caption_text);
+    append_sized_string(out, result.output_line);
+
+    const uint64_t payload_size = out.size() - record_start - 4;
+    for (int i = 0; i < 4; i++)
+        out[record_start + i] = (char) ((payload_size >> (8 * i)) & 0xff);
+
+    journal_size += payload_size + 4;
+    journal.entry_appended();
+}
+
+std::chrono::steady_clock::time_point CaptionJournalWriter::flush_due_at() const {
+    return std::min(journal.flush_due_at(), index.flush_due_at());
+}
+
+bool CaptionJournalWriter::flush() {
+    // journal first so the index never points past its end on disk
+    const bool journal_ok = journal.flush();
+    return index.flush() && journal_ok;
+}
+
+bool CaptionJournalWriter::sync() {
+    const bool journal_ok = journal.sync();
+    return index.sync() && journal_ok;
+}
+
+void CaptionJournalWriter::close() {
+    journal.close();
+    index.close();
+}
+
+bool CaptionJournalReader::open(const QString &path) {
+    close();
+    file = open_for_reading(path);
+    if (!file) {
+        spdlog::error("caption journal: can't open '{}'", path.toStdString());
+        return false;
+    }
+
+    char header[JOURNAL_HEADER_SIZE];
+    if (fread(header, 1, JOURNAL_HEADER_SIZE, file) != JOURNAL_HEADER_SIZE || memcmp(header, JOURNAL_MAGIC, 4) != 0
+        || read_le(header + 4, 2) != CAPTION_JOURNAL_VERSION) {
+        spdlog::error("caption journal: '{}' is not a caption journal", path.toStdString());
+        close();
+        return false;
+    }
+    session_started_at_unix_ms = (int64_t) read_le(header + 8, 8);
+
+    if (!load_index(caption_journal_index_path(path))) {
+        spdlog::info("caption journal: no usable index for '{}', rebuilding it", path.toStdString());
+        rebuild_index();
+    }
+    return seek(0);
+}
+
+bool CaptionJournalReader::load_index(const QString &index_path) {
+    index.clear();
+    FILE *index_file = open_for_reading(index_path);
+    if (!index_file)
+        return false;
+
+    char header[INDEX_HEADER_SIZE];
+    bool ok = fread(header, 1, INDEX_HEADER_SIZE, index_file) == INDEX_HEADER_SIZE && memcmp(header, INDEX_MAGIC, 4) == 0
+        && read_le(header + 4, 2) == CAPTION_JOURNAL_VERSION;
+
+    char entry[INDEX_ENTRY_SIZE];
+    while (ok && fread(entry, 1, INDEX_ENTRY_SIZE, index_file) == INDEX_ENTRY_SIZE) {
+        CaptionJournalIndexEntry index_entry{(int64_t) read_le(entry, 8), read_le(entry + 8, 8)};
+        if (!index.empty() && (index_entry.offset <= index.back().offset || index_entry.received_ms < index.back().received_ms)) {
+            ok = false;
+            break;
+        }
+        index.push_back(index_entry);
+    }
+    fclose(index_file);
+
+    // the index can be flushed ahead of the journal, a crash in between leaves entries past its end
+    if (ok && journal_fseek(file, 0, SEEK_END) == 0) {
+        const uint64_t journal_size = journal_ftell(file);
+        while (!index.empty() && index.back().offset >= journal_size)
+            index.pop_back();
+    }
+
+    if (!ok)
+        index.clear();
+    return ok;
+}
+
+void CaptionJournalReader::rebuild_index() {
+    index.clear();
+    journal_fseek(file, JOURNAL_HEADER_SIZE, SEEK_SET);
+    has_peeked = false;
+
+    CaptionJournalRecord record;
+    int64_t next_index_ms = 0;
+    uint64_t offset = JOURNAL_HEADER_SIZE;
+    while (read_record(record)) {
+        if (record.received_ms >= next_index_ms) {
+            index.push_back(CaptionJournalIndexEntry{record.received_ms, offset});
+            next_index_ms = record.received_ms - record.received_ms % CAPTION_JOURNAL_INDEX_INTERVAL_MS + CAPTION_JOURNAL_INDEX_INTERVAL_MS;
+        }
+        offset += 4 + payload.size();
+    }
+}
+
+bool CaptionJournalReader::read_record(CaptionJournalRecord &record) {
+    char size_bytes[4];
+    if (fread(size_bytes, 1, 4, file) != 4)
+        return false;
+
+    const uint64_t payload_size = read_le(size_bytes, 4);
+    if (payload_size > CAPTION_JOURNAL_MAX_RECORD_SIZE)
+        return false;
+
+    payload.resize(payload_size);
+    if (fread(payload.data(), 1, payload_size, file) != payload_size)
+        return false;   // cut off record at the end
+
+    const char *pos = payload.data();
+    const char *end = pos + payload_size;
+    auto take = [&](size_t bytes) -> const char * {
+        if ((size_t) (end - pos) < bytes)
+            return nullptr;
+        const char *at = pos;
+        pos += bytes;
+        return at;
+    };
+    auto take_string = [&](std::string &out) -> bool {
+        const char *size_at = take(4);
+        if (!size_at)
+            return false;
+        const char *str_at = take(read_le(size_at, 4));
+        if (!str_at)
+            return false;
+        out.assign(str_at, read_le(size_at, 4));
+        return true;
+    };
+
+    const char *fixed = take(1 + 4 + 8 + 8 + 8);
+    if (!fixed)
+        return false;
+
+    const uint8_t flags = (uint8_t) fixed[0];
+    record.final = flags & 1;
+    record.interrupted = flags & 2;
+    record.index = (int) (uint32_t) read_le(fixed + 1, 4);
+    const uint64_t stability_bits = read_le(fixed + 5, 8);
+    std::memcpy(&record.stability, &stability_bits, sizeof(stability_bits));
+    record.first_received_ms = (int64_t) read_le(fixed + 13, 8);
+    record.received_ms = (int64_t) read_le(fixed + 21, 8);
+
+    return take_string(record.caption_text) && take_string(record.clean_caption_text) && take_string(record.output_line);
+}
+
+bool CaptionJournalReader::seek(int64_t from_ms) {
+    if (!file)
+        return false;
+
+    uint64_t offset = JOURNAL_HEADER_SIZE;
+    auto after = std::upper_bound(index.begin(), index.end(), from_ms,
+                                  [](int64_t ms, const CaptionJournalIndexEntry &entry) { return ms < entry.received_ms; });
+    if (after != index.begin())
+        offset = std::prev(after)->offset;
+
+    has_peeked = false;
+    if (journal_fseek(file, offset, SEEK_SET) != 0)
+        return false;
+
+    // at most one index interval worth of records to skip
+    while (read_record(peeked)) {
+        if (peeked.received_ms >= from_ms) {
+            has_peeked = true;
+            break;
+        }
+    }
+    return true;
+}
+
+bool CaptionJournalReader::next(CaptionJournalRecord &record) {
+    if (has_peeked) {
+        has_peeked = false;
+        record = std::move(peeked);
+        return true;
+    }
+    return file && read_record(record);
+}
+
+bool CaptionJournalReader::read_range(int64_t from_ms, int64_t to_ms, std::vector<CaptionJournalRecord> &records) {
+    if (!seek(from_ms))
+        return false;
+
+    CaptionJournalRecord record;
+    while (next(record) && record.received_ms <= to_ms)
+        records.push_back(std::move(record));
+    return true;
+}
+
+void CaptionJournalReader::close() {
+    if (file) {
+        fclose(file);
+        file = nullptr;
+    }
+    index.clear();
+    has_peeked = false;
+}
+
+CaptionJournalReader::~CaptionJournalReader() {
+    close();
+}
+
+}
@@ -0,0 +1,136 @@
+// Copyright 2022 gab
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef OBS_SPEECH2TEXT_PLUGIN_CAPTION_JOURNAL_H
+#define OBS_SPEECH2TEXT_PLUGIN_CAPTION_JOURNAL_H
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <QString>
+
+#include "post_caption_handler.h"
+#include "transcript_sink.h"
+
+namespace backend {
+
+#define CAPTION_JOURNAL_VERSION 1
+#define CAPTION_JOURNAL_INDEX_INTERVAL_MS 10000
+#define CAPTION_JOURNAL_MAX_RECORD_SIZE (16 * 1024 * 1024)
+
+/*
+ Caption journal: every caption result of a session, so any transcript format can be exported from it afterwards.
+
+ [path]: header "S2TJ" u16 version, u16 reserved, i64 session start (unix ms),
+         then records: u32 payload size, payload:
+             u8 flags (1: final, 2: interrupted), i32 result index, f64 stability,
+             i64 first_received_ms, i64 received_ms (both since session start),
+             u32 size + caption_text, u32 size + clean_caption_text, u32 size + output_line
+ [path].idx: header "S2TI" u16 version, u16 reserved,
+             then entries: i64 received_ms, u64 journal offset of the first record received at or after it,
+             one every CAPTION_JOURNAL_INDEX_INTERVAL_MS.
+
+ All little endian. Only ever appended to, a record cut off by a crash just ends the journal.
+*/
+
+struct CaptionJournalRecord {
+    bool final = false;
+    bool interrupted = false;
+    int index = 0;
+    double stability = 0.0;
+    int64_t first_received_ms = 0;
+    int64_t received_ms = 0;
+
+    std::string caption_text;
+    std::string clean_caption_text;
+    std::string output_line;
+};
+
+struct CaptionJournalIndexEntry {
+    int64_t received_ms;
+    uint64_t offset;
+};
+
+QString caption_journal_index_path(const QString &journal_path);
+
+class CaptionJournalWriter {
+    const std::chrono::steady_clock::time_point started_at;
+
+    TranscriptSink journal;
+    TranscriptSink index;
+    uint64_t journal_size = 0;
+    int64_t next_index_ms = 0;
+
+public:
+    explicit CaptionJournalWriter(const std::chrono::steady_clock::time_point &started_at);
+
+    bool open(const QString &path, int64_t started_at_unix_ms);
+
+    void append(const OutputCaptionResult &result);
+
+    std::chrono::steady_clock::time_point flush_due_at() const;
+
+    bool flush();
+
+    // flush() and have the OS put it on disk
+    bool sync();
+
+    void close();
+
+    bool failed() const {
+        return journal.failed() || index.failed();
+    }
+};
+
+class CaptionJournalReader {
+    FILE *file = nullptr;
+    int64_t session_started_at_unix_ms = 0;
+    std::vector<CaptionJournalIndexEntry> index;
+
+    std::vector<char> payload;
+    bool has_peeked = false;
+    CaptionJournalRecord peeked;
+
+    bool read_record(CaptionJournalRecord &record);
+
+    bool load_index(const QString &index_path);
+
+    void rebuild_index();
+
+public:
+    bool open(const QString &path);
+
+    int64_t started_at_unix_ms() const {
+        return session_started_at_unix_ms;
+    }
+
+    // next() returns the first record received at or after from_ms
+    bool seek(int64_t from_ms);
+
+    bool next(CaptionJournalRecord &record);
+
+    // records received within [from_ms, to_ms]
+    bool read_range(int64_t from_ms, int64_t to_ms, std::vector<CaptionJournalRecord> &records);
+
+    void close();
+
+    ~CaptionJournalReader();
+};
+
+}
+
+#endif //OBS_SPEECH2TEXT_PLUGIN_CAPTION_JOURNAL_H
@@ -0,0 +1,164 @@
+// Copyright 2022 gab
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef OBS_SPEECH2TEXT_PLUGIN_CAPTION_OUTPUT_QUEUE_H
+#define OBS_SPEECH2TEXT_PLUGIN_CAPTION_OUTPUT_QUEUE_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+
+#include "logging.h"
+#include "post_caption_handler.h"
+
+namespace backend {
+
+#define CAPTION_OUTPUT_QUEUE_MAX_ITEMS 256
+
+struct CaptionOutput {
+    std::shared_ptr<OutputCaptionResult> output_result;
+    bool is_clearance;
+
+    CaptionOutput(std::shared_ptr<OutputCaptionResult> output_result, bool is_clearance) :
+            output_result(output_result),
+            is_clearance(is_clearance) {};
+
+    CaptionOutput() : is_clearance(false) {}
+
+    bool is_interim() const {
+        return output_result && !is_clearance && !output_result->caption_result.final;
+    }
+};
+
+enum CaptionOutputQueueMode {
+    // every item, in order. For outputs that want to see all interims, like the raw transcript.
+    CAPTION_OUTPUT_QUEUE_MODE_ALL,
+
+    // a pending interim gets replaced by whatever result comes in after it, finals are all kept
+    CAPTION_OUTPUT_QUEUE_MODE_LATEST_INTERIM,
+};
+
+/*
+ Queue between the caption processing and an output writer.
+
+ A writer that falls behind, a transcript on a slow disk or a delayed stream output, only ever needs the newest
+ interim result, so in CAPTION_OUTPUT_QUEUE_MODE_LATEST_INTERIM a not yet dequeued interim is replaced instead of
+ queueing up behind it. Once CAPTION_OUTPUT_QUEUE_MAX_ITEMS are pending the oldest pending interim gets dropped to
+ make room. Finals and clearances are never dropped, with none but them pending the queue grows past the limit
+ and warns instead.
+*/
+class CaptionOutputQueue {
+    const CaptionOutputQueueMode mode;
+
+    std::mutex items_mutex;
+    std::condition_variable items_cv;
+    std::deque<CaptionOutput> items;
+
+    std::atomic<uint64_t> coalesced_count{0};
+    std::atomic<uint64_t> dropped_count{0};
+    std::atomic<uint64_t> over_limit_count{0};
+
+    // items_mutex held
+    bool drop_oldest_interim() {
+        for (auto it = items.begin(); it != items.end(); ++it) {
+            if (it->is_interim()) {
+                items.erase(it);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void pop_front(CaptionOutput &item) {
+        item = std::move(items.front());
+        items.pop_front();
+    }
+
+public:
+    explicit CaptionOutputQueue(CaptionOutputQueueMode mode) : mode(mode) {}
+
+    void enqueue(const CaptionOutput &item) {
+        {
+            std::lock_guard<std::mutex> lock(items_mutex);
+            // only the last item can be a pending interim, anything before it was already replaced
+            if (mode == CAPTION_OUTPUT_QUEUE_MODE_LATEST_INTERIM && item.output_result && !item.is_clearance
+                && !items.empty() && items.back().is_interim()) {
+                items.back() = item;
+                coalesced_count.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+
+            if (items.size() >= CAPTION_OUTPUT_QUEUE_MAX_ITEMS) {
+                if (drop_oldest_interim() || item.is_interim()) {
+                    dropped_count.fetch_add(1, std::memory_order_relaxed);
+                    // the new interim is the one to go when there was no older one
+                    if (items.size() >= CAPTION_OUTPUT_QUEUE_MAX_ITEMS)
+                        return;
+                } else {
+                    over_limit_count.fetch_add(1, std::memory_order_relaxed);
+                    S2T_WARN_EVERY_MS(5000, "caption output queue over its limit, {} finals pending, writer falling behind",
+                                      items.size());
+                }
+            }
+            items.push_back(item);
+        }
+        items_cv.notify_one();
+    }
+
+    void wait_dequeue(CaptionOutput &item) {
+        std::unique_lock<std::mutex> lock(items_mutex);
+        items_cv.wait(lock, [this] { return !items.empty(); });
+        pop_front(item);
+    }
+
+    template<typename Rep, typename Period>
+    bool wait_dequeue_timed(CaptionOutput &item, const std::chrono::duration<Rep, Period> &timeout) {
+        std::unique_lock<std::mutex> lock(items_mutex);
+        if (!items_cv.wait_for(lock, timeout, [this] { return !items.empty(); }))
+            return false;
+
+        pop_front(item);
+        return true;
+    }
+
+    bool try_dequeue(CaptionOutput &item) {
+        std::lock_guard<std::mutex> lock(items_mutex);
+        if (items.empty())
+            return false;
+
+        pop_front(item);
+        return true;
+    }
+
+    uint64_t coalesced() const {
+        return coalesced_count.load(std::memory_order_relaxed);
+    }
+
+    // interims only
+    uint64_t dropped() const {
+        return dropped_count.load(std::memory_order_relaxed);
+    }
+
+    // finals and clearances queued while over CAPTION_OUTPUT_QUEUE_MAX_ITEMS
+    uint64_t over_limit() const {
+        return over_limit_count.load(std::memory_order_relaxed);
+    }
+};
+
+}
+
+#endif //OBS_SPEECH2TEXT_PLUGIN_CAPTION_OUTPUT_QUEUE_H
@@ -0,0 +1,312 @@
+// Copyright 2022 gab
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "caption_search_index.h"
+
+#include <algorithm>
+
+#include "spdlog/spdlog.h"
+
+namespace backend {
+
+// rough size of a hash map node with its key, on top of the key's characters
+static const size_t TERM_OVERHEAD = sizeof(std::string) + sizeof(std::vector<int>) + 4 * sizeof(void *);
+
+static bool posting_less(const CaptionSearchPosting &a, const CaptionSearchPosting &b) {
+    return a.entry < b.entry || (a.entry == b.entry && a.position < b.position);
+}
+
+void split_search_terms(std::string_view text, std::vector<std::string> &terms) {
+    terms.clear();
+    std::string term;
+    for (const char c: text) {
+        const auto u = (unsigned char) c;
+        if (u >= 0x80 || isalnum(u)) {
+            term.push_back((char) (u < 0x80 ? tolower(u) : u));
+            continue;
+        }
+        if (!term.empty()) {
+            terms.push_back(std::move(term));
+            term.clear();
+        }
+    }
+    if (!term.empty())
+        terms.push_back(std::move(term));
+}
+
+CaptionSearchIndex::CaptionSearchIndex(size_t memory_budget) :
+        memory_budget(memory_budget),
+        started_at(std::chrono::steady_clock::now()),
+        journal(started_at) {}
+
+size_t CaptionSearchIndex::index_entry(Chunk &chunk, int64_t entry_session_ms, const std::string &text,
+                                       std::vector<std::string> &terms) {
+    const auto entry = (uint32_t) chunk.entries.size();
+    chunk.entries.push_back(Entry{entry_session_ms, text});
+    size_t memory = sizeof(Entry) + text.capacity();
+
+    split_search_terms(text, terms);
+    for (uint32_t position = 0; position < terms.size(); position++) {
+        auto [it, inserted] = chunk.postings.try_emplace(terms[position]);
+        if (inserted)
+            memory += TERM_OVERHEAD + terms[position].size();
+        it->second.push_back(Posting{entry, position});
+        memory += sizeof(Posting);
+    }
+
+    chunk.memory += memory;
+    return memory;
+}
+
+void CaptionSearchIndex::touch(Chunk &chunk) {
+    if (chunk.lru_it != lru.end())
+        lru.erase(chunk.lru_it);
+    lru.push_front(&chunk);
+    chunk.lru_it = lru.begin();
+}
+
+void CaptionSearchIndex::evict_over_budget() {
+    // never the newest chunk, captions are still added to it
+    while (memory_used > memory_budget && !lru.empty()) {
+        Chunk *chunk = lru.back();
+        if (chunk == chunks.back().get() || !journal_usable)
+            break;
+
+        lru.pop_back();
+        chunk->lru_it = lru.end();
+        chunk->loaded = false;
+        std::vector<Entry>().swap(chunk->entries);
+        std::unordered_map<std::string, std::vector<Posting>>().swap(chunk->postings);
+        memory_used -= chunk->memory;
+        chunk->memory = 0;
+    }
+}
+
+bool CaptionSearchIndex::read_chunk(CaptionJournalReader &reader, Chunk &chunk, std::vector<std::string> &terms) {
+    std::vector<CaptionJournalRecord> records;
+    const int64_t from_ms = chunk.number * CAPTION_SEARCH_CHUNK_MS;
+    if (!reader.read_range(from_ms, from_ms + CAPTION_SEARCH_CHUNK_MS - 1, records))
+        return false;
+
+    for (const auto &record: records) {
+        if (record.final && !record.clean_caption_text.empty())
+            index_entry(chunk, record.first_received_ms, record.clean_caption_text, terms);
+    }
+    return true;
+}
+
+void CaptionSearchIndex::restore_chunk(Chunk &chunk, Chunk &read) {
+    chunk.entries = std::move(read.entries);
+    chunk.postings = std::move(read.postings);
+    chunk.memory = read.memory;
+    chunk.loaded = true;
+    memory_used += chunk.memory;
+    touch(chunk);
+}
+
+void CaptionSearchIndex::add(const OutputCaptionResult &result) {
+    if (!result.caption_result.final || result.clean_caption_text.empty())
+        return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    const int64_t at_ms = std::max<int64_t>(0, session_ms(result.caption_result.received_at));
+    const int64_t number = at_ms / CAPTION_SEARCH_CHUNK_MS;
+    // hits jump to where the sentence started, chunks go by when it was received like the journal's ranges
+    const int64_t first_at_ms = std::max<int64_t>(0, session_ms(result.caption_result.first_received_at));
+
+    if (chunks.empty() || chunks.back()->number != number) {
+        chunks.push_back(std::make_unique<Chunk>());
+        chunks.back()->number = number;
+        chunks.back()->lru_it = lru.end();
+    }
+    Chunk &chunk = *chunks.back();
+    if (!chunk.loaded && journal_usable) {
+        // only with a budget smaller than a single chunk, read it back before the journal has this caption
+        CaptionJournalReader reader;
+        Chunk read;
+        read.number = chunk.number;
+        if (journal.flush() && reader.open(journal_path) && read_chunk(reader, read, terms))
+            restore_chunk(chunk, read);
+    }
+
+    if (journal_usable) {
+        if (!journal_dir) {
+            journal_dir = std::make_unique<QTemporaryDir>();
+            journal_path = journal_dir->filePath("captions.s2tj");
+            const int64_t started_at_unix_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count() - at_ms;
+            journal_usable = journal_dir->isValid() && journal.open(journal_path, started_at_unix_ms);
+            if (!journal_usable)
+                spdlog::warn("caption search: no journal, keeping the whole index in memory");
+        }
+        if (journal_usable) {
+            journal.append(result);
+            if (journal.flush_due_at() <= std::chrono::steady_clock::now())
+                journal.flush();
+            journal_usable = !journal.failed();
+        }
+    }
+
+    memory_used += index_entry(chunk, first_at_ms, result.clean_caption_text, terms);
+    touch(chunk);
+    evict_over_budget();
+}
+
+void CaptionSearchIndex::output_started(CaptionSearchOutput output, const std::chrono::steady_clock::time_point &at) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto &spans = output == CAPTION_SEARCH_OUTPUT_STREAM ? stream_spans : recording_spans;
+    if (!spans.empty() && spans.back().second == INT64_MAX)
+        spans.back().second = session_ms(at);
+    spans.emplace_back(session_ms(at), INT64_MAX);
+}
+
+void CaptionSearchIndex::output_stopped(CaptionSearchOutput output, const std::chrono::steady_clock::time_point &at) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto &spans = output == CAPTION_SEARCH_OUTPUT_STREAM ? stream_spans : recording_spans;
+    if (!spans.empty() && spans.back().second == INT64_MAX)
+        spans.back().second = session_ms(at);
+}
+
+int64_t CaptionSearchIndex::span_offset(const std::vector<std::pair<int64_t, int64_t>> &spans, int64_t at_session_ms) {
+    for (auto it = spans.rbegin(); it != spans.rend(); ++it) {
+        if (at_session_ms >= it->first && at_session_ms < it->second)
+            return at_session_ms - it->first;
+    }
+    return -1;
+}
+
+static bool has_posting(const std::vector<CaptionSearchPosting> &postings, uint32_t entry, uint32_t position) {
+    return std::binary_search(postings.begin(), postings.end(), CaptionSearchPosting{entry, position}, posting_less);
+}
+
+static bool has_entry(const std::vector<CaptionSearchPosting> &postings, uint32_t entry) {
+    const auto it = std::lower_bound(postings.begin(), postings.end(), CaptionSearchPosting{entry, 0}, posting_less);
+    return it != postings.end() && it->entry == entry;
+}
+
+void CaptionSearchIndex::search_chunk(const Chunk &chunk, const std::vector<std::string> &query_terms, bool phrase,
+                                      size_t max_hits, std::vector<CaptionSearchHit> &hits) {
+    std::vector<const std::vector<Posting> *> term_postings;
+    for (const auto &term: query_terms) {
+        const auto it = chunk.postings.find(term);
+        if (it == chunk.postings.end())
+            return;
+        term_postings.push_back(&it->second);
+    }
+
+    std::vector<uint32_t> matches;
+    if (phrase) {
+        // every occurrence of the first term, followed by the others
+        for (const auto &first: *term_postings[0]) {
+            if (!matches.empty() && matches.back() == first.entry)
+                continue;
+
+            bool match = true;
+            for (size_t i = 1; match && i < term_postings.size(); i++)
+                match = has_posting(*term_postings[i], first.entry, first.position + i);
+            if (match)
+                matches.push_back(first.entry);
+        }
+    } else {
+        // walk the rarest term, look the others up
+        const auto rarest = std::min_element(term_postings.begin(), term_postings.end(),
+            [](const std::vector<Posting> *a, const std::vector<Posting> *b) { return a->size() < b->size(); });
+        for (const auto &candidate: **rarest) {
+            if (!matches.empty() && matches.back() == candidate.entry)
+                continue;
+
+            bool match = true;
+            for (size_t i = 0; match && i < term_postings.size(); i++)
+                match = term_postings[i] == *rarest || has_entry(*term_postings[i], candidate.entry);
+            if (match)
+                matches.push_back(candidate.entry);
+        }
+    }
+
+    for (auto it = matches.rbegin(); it != matches.rend() && hits.size() < max_hits; ++it) {
+        const Entry &entry = chunk.entries[*it];
+        CaptionSearchHit hit;
+        hit.session_ms = entry.session_ms;
+        hit.text = entry.text;
+        hits.push_back(std::move(hit));
+    }
+}
+
+void CaptionSearchIndex::search(const std::string &query, size_t max_hits, std::vector<CaptionSearchHit> &hits) {
+    hits.clear();
+
+    std::string_view query_text = query;
+    while (!query_text.empty() && isspace((unsigned char) query_text.front()))
+        query_text.remove_prefix(1);
+    while (!query_text.empty() && isspace((unsigned char) query_text.back()))
+        query_text.remove_suffix(1);
+    const bool phrase = query_text.size() >= 2 && query_text.front() == '"' && query_text.back() == '"';
+
+    std::vector<std::string> query_terms;
+    split_search_terms(query_text, query_terms);
+    if (query_terms.empty() || !max_hits)
+        return;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    CaptionJournalReader reader;
+    bool reader_open = false;
+    std::vector<std::string> read_terms;
+    for (size_t i = chunks.size(); i-- > 0 && hits.size() < max_hits;) {
+        Chunk &chunk = *chunks[i];
+        const size_t hits_before = hits.size();
+        if (chunk.loaded) {
+            search_chunk(chunk, query_terms, phrase, max_hits, hits);
+            if (hits.size() != hits_before)
+                touch(chunk);
+            continue;
+        }
+        if (!journal_usable)
+            continue;
+
+        // the journal has everything up to here, chunks only get evicted once newer ones exist
+        if (!reader_open && !journal.flush())
+            break;
+        const QString path = journal_path;
+        Chunk read;
+        read.number = chunk.number;
+
+        // reading the journal can take a while, captions keep getting added meanwhile
+        lock.unlock();
+        if (!reader_open) {
+            reader_open = reader.open(path);
+            if (!reader_open)
+                spdlog::error("caption search: can't read back '{}'", path.toStdString());
+        }
+        const bool read_ok = reader_open && read_chunk(reader, read, read_terms);
+        lock.lock();
+        if (!reader_open)
+            break;
+        if (!read_ok)
+            continue;
+
+        // only chunks with hits stay, one at a time within the budget
+        search_chunk(read, query_terms, phrase, max_hits, hits);
+        if (hits.size() != hits_before && !chunk.loaded) {
+            restore_chunk(chunk, read);
+            evict_over_budget();
+        }
+    }
+
+    for (auto &hit: hits) {
+        hit.stream_ms = span_offset(stream_spans, hit.session_ms);
+        hit.recording_ms = span_offset(recording_spans, hit.session_ms);
+    }
+}
+
+}
@@ -0,0 +1,152 @@
+// Copyright 2022 gab
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef OBS_SPEECH2TEXT_PLUGIN_CAPTION_SEARCH_INDEX_H
+#define OBS_SPEECH2TEXT_PLUGIN_CAPTION_SEARCH_INDEX_H
+
+#include <chrono>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <QTemporaryDir>
+
+#include "caption_journal.h"
+#include "post_caption_handler.h"
+
+namespace backend {
+
+#define CAPTION_SEARCH_CHUNK_MS 60000
+#define CAPTION_SEARCH_MEMORY_BUDGET (8 * 1024 * 1024)
+
+struct CaptionSearchHit {
+    int64_t session_ms = 0;         // since the captioner started, to when the caption started being said
+    int64_t stream_ms = -1;         // into the stream it was said in, -1 if none was running
+    int64_t recording_ms = -1;      // same for the recording
+    std::string text;
+};
+
+struct CaptionSearchPosting {
+    uint32_t entry;     // caption within its chunk
+    uint32_t position;  // word within the caption
+};
+
+enum CaptionSearchOutput {
+    CAPTION_SEARCH_OUTPUT_STREAM,
+    CAPTION_SEARCH_OUTPUT_RECORDING,
+};
+
+/*
+ Word index over the final captions of a session, so the dock can find when something was said.
+
+ Captions are indexed in chunks of CAPTION_SEARCH_CHUNK_MS, each with its own term -> (caption, word position)
+ postings. Every final also goes to a caption journal in a temporary directory, the on-disk copy of the session.
+ Once the chunks take more than the memory budget the least recently used ones are dropped and only read back
+ from the journal when a search needs them again, the chunk still being written is never dropped. A search reads
+ them back one at a time without holding the lock, and only keeps those it found something in.
+
+ Terms are lowercased ASCII letters and digits, any non ASCII byte counts as a letter. A query matches captions
+ containing all of its terms, in a "quoted query" they have to follow each other.
+ Called from the caption processing thread and a search thread.
+*/
+class CaptionSearchIndex {
+    using Posting = CaptionSearchPosting;
+
+    struct Entry {
+        int64_t session_ms;
+        std::string text;
+    };
+
+    struct Chunk {
+        int64_t number;     // session_ms / CAPTION_SEARCH_CHUNK_MS
+        bool loaded = true;
+        std::vector<Entry> entries;
+        std::unordered_map<std::string, std::vector<Posting>> postings;
+        size_t memory = 0;
+        std::list<Chunk *>::iterator lru_it;
+    };
+
+    mutable std::mutex mutex;
+    const size_t memory_budget;
+    const std::chrono::steady_clock::time_point started_at;
+
+    std::vector<std::unique_ptr<Chunk>> chunks;     // oldest first
+    std::list<Chunk *> lru;                         // loaded chunks, most recently used first
+    size_t memory_used = 0;
+
+    // [start, end) in session ms, end is INT64_MAX while still running
+    std::vector<std::pair<int64_t, int64_t>> stream_spans;
+    std::vector<std::pair<int64_t, int64_t>> recording_spans;
+
+    std::unique_ptr<QTemporaryDir> journal_dir;
+    CaptionJournalWriter journal;
+    QString journal_path;
+    bool journal_usable = true;
+
+    // reused between captions
+    std::vector<std::string> terms;
+
+    int64_t session_ms(const std::chrono::steady_clock::time_point &at) const {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(at - started_at).count();
+    }
+
+    // returns the memory it added to the chunk
+    static size_t index_entry(Chunk &chunk, int64_t entry_session_ms, const std::string &text, std::vector<std::string> &terms);
+
+    void touch(Chunk &chunk);
+
+    void evict_over_budget();
+
+    // the chunk's captions from the journal, doesn't touch the index
+    static bool read_chunk(CaptionJournalReader &reader, Chunk &chunk, std::vector<std::string> &terms);
+
+    // makes a chunk read back by read_chunk() the loaded one, mutex held
+    void restore_chunk(Chunk &chunk, Chunk &read);
+
+    static void search_chunk(const Chunk &chunk, const std::vector<std::string> &query_terms, bool phrase, size_t max_hits,
+                             std::vector<CaptionSearchHit> &hits);
+
+    static int64_t span_offset(const std::vector<std::pair<int64_t, int64_t>> &spans, int64_t at_session_ms);
+
+public:
+    explicit CaptionSearchIndex(size_t memory_budget = CAPTION_SEARCH_MEMORY_BUDGET);
+
+    // final results with text only, others are ignored
+    void add(const OutputCaptionResult &result);
+
+    // for mapping hits to stream and recording offsets
+    void output_started(CaptionSearchOutput output, const std::chrono::steady_clock::time_point &at);
+
+    void output_stopped(CaptionSearchOutput output, const std::chrono::steady_clock::time_point &at);
+
+    // newest first, reads the journal, not for the UI thread
+    void search(const std::string &query, size_t max_hits, std::vector<CaptionSearchHit> &hits);
+
+    size_t memory_usage() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return memory_used;
+    }
+};
+
+// "some Words, and more" -> "some", "words", "and", "more"
+void split_search_terms(std::string_view text, std::vector<std::string> &terms);
+
+}
+
+#endif //OBS_SPEECH2TEXT_PLUGIN_CAPTION_SEARCH_INDEX_H
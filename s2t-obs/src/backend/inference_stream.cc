@@ -16,12 +16,16 @@
 
 #include <memory>
 #include <mutex>
+#include <grpcpp/client_context.h>
 #include <spdlog/spdlog.h>
 #include <thread>
 
+#include "logging.h"
+#include "trace.h"
+
 namespace backend {
 
-static void audio_sender_thread(std::shared_ptr<InferenceStream> self);
+static void audio_sender_thread(InferenceStream &self);
 
 static void _audio_sender(InferenceStream &self);
 
@@ -31,12 +35,12 @@ static void read_results_loop_thread(
 );
 
 InferenceStream::InferenceStream(const InferenceStreamSettings settings) : settings(settings), session_pair(random_session_pair()) {
-    spdlog::debug("InferenceStream GRPC Speech, created session pair: %s", session_pair.c_str());
+    spdlog::debug("InferenceStream GRPC Speech, created session pair: {}", session_pair.c_str());
 }
 
 bool InferenceStream::start(std::shared_ptr<InferenceStream> self) {
     // Requires the InferenceStream to have been made as shared_pointer and passed to itself to start.
-    // Kept by each thread to ensure the object isn't deconstructed before all threads are done.
+    // The threads only get a reference, the destructor joins them before anything they use is gone.
 
     if (self.get() != this)
         return false;
@@ -46,20 +50,49 @@ bool InferenceStream::start(std::shared_ptr<InferenceStream> self) {
 
     started = true;
 
-    std::thread upstream_thread(audio_sender_thread, self);
-    upstream_thread.detach();
+    InferenceStream &stream = *this;
+    sender_thread = WorkerThread("s2t net sender", WORKER_ROLE_NETWORK, [&stream]() { audio_sender_thread(stream); });
     return true;
 }
 
-static void audio_sender_thread(std::shared_ptr<InferenceStream> self) {
-    spdlog::debug("starting audio_sender_thread() thread");
-    if (!self) {
-        self->stop();
-        spdlog::debug("audio_sender_thread() no self");
+void InferenceStream::stop() {
+    if (stopped.exchange(true))
         return;
+
+    {
+        std::lock_guard<std::mutex> lock(context_mutex);
+        if (context)
+            context->TryCancel();
     }
-    _audio_sender(*self);
-    self->stop();
+
+    // an empty chunk is skipped, the sender checks is_stopped() right after instead of waiting out send_timeout_ms
+    audio_queue.enqueue(new std::string());
+}
+
+bool InferenceStream::is_stopped() {
+    return stopped.load();
+}
+
+void InferenceStream::set_context(grpc::ClientContext *call_context) {
+    std::lock_guard<std::mutex> lock(context_mutex);
+    context = call_context;
+    if (context && stopped.load())
+        context->TryCancel();
+}
+
+InferenceStream::~InferenceStream() {
+    stop();
+    sender_thread.join();
+
+    std::string *audio_chunk;
+    while (audio_queue.try_dequeue(audio_chunk))
+        delete audio_chunk;
+}
+
+static void audio_sender_thread(InferenceStream &self) {
+    spdlog::debug("starting audio_sender_thread() thread");
+    _audio_sender(self);
+    self.stop();
     spdlog::debug("finished audio_sender_thread() thread");
 }
 
@@ -94,11 +127,12 @@ static void write_audio_loop(
         }
 
         if (audio_chunk->empty()) {
-            spdlog::debug("got 0 size audio chunk. ignored");
+            SPDLOG_TRACE("got 0 size audio chunk. ignored");
             delete audio_chunk;
             continue;
         }
 
+        S2T_TRACE_SPAN("inference send audio");
         request.set_audio_content(*audio_chunk);
 
         if (!streamer->Write(request)) {
@@ -107,8 +141,7 @@ static void write_audio_loop(
             break;
         }
 
-        if (chunk_count % 20 == 0)
-            spdlog::debug("sent audio chunk {}, {} bytes", chunk_count, audio_chunk->size());
+        S2T_DEBUG_EVERY_MS(1000, "sent audio chunk {}, {} bytes", chunk_count, audio_chunk->size());
 
         delete audio_chunk;
         chunk_count++;
@@ -127,16 +160,12 @@ static void read_results_loop_thread(
         if (self.is_stopped())
             break;
 
-        spdlog::info("Result size: {}", response.result_size());
+        S2T_TRACE_SPAN("inference read result");
+        S2T_DEBUG_EVERY_MS(1000, "result size: {}", response.result_size());
         auto now = std::chrono::stead_clock::now();
         auto alternative = result.alternatives(0);
         RawResult raw_result(0, true, 1.0, alternative.transcript(), "", first_received_at, now);
-        {
-            std::lock_guard<std::recursive_mutex> lock(self.on_caption_cb_handle.mutex);
-            if (self.on_caption_cb_handle.callback_fn) {
-                self.on_caption_cb_handle.callback_fn(raw_result);
-            }
-        }
+        self.on_caption_cb_handle.invoke(raw_result);
     }
     spdlog::debug("read_results_loop_thread stopped");
     self.stop();
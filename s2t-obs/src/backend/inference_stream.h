@@ -15,17 +15,25 @@
 #ifndef OBS_SPEECH2TEXT_PLUGIN_INFERENCE_STREAM_H
 #define OBS_SPEECH2TEXT_PLUGIN_INFERENCE_STREAM_H
 
+#include <atomic>
 #include <cstdint>
 #include <functional>
+#include <mutex>
 
 #include <moodycamel/blockingconcurrentqueue.h>
 
 #include "raw_result.h"
 #include "threadsafe_cb.h"
+#include "worker_runtime.h"
+
+namespace grpc {
+class ClientContext;
+}
 
 namespace backend {
 
-typedef std::function<void(const RawResult &raw_result)> caption_text_callback;
+// the callee may move from raw_result, it's not used after
+typedef std::function<void(RawResult &raw_result)> caption_text_callback;
 typedef unsigned int uint;
 
 struct InferenceStreamSettings {
@@ -76,14 +84,27 @@ class InferenceStream {
     moodycamel::BlockingConcurrentQueue<std::string *> audio_queue;
 
     bool started = false;
-    bool stopped = false;
+    std::atomic<bool> stopped{false};
+
+    // the call in progress, stop() cancels it so a Read() or Write() blocked on the network returns
+    std::mutex context_mutex;
+    grpc::ClientContext *context = nullptr;
+
+    // joined by the destructor before any member is gone
+    WorkerThread sender_thread;
 
 public:
     const InferenceStreamSettings settings;
     ThreadsafeCb<caption_text_callback> on_caption_cb_handle;
     InferenceStream(const InferenceStreamSettings settings);
     bool start(std::shared_ptr<InferenceStream> self);
+
+    // cancels the call and wakes the sender, returns right away, the threads finish on their own
     void stop();
+
+    // set by the sender while its call is open, nullptr when done with it
+    void set_context(grpc::ClientContext *call_context);
+
     bool is_stopped();
     bool queue_audio_data(const char *data, const uint data_size);
     std::string *dequeue_audio_data(const std::int64_t timeout_us);
@@ -0,0 +1,157 @@
+// Copyright 2022 gab
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef OBS_SPEECH2TEXT_PLUGIN_INTERIM_PACER_H
+#define OBS_SPEECH2TEXT_PLUGIN_INTERIM_PACER_H
+
+#include "result_pool.h"
+
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+
+namespace backend {
+
+struct InterimPacingStats {
+    uint64_t finals = 0;
+    uint64_t interim_updates = 0;
+    uint64_t dropped_unstable = 0;  // below the stability threshold
+    uint64_t dropped_superseded = 0;    // held back by the rate limit and replaced by a newer result before going out
+};
+
+/*
+ Limits how often interim results get formatted and sent to the outputs.
+
+ Interim updates go out at most every min_interval_ns, which is a whole number of video frames, counted from the
+ video frame the previous update went out with, so updates line up with the frames rendering them.
+ An interim arriving too early is held back and replaced by newer ones, the newest goes out once its slot comes up.
+ Interims below the stability threshold are dropped. Finals and interrupted results always go out right away and
+ drop a held interim, they supersede it.
+
+ Only meant to be used from one thread, the stats can be read from anywhere.
+*/
+class InterimPacer {
+    uint64_t min_interval_ns = 0;   // 0: no limit
+    double min_stability = 0.0;
+
+    bool has_last_update = false;
+    uint64_t last_update_frame_ns = 0;
+
+    RawResultPtr held;
+
+    std::atomic<uint64_t> finals{0};
+    std::atomic<uint64_t> interim_updates{0};
+    std::atomic<uint64_t> dropped_unstable{0};
+    std::atomic<uint64_t> dropped_superseded{0};
+
+    void count(std::atomic<uint64_t> &counter) {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    void mark_update(uint64_t now_ns, uint64_t frame_ns) {
+        has_last_update = true;
+        // no frame rendered yet, nothing to line up with
+        last_update_frame_ns = frame_ns && frame_ns <= now_ns ? frame_ns : now_ns;
+        count(interim_updates);
+    }
+
+public:
+    // updates_per_second 0: unlimited. frame_interval_ns 0: no video running, interval not rounded to frames
+    void configure(uint32_t updates_per_second, double stability_threshold, uint64_t frame_interval_ns) {
+        min_stability = stability_threshold;
+        if (!updates_per_second) {
+            min_interval_ns = 0;
+            return;
+        }
+
+        const uint64_t wanted_ns = 1000000000ULL / updates_per_second;
+        if (!frame_interval_ns) {
+            min_interval_ns = wanted_ns;
+            return;
+        }
+
+        const uint64_t frames = (uint64_t) std::llround((double) wanted_ns / (double) frame_interval_ns);
+        min_interval_ns = (frames ? frames : 1) * frame_interval_ns;
+    }
+
+    // true if the result should be output now, otherwise it was either dropped or is held for next_slot_ns()
+    bool admit(const RawResultPtr &result, bool interrupted, uint64_t now_ns, uint64_t frame_ns) {
+        if (result->final || interrupted) {
+            if (held) {
+                held = nullptr;
+                count(dropped_superseded);
+            }
+            has_last_update = false;
+            count(finals);
+            return true;
+        }
+
+        if (result->stability < min_stability) {
+            count(dropped_unstable);
+            return false;
+        }
+
+        if (!min_interval_ns || !has_last_update || now_ns >= last_update_frame_ns + min_interval_ns) {
+            if (held) {
+                held = nullptr;
+                count(dropped_superseded);
+            }
+            mark_update(now_ns, frame_ns);
+            return true;
+        }
+
+        if (held)
+            count(dropped_superseded);
+        held = result;
+        return false;
+    }
+
+    bool has_held_result() const {
+        return held != nullptr;
+    }
+
+    uint64_t next_slot_ns() const {
+        return last_update_frame_ns + min_interval_ns;
+    }
+
+    // hands out the held interim once its slot came up
+    bool take_held(RawResultPtr &result, uint64_t now_ns, uint64_t frame_ns) {
+        if (!held || now_ns < next_slot_ns())
+            return false;
+
+        result = std::move(held);
+        held = nullptr;
+        mark_update(now_ns, frame_ns);
+        return true;
+    }
+
+    // when the stream stops or restarts, whatever the old one held back is dropped
+    void reset() {
+        has_last_update = false;
+        held = nullptr;
+    }
+
+    InterimPacingStats stats() const {
+        InterimPacingStats stats;
+        stats.finals = finals.load(std::memory_order_relaxed);
+        stats.interim_updates = interim_updates.load(std::memory_order_relaxed);
+        stats.dropped_unstable = dropped_unstable.load(std::memory_order_relaxed);
+        stats.dropped_superseded = dropped_superseded.load(std::memory_order_relaxed);
+        return stats;
+    }
+};
+
+}
+
+#endif //OBS_SPEECH2TEXT_PLUGIN_INTERIM_PACER_H
@@ -0,0 +1,118 @@
+// Copyright 2022 gab
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "logging.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <spdlog/async.h>
+#include <spdlog/sinks/base_sink.h>
+#include <spdlog/sinks/stdout_color_sinks.h>
+
+namespace backend {
+
+std::atomic<uint64_t> LogRateLimit::total_suppressed{0};
+
+/*
+ flush() of the async logger only queues a request. To wait for the queue, flush_logging() logs a numbered marker
+ through a second logger on the same single thread pool: once it reaches this sink, everything queued before it
+ went out too.
+*/
+class LogFlushMarkerSink : public spdlog::sinks::base_sink<std::mutex> {
+    std::mutex reached_mutex;
+    std::condition_variable reached_cv;
+    uint64_t reached = 0;
+
+protected:
+    void sink_it_(const spdlog::details::log_msg &msg) override {
+        const uint64_t marker = std::stoull(std::string(msg.payload.data(), msg.payload.size()));
+        {
+            std::lock_guard<std::mutex> lock(reached_mutex);
+            reached = std::max(reached, marker);
+        }
+        reached_cv.notify_all();
+    }
+
+    void flush_() override {}
+
+public:
+    bool wait_for(uint64_t marker, const std::chrono::milliseconds &timeout) {
+        std::unique_lock<std::mutex> lock(reached_mutex);
+        return reached_cv.wait_for(lock, timeout, [this, marker]() { return reached >= marker; });
+    }
+};
+
+static std::shared_ptr<spdlog::sinks::sink> log_sink;
+static std::shared_ptr<LogFlushMarkerSink> flush_marker_sink;
+static std::shared_ptr<spdlog::async_logger> flush_marker_logger;
+static std::atomic<uint64_t> flush_markers{0};
+
+void init_logging(std::shared_ptr<spdlog::sinks::sink> sink) {
+    spdlog::init_thread_pool(PLUGIN_LOG_QUEUE_SIZE, 1);
+
+    log_sink = sink ? std::move(sink) : std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
+    auto logger = std::make_shared<spdlog::async_logger>("s2t", log_sink, spdlog::thread_pool(),
+                                                         spdlog::async_overflow_policy::overrun_oldest);
+
+    // what wasn't compiled out is logged, release builds keep info and above
+    logger->set_level(static_cast<spdlog::level::level_enum>(SPDLOG_ACTIVE_LEVEL));
+    logger->flush_on(spdlog::level::warn);
+    spdlog::set_default_logger(logger);
+
+    // blocks instead, a marker is only logged by flush_logging()
+    flush_marker_sink = std::make_shared<LogFlushMarkerSink>();
+    flush_marker_logger = std::make_shared<spdlog::async_logger>("s2t flush", flush_marker_sink, spdlog::thread_pool(),
+                                                                 spdlog::async_overflow_policy::block);
+    flush_marker_logger->set_level(spdlog::level::trace);
+}
+
+bool flush_logging() {
+    if (!flush_marker_logger || !spdlog::thread_pool()) {
+        spdlog::default_logger()->flush();
+        return true;
+    }
+
+    const uint64_t marker = ++flush_markers;
+    flush_marker_logger->log(spdlog::level::critical, "{}", marker);
+    // the marker can still be overrun by messages queued after it
+    const bool reached = flush_marker_sink->wait_for(marker, std::chrono::milliseconds(PLUGIN_LOG_FLUSH_TIMEOUT_MS));
+    log_sink->flush();
+    return reached;
+}
+
+void shutdown_logging() {
+    const LogStats stats = log_stats();
+    spdlog::info("logging: {} messages dropped with the queue full, {} suppressed by rate limits", stats.dropped, stats.suppressed);
+
+    // the logging thread has to be gone before OBS unloads the module
+    flush_marker_logger = nullptr;
+    spdlog::shutdown();
+    if (log_sink)
+        spdlog::set_default_logger(std::make_shared<spdlog::logger>("s2t", log_sink));
+}
+
+LogStats log_stats() {
+    LogStats stats;
+    auto pool = spdlog::thread_pool();
+    if (pool)
+        stats.dropped = pool->overrun_counter();
+    stats.suppressed = LogRateLimit::total_suppressed.load(std::memory_order_relaxed);
+    return stats;
+}
+
+}
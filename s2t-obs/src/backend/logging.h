@@ -0,0 +1,122 @@
+// Copyright 2022 gab
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef OBS_SPEECH2TEXT_PLUGIN_LOGGING_H
+#define OBS_SPEECH2TEXT_PLUGIN_LOGGING_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+#include <spdlog/spdlog.h>
+
+namespace backend {
+
+// messages waiting for the logging thread, when full the oldest ones are dropped instead of blocking the caller
+#define PLUGIN_LOG_QUEUE_SIZE 8192
+// flush_logging() gives up after this, its marker can be dropped with the queue full like any message
+#define PLUGIN_LOG_FLUSH_TIMEOUT_MS 2000
+
+struct LogStats {
+    uint64_t dropped = 0;       // queue was full
+    uint64_t suppressed = 0;    // rate limited call sites
+};
+
+/*
+ Makes the default logger asynchronous: spdlog::info() and co only format the message and queue it,
+ a single logging thread writes it out to sink, stdout if null. Call before anything logs, the threads started
+ before keep the old logger.
+*/
+void init_logging(std::shared_ptr<spdlog::sinks::sink> sink = nullptr);
+
+// waits until the logging thread wrote everything queued so far and flushes the sink, at most
+// PLUGIN_LOG_FLUSH_TIMEOUT_MS. False if it timed out
+bool flush_logging();
+
+// writes what's queued and joins the logging thread, anything logged after is written synchronously
+void shutdown_logging();
+
+LogStats log_stats();
+
+// one per call site, lets one message through every interval and counts the rest
+class LogRateLimit {
+    const int64_t interval_ns;
+    std::atomic<int64_t> next_at_ns{0};
+    std::atomic<uint64_t> suppressed{0};
+
+    static std::atomic<uint64_t> total_suppressed;
+
+    friend LogStats log_stats();
+
+public:
+    explicit LogRateLimit(uint32_t interval_ms) : interval_ns((int64_t) interval_ms * 1000000) {}
+
+    // suppressed_since: messages this call site skipped since the last one it let through
+    bool allow(uint64_t &suppressed_since) {
+        const int64_t now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+
+        int64_t next_ns = next_at_ns.load(std::memory_order_relaxed);
+        if (now_ns < next_ns || !next_at_ns.compare_exchange_strong(next_ns, now_ns + interval_ns, std::memory_order_relaxed)) {
+            suppressed.fetch_add(1, std::memory_order_relaxed);
+            total_suppressed.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        suppressed_since = suppressed.exchange(0, std::memory_order_relaxed);
+        return true;
+    }
+};
+
+}
+
+// logs at most once every interval_ms from this call site, nothing is formatted for the ones skipped
+#define S2T_LOG_EVERY_MS(level, interval_ms, ...) \
+    do { \
+        static backend::LogRateLimit s2t_log_rate_limit(interval_ms); \
+        uint64_t s2t_log_suppressed = 0; \
+        if (spdlog::should_log(level) && s2t_log_rate_limit.allow(s2t_log_suppressed)) { \
+            if (s2t_log_suppressed) \
+                spdlog::log(level, "{} similar messages suppressed ({}:{})", s2t_log_suppressed, __FILE__, __LINE__); \
+            spdlog::log(level, __VA_ARGS__); \
+        } \
+    } while (0)
+
+// like SPDLOG_DEBUG() and co, compiled out below SPDLOG_ACTIVE_LEVEL
+#if SPDLOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_TRACE
+#define S2T_TRACE_EVERY_MS(interval_ms, ...) S2T_LOG_EVERY_MS(spdlog::level::trace, interval_ms, __VA_ARGS__)
+#else
+#define S2T_TRACE_EVERY_MS(interval_ms, ...) (void) 0
+#endif
+
+#if SPDLOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_DEBUG
+#define S2T_DEBUG_EVERY_MS(interval_ms, ...) S2T_LOG_EVERY_MS(spdlog::level::debug, interval_ms, __VA_ARGS__)
+#else
+#define S2T_DEBUG_EVERY_MS(interval_ms, ...) (void) 0
+#endif
+
+#if SPDLOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_INFO
+#define S2T_INFO_EVERY_MS(interval_ms, ...) S2T_LOG_EVERY_MS(spdlog::level::info, interval_ms, __VA_ARGS__)
+#else
+#define S2T_INFO_EVERY_MS(interval_ms, ...) (void) 0
+#endif
+
+#if SPDLOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_WARN
+#define S2T_WARN_EVERY_MS(interval_ms, ...) S2T_LOG_EVERY_MS(spdlog::level::warn, interval_ms, __VA_ARGS__)
+#else
+#define S2T_WARN_EVERY_MS(interval_ms, ...) (void) 0
+#endif
+
+#endif //OBS_SPEECH2TEXT_PLUGIN_LOGGING_H
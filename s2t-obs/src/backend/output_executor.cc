@@ -0,0 +1,192 @@
+// Copyright 2022 gab
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "output_executor.h"
+
+#include <algorithm>
+
+#include "spdlog/spdlog.h"
+
+
+namespace backend {
+
+static const std::chrono::steady_clock::duration timer_wheel_tick = std::chrono::milliseconds(TIMER_WHEEL_TICK_MS);
+
+TimerWheel::TimerWheel() : started_at(std::chrono::steady_clock::now()) {}
+
+uint64_t TimerWheel::tick_of(const std::chrono::steady_clock::time_point &time_point) const {
+    if (time_point <= started_at)
+        return 0;
+
+    // rounded up, a timer never fires before it's due
+    return (time_point - started_at + timer_wheel_tick - std::chrono::steady_clock::duration(1)) / timer_wheel_tick;
+}
+
+std::chrono::steady_clock::time_point TimerWheel::time_of(uint64_t tick) const {
+    return started_at + tick * timer_wheel_tick;
+}
+
+OutputTimerId TimerWheel::add(const std::chrono::steady_clock::time_point &due_at, OutputTask task) {
+    const uint64_t tick = std::max(tick_of(due_at), current_tick);
+    const size_t slot = tick % TIMER_WHEEL_SLOTS;
+    const OutputTimerId id = next_id++;
+
+    slots[slot].push_back(Timer{id, due_at, std::move(task)});
+    timer_slots[id] = slot;
+    return id;
+}
+
+bool TimerWheel::cancel(OutputTimerId id) {
+    auto found = timer_slots.find(id);
+    if (found == timer_slots.end())
+        return false;
+
+    auto &slot = slots[found->second];
+    for (auto it = slot.begin(); it != slot.end(); ++it) {
+        if (it->id == id) {
+            slot.erase(it);
+            break;
+        }
+    }
+    timer_slots.erase(found);
+    return true;
+}
+
+void TimerWheel::advance(const std::chrono::steady_clock::time_point &now, std::vector<OutputTask> &due_tasks) {
+    if (now < time_of(current_tick))
+        return;
+
+    const uint64_t now_tick = (now - started_at) / timer_wheel_tick;
+    const uint64_t tick_count = std::min<uint64_t>(now_tick - current_tick + 1, TIMER_WHEEL_SLOTS);
+
+    for (uint64_t tick = current_tick; tick < current_tick + tick_count; tick++) {
+        auto &slot = slots[tick % TIMER_WHEEL_SLOTS];
+        for (size_t i = 0; i < slot.size();) {
+            // timers for a later rotation stay
+            if (slot[i].due_at > now) {
+                i++;
+                continue;
+            }
+
+            timer_slots.erase(slot[i].id);
+            due_tasks.push_back(std::move(slot[i].task));
+            slot[i] = std::move(slot.back());
+            slot.pop_back();
+        }
+    }
+    current_tick = now_tick + 1;
+}
+
+std::chrono::steady_clock::time_point TimerWheel::next_wakeup() const {
+    if (timer_slots.empty())
+        return std::chrono::steady_clock::time_point::max();
+
+    for (uint64_t tick = current_tick; tick < current_tick + TIMER_WHEEL_SLOTS; tick++) {
+        const std::chrono::steady_clock::time_point tick_at = time_of(tick);
+        for (const auto &timer: slots[tick % TIMER_WHEEL_SLOTS]) {
+            if (timer.due_at <= tick_at)
+                return tick_at;
+        }
+    }
+    return time_of(current_tick + TIMER_WHEEL_SLOTS);
+}
+
+OutputExecutor::OutputExecutor(const std::string &name) :
+        name(name),
+        thread("s2t " + name, WORKER_ROLE_FORMATTING, [this]() { run(); }) {}
+
+static void run_output_task(const std::string &name, OutputTask &task) {
+    try {
+        task();
+    }
+    catch (std::string &err) {
+        spdlog::error("OutputExecutor {} task error: {}", name, err);
+    }
+    catch (std::exception &ex) {
+        spdlog::error("OutputExecutor {} task error: {}", name, ex.what());
+    }
+}
+
+void OutputExecutor::run() {
+    spdlog::debug("OutputExecutor {} starting", name);
+    std::vector<OutputTask> tasks;
+
+    std::unique_lock<std::mutex> lock(tasks_mutex);
+    while (true) {
+        if (ready_tasks.empty()) {
+            // anything posted still runs on stop, timers don't
+            if (stopping)
+                break;
+
+            timers.advance(std::chrono::steady_clock::now(), tasks);
+            if (tasks.empty()) {
+                const auto wakeup = timers.next_wakeup();
+                if (wakeup == std::chrono::steady_clock::time_point::max())
+                    tasks_cv.wait(lock);
+                else
+                    tasks_cv.wait_until(lock, wakeup);
+                continue;
+            }
+        } else {
+            tasks.swap(ready_tasks);
+        }
+
+        lock.unlock();
+        for (auto &task: tasks)
+            run_output_task(name, task);
+        tasks.clear();
+        lock.lock();
+    }
+    spdlog::debug("OutputExecutor {} done", name);
+}
+
+void OutputExecutor::post(OutputTask task) {
+    {
+        std::lock_guard<std::mutex> lock(tasks_mutex);
+        ready_tasks.push_back(std::move(task));
+    }
+    tasks_cv.notify_one();
+}
+
+OutputTimerId OutputExecutor::schedule_at(const std::chrono::steady_clock::time_point &due_at, OutputTask task) {
+    OutputTimerId id;
+    {
+        std::lock_guard<std::mutex> lock(tasks_mutex);
+        id = timers.add(due_at, std::move(task));
+    }
+    tasks_cv.notify_one();
+    return id;
+}
+
+bool OutputExecutor::cancel(OutputTimerId id) {
+    std::lock_guard<std::mutex> lock(tasks_mutex);
+    return timers.cancel(id);
+}
+
+void OutputExecutor::stop() {
+    {
+        std::lock_guard<std::mutex> lock(tasks_mutex);
+        stopping = true;
+    }
+    tasks_cv.notify_one();
+
+    if (thread.joinable() && thread.get_id() != std::this_thread::get_id())
+        thread.join();
+}
+
+OutputExecutor::~OutputExecutor() {
+    stop();
+}
+
+}
@@ -0,0 +1,114 @@
+// Copyright 2022 gab
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef OBS_SPEECH2TEXT_PLUGIN_OUTPUT_EXECUTOR_H
+#define OBS_SPEECH2TEXT_PLUGIN_OUTPUT_EXECUTOR_H
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "worker_runtime.h"
+
+namespace backend {
+
+#define TIMER_WHEEL_SLOTS 512
+#define TIMER_WHEEL_TICK_MS 10
+
+typedef std::function<void()> OutputTask;
+typedef uint64_t OutputTimerId;
+
+/*
+ Hashed timer wheel, TIMER_WHEEL_TICK_MS per slot. Timers further out than one rotation stay in their slot
+ and are skipped until the rotation they're due in. Not thread safe, OutputExecutor locks around it.
+*/
+class TimerWheel {
+    struct Timer {
+        OutputTimerId id;
+        std::chrono::steady_clock::time_point due_at;
+        OutputTask task;
+    };
+
+    std::array<std::vector<Timer>, TIMER_WHEEL_SLOTS> slots;
+    std::unordered_map<OutputTimerId, size_t> timer_slots;
+    std::chrono::steady_clock::time_point started_at;
+    uint64_t current_tick = 0;  // every tick before this one was already handled
+    OutputTimerId next_id = 1;
+
+    uint64_t tick_of(const std::chrono::steady_clock::time_point &time_point) const;
+
+    std::chrono::steady_clock::time_point time_of(uint64_t tick) const;
+
+public:
+    TimerWheel();
+
+    OutputTimerId add(const std::chrono::steady_clock::time_point &due_at, OutputTask task);
+
+    bool cancel(OutputTimerId id);
+
+    // moves the tasks of all timers due by now into due_tasks
+    void advance(const std::chrono::steady_clock::time_point &now, std::vector<OutputTask> &due_tasks);
+
+    // when advance() has to be called next, time_point::max() without timers.
+    // At most one rotation ahead, timers further out might cause one extra wakeup per rotation.
+    std::chrono::steady_clock::time_point next_wakeup() const;
+
+    bool empty() const {
+        return timer_slots.empty();
+    }
+};
+
+/*
+ Single thread running the caption output writers of a SourceCaptioner: enqueued captions, output delays and
+ the caption timeout clearance all run as tasks on it, so the thread count doesn't grow with the number of outputs
+ and it only wakes up when there's something to do.
+*/
+class OutputExecutor {
+    std::string name;
+
+    std::mutex tasks_mutex;
+    std::condition_variable tasks_cv;
+    std::vector<OutputTask> ready_tasks;
+    TimerWheel timers;
+    bool stopping = false;
+
+    WorkerThread thread;
+
+    void run();
+
+public:
+    explicit OutputExecutor(const std::string &name);
+
+    // runs task on the executor thread, in posting order
+    void post(OutputTask task);
+
+    OutputTimerId schedule_at(const std::chrono::steady_clock::time_point &due_at, OutputTask task);
+
+    // false if it already ran or was cancelled before
+    bool cancel(OutputTimerId id);
+
+    // runs the tasks already posted, drops pending timers and joins the thread
+    void stop();
+
+    ~OutputExecutor();
+};
+
+}
+
+#endif //OBS_SPEECH2TEXT_PLUGIN_OUTPUT_EXECUTOR_H
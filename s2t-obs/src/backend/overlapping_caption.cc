@@ -19,62 +19,110 @@
 #include "spdlog/spdlog.h"
 
 #include "overlapping_caption.h"
+#include "trace.h"
 
 namespace backend {
 
-OverlappingCaption::OverlappingCaption(OverlappingCaptionStreamSettings settings) : current_stream(nullptr), prepared_stream(nullptr), settings(settings) {}
+static overlapping_caption_audio_sink audio_sink_for(const std::shared_ptr<InferenceStream> &current,
+                                                     const std::shared_ptr<InferenceStream> &prepared) {
+    if (!current)
+        return nullptr;
+
+    // one sink for both so a switchover is a single swap, no chunk goes missing or to the same stream twice
+    return [current, prepared](const char *data, const uint data_size, bool &queued) {
+        if (prepared)
+            prepared->queue_audio_data(data, data_size);
+
+        queued = current->queue_audio_data(data, data_size);
+    };
+}
+
+static int64_t steady_ns(const std::chrono::steady_clock::time_point &at) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(at.time_since_epoch()).count();
+}
+
+OverlappingCaption::OverlappingCaption(OverlappingCaptionStreamSettings settings) :
+        settings(settings),
+        result_pool(ResultPool::create()),
+        current_stream(nullptr),
+        prepared_stream(nullptr),
+        supervisor_thread("s2t supervisor", WORKER_ROLE_NETWORK, [this]() { supervise(); }) {}
 
 bool OverlappingCaption::queue_audio_data(const char *data, const uint data_size) {
     if (!data_size)
         return false;
 
-    if (!current_stream) {
-        spdlog::debug("first time, no current stream cycling");
-        cycle_streams();
+    last_audio_at_ns.store(steady_ns(std::chrono::steady_clock::now()), std::memory_order_relaxed);
+
+    bool queued = false;
+    if (!audio_sink.invoke(data, data_size, queued))
+        return false;
+
+    return queued;
+}
+
+void OverlappingCaption::supervise() {
+    spdlog::debug("OverlappingCaption supervisor starting");
+
+    std::unique_lock<std::mutex> lock(supervisor_mutex);
+    while (!stopping) {
+        lock.unlock();
+        check_streams(std::chrono::steady_clock::now());
+        lock.lock();
+
+        supervisor_cv.wait_for(lock, std::chrono::milliseconds(OVERLAPPING_CAPTION_SUPERVISOR_TICK_MS),
+                               [this]() { return stopping; });
     }
 
+    spdlog::debug("OverlappingCaption supervisor stopped");
+}
+
+void OverlappingCaption::check_streams(const std::chrono::steady_clock::time_point &now) {
+    const bool audio_since_last_check = last_audio_at_ns.load(std::memory_order_relaxed) > steady_ns(last_check_at);
+    last_check_at = now;
+
     if (!current_stream) {
-        spdlog::error("Error: no upstream !");
-        return false;
+        spdlog::debug("first time, no current stream cycling");
+        cycle_streams();
+        return;
     }
 
     double secs_since_start = std::chrono::duration_cast<std::chrono::duration<double>>(
-        std::chrono::steady_clock::now() - current_started_at
+        now - current_started_at
     ).count();
 
     if (current_stream->is_stopped()) {
+        // nothing to caption, connect again once there's audio
+        if (!audio_since_last_check)
+            return;
+
         if (settings.minimum_reconnect_interval_secs_ && secs_since_start < settings.minimum_reconnect_interval_secs_) {
             // current stream dead, not reconnecting yet, too soon
-            return false;
+            return;
         }
-        spdlog::debug("current stream dead, cycling, %f", secs_since_start);
+        spdlog::debug("current stream dead, cycling, {}", secs_since_start);
         cycle_streams();
+        return;
     }
 
-    if (settings.switchover_second_after_secs_ && secs_since_start < settings.minimum_reconnect_interval_secs_) {
+    if (settings.switchover_second_after_secs_ && secs_since_start > settings.switchover_second_after_secs_) {
         if (prepared_stream) {
             if (prepared_stream->is_stopped()) {
-                spdlog::debug("trying to swittch to prepared stream but dead, recreating");
-                clear_prepared();
+                spdlog::debug("trying to switch to prepared stream but dead, recreating");
                 start_prepared();
             } else {
-                spdlog::debug("switching over to prepared stream, %f > %u", secs_since_start, settings.switchover_second_after_secs_);
+                spdlog::debug("switching over to prepared stream, {} > {}", secs_since_start, settings.switchover_second_after_secs_);
                 cycle_streams();
             }
         }
     } else if (settings.connect_second_after_secs_ && secs_since_start > settings.connect_second_after_secs_) {
         if (!prepared_stream || prepared_stream->is_stopped()) {
-            spdlog::debug("starting second stream %f", secs_since_start);
+            spdlog::debug("starting second stream {}", secs_since_start);
             start_prepared();
-        } else {
-            prepared_stream->queue_audio_data(data, data_size);
         }
     }
-
-    return current_stream->queue_audio_data(data, data_size);
 }
 
-
 void OverlappingCaption::start_prepared() {
     spdlog::debug("starting second prepared connection");
     clear_prepared();
@@ -84,6 +132,7 @@ void OverlappingCaption::start_prepared() {
     }
 
     prepared_started_at = std::chrono::steady_clock::now();
+    audio_sink.set(audio_sink_for(current_stream, prepared_stream));
 }
 
 void OverlappingCaption::clear_prepared() {
@@ -91,11 +140,13 @@ void OverlappingCaption::clear_prepared() {
         return;
 
     spdlog::debug("clearing prepared connection");
+    audio_sink.set(audio_sink_for(current_stream, nullptr));
     prepared_stream->stop();
     prepared_stream = nullptr;
 }
 
 void OverlappingCaption::cycle_streams() {
+    S2T_TRACE_SPAN("OverlappingCaption::cycle_streams");
     spdlog::debug("cycling streams");
 
     if (current_stream) {
@@ -108,17 +159,16 @@ void OverlappingCaption::cycle_streams() {
         prepared_stream = nullptr;
     }
 
-    if (last_caption_result && !last_caption_result->final) {
-        spdlog::debug("stream interrupted, last result was not final, sending copy of last with fixed final=true");
-        last_caption_result->final = true;
-        {
-            std::lock_guard<std::recursive_mutex> lock(on_caption_cb_handle.mutex);
-            if (on_caption_cb_handle.callback_fn) {
-                on_caption_cb_handle.callback_fn(*last_caption_result, true);
-            }
+    {
+        std::lock_guard<std::mutex> lock(last_caption_result_mutex);
+        if (last_caption_result && !last_caption_result->final) {
+            spdlog::debug("stream interrupted, last result was not final, sending copy of last with fixed final=true");
+            RawResult final_result = *last_caption_result;
+            final_result.final = true;
+            on_caption_cb_handle.invoke(result_pool->make(std::move(final_result)), true);
         }
+        last_caption_result = nullptr;
     }
-    last_caption_result = nullptr;
 
     caption_text_callback cb = std::bind(&OverlappingCaption::on_caption_text_cb, this, std::placeholders::_1);
 
@@ -136,32 +186,43 @@ void OverlappingCaption::cycle_streams() {
         current_started_at = std::chrono::steady_clock::now();
     }
     prepared_stream = nullptr;
+
+    audio_sink.set(audio_sink_for(current_stream, nullptr));
 }
 
-void OverlappingCaption::on_caption_text_cb(const RawResult &caption_result) {
+void OverlappingCaption::on_caption_text_cb(RawResult &caption_result) {
     // got caption data
     {
-        std::lock_guard<std::recursive_mutex> lock(on_caption_cb_handle.mutex);
-        
-        last_caption_result = std::make_unique<RawResult>();
-        *last_caption_result = caption_result;
+        std::lock_guard<std::mutex> lock(last_caption_result_mutex);
 
-        if (on_caption_cb_handle.callback_fn) {
-            on_caption_cb_handle.callback_fn(caption_result, false);
-        }
+        last_caption_result = result_pool->make(std::move(caption_result));
+        on_caption_cb_handle.invoke(last_caption_result, false);
     }
 }
 
+ResultPoolStats OverlappingCaption::result_pool_stats() const {
+    return result_pool->stats();
+}
+
 OverlappingCaption::~OverlappingCaption() {
     spdlog::debug("~OverlappingCaption");
+    {
+        std::lock_guard<std::mutex> lock(supervisor_mutex);
+        stopping = true;
+    }
+    supervisor_cv.notify_one();
+    supervisor_thread.join();
+
+    audio_sink.clear();
     on_caption_cb_handle.clear();
 
     if (current_stream) {
+        current_stream->on_caption_cb_handle.clear();
         current_stream->stop();
     }
 
     if (prepared_stream) {
-        prepared_stream->sstop();
+        prepared_stream->stop();
     }
 }
 
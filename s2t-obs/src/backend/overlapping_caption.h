@@ -15,10 +15,17 @@
 #ifndef OBS_SPEECH2TEXT_OVERLAPPING_CAPTION_H
 #define OBS_SPEECH2TEXT_OVERLAPPING_CAPTION_H
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <functional>
+#include <memory>
+#include <mutex>
 
 #include "inference_stream.h"
+#include "result_pool.h"
 #include "threadsafe_cb.h"
+#include "worker_runtime.h"
 
 namespace backend {
 
@@ -60,7 +67,12 @@ struct OverlappingCaptionStreamSettings {
     }
 };
 
-typedef std::function<void(const RawResult &raw_caption_result, bool interrupted)> overlapping_caption_text_callback;
+typedef std::function<void(const RawResultPtr &caption_result, bool interrupted)> overlapping_caption_text_callback;
+
+// pushes one audio chunk into the streams, queued: whether the current stream took it
+typedef std::function<void(const char *data, const uint data_size, bool &queued)> overlapping_caption_audio_sink;
+
+#define OVERLAPPING_CAPTION_SUPERVISOR_TICK_MS 50
 
 /*
  Provides a continuous stream of caption messages for audio data, abstracting issues like reconnects after
@@ -68,6 +80,10 @@ typedef std::function<void(const RawResult &raw_caption_result, bool interrupted
 
  Minimizes impact of these regular disconnects by starting a second connection shortly before the first once
  is about to hit the limit and feeds both with the same audio for a bit before switching to the new one to avoid captioning gap.
+
+ Connecting, switching over and reconnecting happens on a supervisor thread checking the streams every
+ OVERLAPPING_CAPTION_SUPERVISOR_TICK_MS, it publishes the current and prepared stream together as the audio sink.
+ queue_audio_data() only pushes into those, it never blocks or creates streams on the audio thread.
 */
 class OverlappingCaption {
 public:
@@ -75,19 +91,43 @@ public:
     
     OverlappingCaption(OverlappingCaptionStreamSettings settings);
     bool queue_audio_data(const char *data, const uint data_size);
+    ResultPoolStats result_pool_stats() const;
     ~OverlappingCaption();
 
 private:
+    OverlappingCaptionStreamSettings settings;
+
+    // every result of the streams is made here once and only passed on by pointer after
+    std::shared_ptr<ResultPool> result_pool;
+
+    // current and prepared stream as published by the supervisor, called by queue_audio_data()
+    ThreadsafeCb<overlapping_caption_audio_sink> audio_sink;
+
+    // steady_clock nanoseconds of the last audio chunk, 0 before the first one
+    std::atomic<int64_t> last_audio_at_ns{0};
+
+    // only used on the supervisor thread
     std::shared_ptr<InferenceStream> current_stream;
     std::shared_ptr<InferenceStream> prepared_stream;
 
     std::chrono::steady_clock::time_point current_started_at;
     std::chrono::steady_clock::time_point prepared_started_at;
+    std::chrono::steady_clock::time_point last_check_at;
 
-    OverlappingCaptionStreamSettings settings;
-    std::unique_ptr<RawResult> last_caption_result;
+    std::mutex supervisor_mutex;
+    std::condition_variable supervisor_cv;
+    bool stopping = false;
+
+    // written by the streams' result threads, read when cycling streams
+    std::mutex last_caption_result_mutex;
+    RawResultPtr last_caption_result;
+
+    // starts running supervise() in the init list, so it has to come after everything it touches
+    WorkerThread supervisor_thread;
 
-    void on_caption_text_cb(const RawResult &caption_result);
+    void on_caption_text_cb(RawResult &caption_result);
+    void supervise();
+    void check_streams(const std::chrono::steady_clock::time_point &now);
     void start_prepared();
     void clear_prepared();
     void cycle_streams();
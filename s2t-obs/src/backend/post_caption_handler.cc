@@ -20,6 +20,8 @@
 #include <vector>
 #include <utils.h>
 
+#include "logging.h"
+#include "trace.h"
 #include "utils/strings.h"
 
 namespace backend {
@@ -27,7 +29,7 @@ namespace backend {
 PostCaptionHandler::PostCaptionHandler(CaptionFormatSettings settings) : settings(settings) {}
 
 std::shared_ptr<OutputCaptionResult> PostCaptionHandler::prepare_caption_output(
-    const RawResult &caption_result,
+    const RawResultPtr &caption_result_ptr,
     const bool fillup_with_previous,
     const bool insert_newlines,
     const bool punctuation,
@@ -35,9 +37,11 @@ std::shared_ptr<OutputCaptionResult> PostCaptionHandler::prepare_caption_output(
     const uint targeted_line_count,
     const CapitalizationType capitalization,
     const bool interrupted,
-    const std::vector<std::shared_ptr<OutputCaptionResult>> &result_history
+    const CaptionHistory &result_history
 ) {
-    std::shared_ptr<OutputCaptionResult> output_result = std::make_shared<OutputCaptionResult>(caption_result, interrupted);
+    S2T_TRACE_SPAN("PostCaptionHandler::prepare_caption_output");
+    std::shared_ptr<OutputCaptionResult> output_result = std::make_shared<OutputCaptionResult>(caption_result_ptr, interrupted);
+    const RawResult &caption_result = *caption_result_ptr;
 
     try {
         const uint max_length = targeted_line_count * line_length;
@@ -48,15 +52,15 @@ std::shared_ptr<OutputCaptionResult> PostCaptionHandler::prepare_caption_output(
                 std::string tmp = settings.replacer.get_replacer().replace(caption_result.caption_text);
 
                 if (caption_result.caption_text != tmp) {
-                    spdlog::info("modified string '%s' -> '%s'", caption_result.caption_text.c_str(), tmp.c_str());
+                    SPDLOG_DEBUG("modified string '{}' -> '{}'", caption_result.caption_text, tmp);
                     cleaned_line = tmp;
                 }
             }
             catch (exception ex) {
-                spdlog::error("string replacement error %s: '%s'", ex.what(), caption_result.caption_text.c_str());
+                S2T_LOG_EVERY_MS(spdlog::level::err, 1000, "string replacement error {}: '{}'", ex.what(), caption_result.caption_text);
             }
             catch (...) {
-                spdlog::error("string replacement error '%s'", caption_result.caption_text.c_str());
+                S2T_LOG_EVERY_MS(spdlog::level::err, 1000, "string replacement error '{}'", caption_result.caption_text);
             }
         }
         utils::lstrip(cleaned_line);
@@ -70,17 +74,12 @@ std::shared_ptr<OutputCaptionResult> PostCaptionHandler::prepare_caption_output(
                 filled_line[0] = toupper(filled_line[0]);
 
             if (filled_line.size() < max_length && !result_history.empty()) {
-                for (auto i = result_history.rbegin(); i != result_history.rend(); ++i) {
-                    if (!*i)
-                        break;
-
-                    if (!(*i)->caption_result.final)
-                        // had interruption here, ignore
-                        break;
+                for (size_t i = 0; i < result_history.size(); i++) {
+                    const CaptionHistoryEntry &entry = result_history.from_newest(i);
 
                     if (settings.caption_timeout_enabled) {
                         double secs_since_last = std::chrono::duration_cast<std::chrono::duration<double >>
-                                (std::chrono::steady_clock::now() - (*i)->caption_result.received_at).count();
+                                (std::chrono::steady_clock::now() - entry.received_at).count();
 
                         if (secs_since_last > settings.caption_timeout_seconds)
                             break;
@@ -91,7 +90,7 @@ std::shared_ptr<OutputCaptionResult> PostCaptionHandler::prepare_caption_output(
                     else
                         filled_line.insert(0, 1, ' ');
 
-                    filled_line.insert(0, (*i)->clean_caption_text);
+                    filled_line.insert(0, entry.clean_caption_text);
 
                     if (punctuation && capitalization == CAPITALIZATION_NORMAL && !filled_line.empty() && isascii(filled_line[0]))
                         filled_line[0] = toupper(filled_line[0]);
@@ -118,10 +117,10 @@ std::shared_ptr<OutputCaptionResult> PostCaptionHandler::prepare_caption_output(
         return output_result;
 
     } catch (std::string &ex) {
-        spdlog::info("couldn't parse caption message. Error: '%s'. Messsage: '%s'", ex.c_str(), caption_result.caption_text.c_str());
+        S2T_INFO_EVERY_MS(1000, "couldn't parse caption message. Error: '{}'. Messsage: '{}'", ex, caption_result.caption_text);
         return nullptr;
     } catch (...) {
-        spdlog::info("couldn't parse caption message. Messsage: '%s'", caption_result.caption_text.c_str());
+        S2T_INFO_EVERY_MS(1000, "couldn't parse caption message. Messsage: '{}'", caption_result.caption_text);
         return nullptr;
     }
 }
@@ -19,6 +19,8 @@
 #include <string>
 
 #include "inference_stream.h"
+#include "caption_history.h"
+#include "result_pool.h"
 #include "utils/word.h"
 
 namespace backend {
@@ -88,6 +90,9 @@ struct CaptionFormatSettings {
     double caption_timeout_seconds;
     DefaultReplacer replacer;
 
+    uint interim_updates_per_second;    // 0: every interim result
+    double interim_min_stability;
+
     CaptionFormatSettings(
             uint caption_line_length,
             uint caption_line_count,
@@ -96,7 +101,9 @@ struct CaptionFormatSettings {
             bool caption_insert_punctuation,
             const DefaultReplacer &replacer,
             bool caption_timeout_enabled,
-            double caption_timeout_seconds
+            double caption_timeout_seconds,
+            uint interim_updates_per_second,
+            double interim_min_stability
     ) :
             caption_line_length(caption_line_length),
             caption_line_count(caption_line_count),
@@ -105,7 +112,9 @@ struct CaptionFormatSettings {
             caption_insert_punctuation(caption_insert_punctuation),
             replacer(replacer),
             caption_timeout_enabled(caption_timeout_enabled),
-            caption_timeout_seconds(caption_timeout_seconds) {}
+            caption_timeout_seconds(caption_timeout_seconds),
+            interim_updates_per_second(interim_updates_per_second),
+            interim_min_stability(interim_min_stability) {}
 
     void print(const char *line_prefix = "") {
         printf("%sCaptionFormatSettings\n", line_prefix);
@@ -114,6 +123,8 @@ struct CaptionFormatSettings {
         printf("%s  capitalization: %d\n", line_prefix, capitalization);
         printf("%s  caption_insert_newlines: %d\n", line_prefix, caption_insert_newlines);
         printf("%s  caption_insert_punctuation: %d\n", line_prefix, caption_insert_punctuation);
+        printf("%s  interim_updates_per_second: %d\n", line_prefix, interim_updates_per_second);
+        printf("%s  interim_min_stability: %f\n", line_prefix, interim_min_stability);
         printf("%s  user_replacements: %lu\n", line_prefix, replacer.user_replacements().size());
         for (auto &word : replacer.user_replacements())
             printf(
@@ -130,7 +141,9 @@ struct CaptionFormatSettings {
             caption_insert_punctuation == rhs.caption_insert_punctuation &&
             replacer == rhs.replacer &&
             caption_timeout_enabled == rhs.caption_timeout_enabled &&
-            caption_timeout_seconds == rhs.caption_timeout_seconds;
+            caption_timeout_seconds == rhs.caption_timeout_seconds &&
+            interim_updates_per_second == rhs.interim_updates_per_second &&
+            interim_min_stability == rhs.interim_min_stability;
     }
 
     bool operator!=(const CaptionFormatSettings &rhs) const {
@@ -139,7 +152,9 @@ struct CaptionFormatSettings {
 };
 
 struct OutputCaptionResult {
-    RawResult caption_result;
+    // shared with every other output made from the same result, never copied
+    RawResultPtr result_ptr;
+    const RawResult &caption_result;
     bool interrupted;
     std::string clean_caption_text;
 
@@ -147,9 +162,12 @@ struct OutputCaptionResult {
     std::string output_line; // joined output_lines
 
     explicit OutputCaptionResult(
-        const RawResult &caption_result,
+        RawResultPtr caption_result,
         const bool interrupted
-    ) : caption_result(caption_result), interrupted(interrupted) {}
+    ) : result_ptr(std::move(caption_result)), caption_result(*result_ptr), interrupted(interrupted) {}
+
+    OutputCaptionResult(const OutputCaptionResult &) = delete;
+    OutputCaptionResult &operator=(const OutputCaptionResult &) = delete;
 };
 
 class PostCaptionHandler {
@@ -157,7 +175,7 @@ public:
     explicit PostCaptionHandler(CaptionFormatSettings settings);
 
     std::shared_ptr<OutputCaptionResult> prepare_caption_output(
-        const RawResult &caption_result,
+        const RawResultPtr &caption_result,
         const bool fillup_with_previous,
         const bool insert_newlines,
         const bool punctuation,
@@ -165,7 +183,7 @@ public:
         const uint targeted_line_count,
         const CapitalizationType capitalization,
         const bool interrupted,
-        const std::vector<std::shared_ptr<OutputCaptionResult>> &result_history);
+        const CaptionHistory &result_history);
 private:
     CaptionFormatSettings settings;
 };
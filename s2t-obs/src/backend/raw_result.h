@@ -17,6 +17,7 @@
 
 #include <string>
 #include <chrono>
+#include <utility>
 
 namespace backend {
 
@@ -43,8 +44,8 @@ struct RawResult {
         index(index),
         final(final),
         stability(stability),
-        caption_text(caption_text),
-        raw_message(raw_message),
+        caption_text(std::move(caption_text)),
+        raw_message(std::move(raw_message)),
         first_received_at(first_received_at),
         received_at(received_at) {
     }
@@ -0,0 +1,153 @@
+// Copyright 2022 gab
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef OBS_SPEECH2TEXT_PLUGIN_RESULT_POOL_H
+#define OBS_SPEECH2TEXT_PLUGIN_RESULT_POOL_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "raw_result.h"
+
+namespace backend {
+
+// most results in flight at once, freed blocks beyond this go back to the heap
+#define RESULT_POOL_MAX_FREE_BLOCKS 256
+
+typedef std::shared_ptr<const RawResult> RawResultPtr;
+
+struct ResultPoolStats {
+    uint64_t results = 0;
+    uint64_t heap_allocations = 0;  // blocks that didn't come from the free list
+};
+
+/*
+ Memory for the caption results of one captioning session. A result is made once, immutable afterwards and passed
+ around as RawResultPtr, its refcount lives in the same block. Freed blocks are kept for the next result, so
+ once warmed up a result costs no heap allocation, only its texts do, which are moved in and never copied.
+
+ Every result keeps the pool alive, they can outlive the session that made them.
+*/
+class ResultPool : public std::enable_shared_from_this<ResultPool> {
+    template<typename T>
+    friend class ResultPoolAllocator;
+
+    std::mutex free_blocks_mutex;
+    std::vector<void *> free_blocks;
+    size_t block_size = 0;  // allocate_shared only ever asks for one size
+
+    std::atomic<uint64_t> results{0};
+    std::atomic<uint64_t> heap_allocations{0};
+
+    ResultPool() {
+        free_blocks.reserve(RESULT_POOL_MAX_FREE_BLOCKS);
+    }
+
+    void *allocate(size_t bytes) {
+        {
+            std::lock_guard<std::mutex> lock(free_blocks_mutex);
+            if (!block_size)
+                block_size = bytes;
+
+            if (bytes == block_size && !free_blocks.empty()) {
+                void *block = free_blocks.back();
+                free_blocks.pop_back();
+                return block;
+            }
+        }
+
+        heap_allocations.fetch_add(1, std::memory_order_relaxed);
+        return ::operator new(bytes);
+    }
+
+    void deallocate(void *block, size_t bytes) {
+        {
+            std::lock_guard<std::mutex> lock(free_blocks_mutex);
+            if (bytes == block_size && free_blocks.size() < RESULT_POOL_MAX_FREE_BLOCKS) {
+                free_blocks.push_back(block);
+                return;
+            }
+        }
+
+        ::operator delete(block);
+    }
+
+public:
+    static std::shared_ptr<ResultPool> create() {
+        return std::shared_ptr<ResultPool>(new ResultPool());
+    }
+
+    RawResultPtr make(RawResult &&result);
+
+    ResultPoolStats stats() const {
+        ResultPoolStats stats;
+        stats.results = results.load(std::memory_order_relaxed);
+        stats.heap_allocations = heap_allocations.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    ~ResultPool() {
+        for (void *block: free_blocks)
+            ::operator delete(block);
+    }
+};
+
+template<typename T>
+class ResultPoolAllocator {
+    template<typename U>
+    friend class ResultPoolAllocator;
+
+    std::shared_ptr<ResultPool> pool;
+
+public:
+    typedef T value_type;
+
+    explicit ResultPoolAllocator(std::shared_ptr<ResultPool> pool) : pool(std::move(pool)) {}
+
+    template<typename U>
+    ResultPoolAllocator(const ResultPoolAllocator<U> &other) : pool(other.pool) {}
+
+    T *allocate(size_t n) {
+        return static_cast<T *>(pool->allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T *p, size_t n) {
+        pool->deallocate(p, n * sizeof(T));
+    }
+
+    template<typename U>
+    bool operator==(const ResultPoolAllocator<U> &rhs) const {
+        return pool == rhs.pool;
+    }
+
+    template<typename U>
+    bool operator!=(const ResultPoolAllocator<U> &rhs) const {
+        return pool != rhs.pool;
+    }
+};
+
+inline RawResultPtr ResultPool::make(RawResult &&result) {
+    results.fetch_add(1, std::memory_order_relaxed);
+    return std::allocate_shared<const RawResult>(ResultPoolAllocator<RawResult>(shared_from_this()), std::move(result));
+}
+
+}
+
+#endif //OBS_SPEECH2TEXT_PLUGIN_RESULT_POOL_H
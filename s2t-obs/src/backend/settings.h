@@ -17,12 +17,16 @@
 
 
 #include "caption.h"
+#include "shutdown.h"
+#include "worker_runtime.h"
 
 namespace backend {
 
 struct PluginSettings {
     bool enabled;
     SourceCaptionerSettings source_cap_settings;
+    WorkerRuntimeSettings worker_settings = default_WorkerRuntimeSettings();
+    uint shutdown_budget_ms = PLUGIN_SHUTDOWN_BUDGET_MS;
 
     PluginSettings(bool enabled, const SourceCaptionerSettings &source_cap_settings) :
             enabled(enabled),
@@ -30,7 +34,9 @@ struct PluginSettings {
 
     bool operator==(const PluginSettings &rhs) const {
         return enabled == rhs.enabled &&
-               source_cap_settings == rhs.source_cap_settings;
+               source_cap_settings == rhs.source_cap_settings &&
+               worker_settings == rhs.worker_settings &&
+               shutdown_budget_ms == rhs.shutdown_budget_ms;
     }
 
     bool operator!=(const PluginSettings &rhs) const {
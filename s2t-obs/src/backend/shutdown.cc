@@ -0,0 +1,92 @@
+// Copyright 2022 gab
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "shutdown.h"
+
+#include <atomic>
+#include <cstdint>
+
+#include "spdlog/spdlog.h"
+
+namespace backend {
+
+static const int64_t NOT_SHUTTING_DOWN = INT64_MAX;
+
+// steady_clock nanoseconds, NOT_SHUTTING_DOWN until begin()
+static std::atomic<int64_t> shutdown_started_at_ns{NOT_SHUTTING_DOWN};
+static std::atomic<int64_t> shutdown_deadline_ns{NOT_SHUTTING_DOWN};
+
+static int64_t steady_ns(const std::chrono::steady_clock::time_point &at) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(at.time_since_epoch()).count();
+}
+
+static int64_t ms_since(int64_t since_ns) {
+    return (steady_ns(std::chrono::steady_clock::now()) - since_ns) / 1000000;
+}
+
+void PluginShutdown::begin(std::chrono::milliseconds budget) {
+    const auto now = std::chrono::steady_clock::now();
+    int64_t not_started = NOT_SHUTTING_DOWN;
+    if (!shutdown_started_at_ns.compare_exchange_strong(not_started, steady_ns(now)))
+        return;
+
+    shutdown_deadline_ns.store(steady_ns(now + budget));
+    spdlog::info("shutdown: starting, budget {} ms", budget.count());
+}
+
+bool PluginShutdown::in_progress() {
+    return shutdown_started_at_ns.load() != NOT_SHUTTING_DOWN;
+}
+
+std::chrono::steady_clock::time_point PluginShutdown::deadline() {
+    const int64_t deadline_ns = shutdown_deadline_ns.load();
+    if (deadline_ns == NOT_SHUTTING_DOWN)
+        return std::chrono::steady_clock::time_point::max();
+
+    return std::chrono::steady_clock::time_point(
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::nanoseconds(deadline_ns)));
+}
+
+bool PluginShutdown::past_deadline() {
+    return steady_ns(std::chrono::steady_clock::now()) >= shutdown_deadline_ns.load();
+}
+
+void PluginShutdown::finish() {
+    const int64_t started_at_ns = shutdown_started_at_ns.load();
+    if (started_at_ns == NOT_SHUTTING_DOWN)
+        return;
+
+    const int64_t budget_ms = (shutdown_deadline_ns.load() - started_at_ns) / 1000000;
+    const int64_t took_ms = ms_since(started_at_ns);
+    if (took_ms > budget_ms)
+        spdlog::warn("shutdown: took {} ms, over the budget of {} ms", took_ms, budget_ms);
+    else
+        spdlog::info("shutdown: took {} ms of {} ms", took_ms, budget_ms);
+}
+
+ShutdownTimer::ShutdownTimer(const std::string &component) :
+        component(component),
+        started_at(std::chrono::steady_clock::now()) {}
+
+ShutdownTimer::~ShutdownTimer() {
+    const int64_t took_ms = ms_since(steady_ns(started_at));
+    if (!PluginShutdown::in_progress())
+        spdlog::debug("stopping {} took {} ms", component, took_ms);
+    else if (PluginShutdown::past_deadline())
+        spdlog::warn("shutdown: {} took {} ms, past the deadline", component, took_ms);
+    else
+        spdlog::info("shutdown: {} took {} ms", component, took_ms);
+}
+
+}
@@ -0,0 +1,67 @@
+// Copyright 2022 gab
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef OBS_SPEECH2TEXT_PLUGIN_SHUTDOWN_H
+#define OBS_SPEECH2TEXT_PLUGIN_SHUTDOWN_H
+
+#include <chrono>
+#include <string>
+
+namespace backend {
+
+typedef unsigned int uint;
+
+#define PLUGIN_SHUTDOWN_BUDGET_MS 3000
+
+/*
+ Shutdown of the whole plugin when OBS exits, begun once with a time budget. Work still finishing in the
+ background checks the deadline and gives up on what can be redone later, like compressing closed transcript
+ segments or writing queued results a transcript WAL has journaled, instead of holding up OBS.
+
+ The budget is best effort, not a hard limit: whatever can't be redone still runs past the deadline, the joins
+ on shutdown wait for it. A transcript without a working WAL still gets written and finished, and a stalled disk
+ holds up OBS's exit like it did before.
+*/
+class PluginShutdown {
+public:
+    static void begin(std::chrono::milliseconds budget);
+
+    static bool in_progress();
+
+    // time_point::max() while not shutting down
+    static std::chrono::steady_clock::time_point deadline();
+
+    static bool past_deadline();
+
+    // logs the total time against the budget
+    static void finish();
+};
+
+// logs how long one component took to shut down once it goes out of scope
+class ShutdownTimer {
+    const std::string component;
+    const std::chrono::steady_clock::time_point started_at;
+
+public:
+    explicit ShutdownTimer(const std::string &component);
+
+    ShutdownTimer(const ShutdownTimer &) = delete;
+    ShutdownTimer &operator=(const ShutdownTimer &) = delete;
+
+    ~ShutdownTimer();
+};
+
+}
+
+#endif //OBS_SPEECH2TEXT_PLUGIN_SHUTDOWN_H
@@ -0,0 +1,307 @@
+// Copyright 2022 gab
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef OBS_SPEECH2TEXT_PLUGIN_SUBTITLE_CUE_BUILDER_H
+#define OBS_SPEECH2TEXT_PLUGIN_SUBTITLE_CUE_BUILDER_H
+
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "post_caption_handler.h"
+#include "transcript_sink.h"
+#include "utils/strings.h"
+
+namespace backend {
+
+const std::string NEWLINE_STR = "\r\n";
+
+using MonoTP = std::chrono::steady_clock::time_point;
+using MonoDur = std::chrono::steady_clock::duration;
+
+static void append_zero_padded(std::string &out, uint64_t value, size_t width) {
+    char digits[24];
+    const auto res = std::to_chars(digits, digits + sizeof(digits), value);
+    const size_t len = res.ptr - digits;
+    if (len < width)
+        out.append(width - len, '0');
+    out.append(digits, len);
+}
+
+// "HH:MM:SS,mmm", WebVTT wants a '.' before the milliseconds. false for negative durations
+static bool append_time_duration(std::string &out, int milliseconds, char milliseconds_separator = ',') {
+    if (milliseconds < 0)
+        return false;
+
+    const uint hours = milliseconds / 3600000;
+    milliseconds -= 3600000 * hours;
+
+    const uint mins = milliseconds / 60000;
+    milliseconds -= 60000 * mins;
+
+    const uint secs = milliseconds / 1000;
+    milliseconds -= 1000 * secs;
+
+    append_zero_padded(out, hours, 2);
+    out.push_back(':');
+    append_zero_padded(out, mins, 2);
+    out.push_back(':');
+    append_zero_padded(out, secs, 2);
+    out.push_back(milliseconds_separator);
+    append_zero_padded(out, milliseconds, 3);
+    return true;
+}
+
+// transcript timing and subtitle settings, shared by all formats of a transcript
+struct SrtState {
+    std::chrono::steady_clock::time_point transcript_started_at;
+    std::chrono::steady_clock::duration max_entry_duration;
+    uint line_length = 0;
+    bool add_punctuation = false;
+    bool split_sentence = false;
+    CapitalizationType capitalization = CAPITALIZATION_NORMAL;
+
+    // only use caption results that were created up to this many milliseconds before the transcript was created
+    // to prevent a sentence that had already started being spoken before the transcript started from going into the log
+    // if it was started too long ago
+    uint max_prestart_ms = 0;
+};
+
+enum SubtitleFormat {
+    SUBTITLE_FORMAT_SRT,
+    SUBTITLE_FORMAT_WEBVTT,
+};
+
+/*
+ Builds SRT or WebVTT cues as final results come in.
+
+ The open cue collects results as long as they end within max_entry_duration of its start, its text is wrapped
+ into lines as it grows so only the last, still open line gets looked at again. A result that doesn't fit anymore
+ writes the cue out and starts the next one, and once max_entry_duration passed since the cue started nothing
+ can join it anymore, whoever owns the builder calls emit_due() at cue_due_at() to write it out right away.
+*/
+class SubtitleCueBuilder {
+    const SubtitleFormat format;
+    const SrtState &settings;
+    uint sequence_number = 1;
+
+    bool cue_open = false;
+    MonoTP cue_start;
+    MonoTP cue_end;
+    std::string cue_lines;  // wrapped lines, each ending with NEWLINE_STR
+    std::string open_line;  // last line, might still get more words
+
+    // reused between results
+    std::string part_text;
+    std::vector<std::string> wrapped;
+    std::vector<std::string_view> words;
+
+    void emit_cue(TranscriptSink &sink) {
+        cue_open = false;
+        if (!open_line.empty()) {
+            cue_lines.append(open_line);
+            cue_lines.append(NEWLINE_STR);
+            open_line.clear();
+        }
+        if (cue_lines.empty())
+            return;
+
+        int start_offset_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            cue_start - settings.transcript_started_at).count();
+        const int end_offset_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            cue_end - settings.transcript_started_at).count();
+
+        if (start_offset_ms < 0)
+            start_offset_ms = 0;
+
+        if (end_offset_ms >= 0) {
+            const char milliseconds_separator = format == SUBTITLE_FORMAT_WEBVTT ? '.' : ',';
+
+            std::string &out = sink.append_buffer();
+            append_zero_padded(out, sequence_number++, 1);
+            out.append(NEWLINE_STR);
+            append_time_duration(out, start_offset_ms, milliseconds_separator);
+            out.append(" --> ");
+            append_time_duration(out, end_offset_ms, milliseconds_separator);
+            out.append(NEWLINE_STR);
+            out.append(cue_lines);
+            out.append(NEWLINE_STR);
+            sink.entry_appended();
+        }
+        cue_lines.clear();
+    }
+
+    void append_text(std::string_view text, bool sentence_start) {
+        part_text.clear();
+        if (!open_line.empty() || !cue_lines.empty())
+            part_text.append(settings.add_punctuation && sentence_start ? ". " : " ");
+
+        const size_t text_start = part_text.size();
+        for (const char c: text) {
+            if (c == '\n')
+                part_text.push_back(' ');
+            else if (c != '\r')
+                part_text.push_back(c);
+        }
+
+        if (settings.add_punctuation
+            && settings.capitalization == CAPITALIZATION_NORMAL
+            && sentence_start
+            && text_start < part_text.size()
+            && isascii(part_text[text_start])) {
+            part_text[text_start] = toupper(part_text[text_start]);
+        }
+
+        if (!settings.line_length) {
+            open_line.append(part_text);
+            return;
+        }
+
+        // only the open line can still change, wrap it together with the new text
+        open_line.append(part_text);
+        wrapped.clear();
+        utils::split_into_lines(wrapped, open_line, settings.line_length);
+        open_line.clear();
+        for (size_t i = 0; i < wrapped.size(); i++) {
+            if (i + 1 == wrapped.size()) {
+                open_line = std::move(wrapped[i]);
+                break;
+            }
+            cue_lines.append(wrapped[i]);
+            cue_lines.append(NEWLINE_STR);
+        }
+    }
+
+    void add_part(const MonoTP &start, const MonoTP &end, std::string_view text, bool sentence_start, TranscriptSink &sink) {
+        if (cue_open && end - cue_start > settings.max_entry_duration)
+            emit_cue(sink);
+
+        if (!cue_open) {
+            cue_open = true;
+            cue_start = start;
+        }
+        cue_end = end;
+        append_text(text, sentence_start);
+    }
+
+    void split_words(std::string_view text) {
+        words.clear();
+        size_t pos = 0;
+        while (pos < text.size()) {
+            while (pos < text.size() && isspace((unsigned char) text[pos]))
+                pos++;
+
+            const size_t word_start = pos;
+            while (pos < text.size() && !isspace((unsigned char) text[pos]))
+                pos++;
+
+            if (pos > word_start)
+                words.push_back(text.substr(word_start, pos - word_start));
+        }
+    }
+
+    // sentence longer than max_entry_duration, spread its words evenly over parts that each fit into a cue
+    void add_split(const MonoTP &start, const MonoTP &end, std::string_view text, TranscriptSink &sink) {
+        const MonoDur length = end - start;
+        const double parts = (double) (std::chrono::duration_cast<std::chrono::milliseconds>(length).count()) /
+            (double) (std::chrono::duration_cast<std::chrono::milliseconds>(settings.max_entry_duration).count());
+        const size_t parts_cnt = ceil(parts);
+
+        split_words(text);
+        if (parts_cnt <= 1 || words.empty()) {
+            add_part(start, end, text, true, sink);
+            return;
+        }
+
+        const size_t chunks = std::min(parts_cnt, words.size());
+        const size_t chunk_length = words.size() / parts_cnt;
+        size_t extra = words.size() % parts_cnt;
+
+        const MonoDur part_duration = length / parts_cnt;
+        size_t begin = 0;
+        for (size_t i = 0; i < chunks; i++) {
+            size_t chunk_end = begin + chunk_length;
+            if (extra > 0) {
+                chunk_end++;
+                extra--;
+            }
+            if (chunk_end == begin)
+                continue;
+
+            // words are views into text, so the chunk is the text from its first to its last word
+            const char *chunk_start_at = words[begin].data();
+            const char *chunk_end_at = words[chunk_end - 1].data() + words[chunk_end - 1].size();
+            const std::string_view chunk(chunk_start_at, chunk_end_at - chunk_start_at);
+
+            add_part(start + part_duration * i, start + part_duration * (i + 1), chunk, i == 0, sink);
+            begin = chunk_end;
+        }
+    }
+
+public:
+    SubtitleCueBuilder(SubtitleFormat format, const SrtState &settings) :
+            format(format),
+            settings(settings) {}
+
+    // WebVTT files have to start with it, SRT has none
+    void write_header(TranscriptSink &sink) {
+        if (format != SUBTITLE_FORMAT_WEBVTT)
+            return;
+
+        std::string &out = sink.append_buffer();
+        out.append("WEBVTT");
+        out.append(NEWLINE_STR);
+        out.append(NEWLINE_STR);
+        sink.entry_appended();
+    }
+
+    // a final result, writes out every cue it completes
+    void add(const OutputCaptionResult &result, TranscriptSink &sink) {
+        std::string text = result.clean_caption_text;
+        utils::string_capitalization(text, settings.capitalization);
+
+        const MonoTP &start = result.caption_result.first_received_at;
+        const MonoTP &end = result.caption_result.received_at;
+        if (settings.split_sentence && end - start > settings.max_entry_duration)
+            add_split(start, end, text, sink);
+        else
+            add_part(start, end, text, true, sink);
+    }
+
+    // time_point::max() without an open cue
+    MonoTP cue_due_at() const {
+        if (!cue_open)
+            return MonoTP::max();
+
+        return cue_start + settings.max_entry_duration;
+    }
+
+    void emit_due(const MonoTP &now, TranscriptSink &sink) {
+        if (cue_open && now >= cue_due_at())
+            emit_cue(sink);
+    }
+
+    // end of the transcript, writes the open cue
+    void finish(TranscriptSink &sink) {
+        if (cue_open)
+            emit_cue(sink);
+    }
+};
+
+}
+
+#endif //OBS_SPEECH2TEXT_PLUGIN_SUBTITLE_CUE_BUILDER_H
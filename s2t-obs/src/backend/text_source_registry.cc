@@ -0,0 +1,162 @@
+// Copyright 2022 gab
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "text_source_registry.h"
+
+#include "spdlog/spdlog.h"
+
+namespace backend {
+
+TextSourceRegistry::TextSourceRegistry() : update_data(obs_data_create()) {
+    signal_handler_connect(obs_get_signal_handler(), "source_destroy", source_destroy_cb, this);
+    signal_handler_connect(obs_get_signal_handler(), "source_rename", source_rename_cb, this);
+    obs_add_tick_callback(tick_cb, this);
+}
+
+void TextSourceRegistry::tick_cb(void *param, float seconds) {
+    auto registry = reinterpret_cast<TextSourceRegistry *>(param);
+    if (registry)
+        registry->flush();
+}
+
+void TextSourceRegistry::source_destroy_cb(void *param, calldata_t *calldata) {
+    auto registry = reinterpret_cast<TextSourceRegistry *>(param);
+    auto source = reinterpret_cast<obs_source_t *>(calldata_ptr(calldata, "source"));
+    if (!registry || !source)
+        return;
+
+    std::lock_guard<std::mutex> lock(registry->entries_mutex);
+    for (auto &entry: registry->entries) {
+        if (entry.second.weak_source && obs_weak_source_references_source(entry.second.weak_source, source)) {
+            spdlog::debug("text source '{}' destroyed, dropping reference", entry.first);
+            registry->invalidate(entry.second);
+        }
+    }
+}
+
+void TextSourceRegistry::source_rename_cb(void *param, calldata_t *calldata) {
+    auto registry = reinterpret_cast<TextSourceRegistry *>(param);
+    if (!registry)
+        return;
+
+    const char *new_name = calldata_string(calldata, "new_name");
+    const char *prev_name = calldata_string(calldata, "prev_name");
+
+    std::lock_guard<std::mutex> lock(registry->entries_mutex);
+    for (const char *name: {prev_name, new_name}) {
+        if (!name)
+            continue;
+
+        auto found = registry->entries.find(name);
+        if (found == registry->entries.end())
+            continue;
+
+        spdlog::debug("text source '{}' renamed, looking it up again", found->first);
+        registry->invalidate(found->second);
+
+        // a source that just got the configured name should show the current caption right away
+        if (!found->second.text.empty())
+            found->second.dirty = true;
+    }
+}
+
+void TextSourceRegistry::invalidate(TextSourceEntry &entry) {
+    if (entry.weak_source) {
+        obs_weak_source_release(entry.weak_source);
+        entry.weak_source = nullptr;
+    }
+    entry.generation++;
+}
+
+void TextSourceRegistry::set_text(const std::string &text_source_name, const std::string &text) {
+    std::lock_guard<std::mutex> lock(entries_mutex);
+    TextSourceEntry &entry = entries[text_source_name];
+    if (entry.text == text)
+        return;
+
+    entry.text = text;
+    entry.dirty = true;
+}
+
+void TextSourceRegistry::flush() {
+    {
+        std::lock_guard<std::mutex> lock(entries_mutex);
+        for (auto &entry: entries) {
+            if (!entry.second.dirty)
+                continue;
+
+            entry.second.dirty = false;
+            if (entry.second.weak_source)
+                obs_weak_source_addref(entry.second.weak_source);
+
+            pending.push_back(PendingUpdate{entry.first, entry.second.text, entry.second.weak_source, entry.second.generation});
+        }
+    }
+
+    if (pending.empty())
+        return;
+
+    // OBS calls happen without holding entries_mutex, the rename/destroy signals can come in from under OBS locks
+    for (auto &update: pending) {
+        obs_source_t *text_source = nullptr;
+        bool looked_up = false;
+
+        if (update.weak_source) {
+            text_source = obs_weak_source_get_source(update.weak_source);
+            obs_weak_source_release(update.weak_source);
+            update.weak_source = nullptr;
+        }
+
+        if (!text_source) {
+            text_source = obs_get_source_by_name(update.name.c_str());
+            looked_up = true;
+        }
+
+        if (!text_source) {
+            spdlog::debug("text source: {} not found, can't set caption text", update.name);
+            continue;
+        }
+
+        obs_data_set_string(update_data, "text", update.text.c_str());
+        obs_source_update(text_source, update_data);
+
+        if (looked_up) {
+            std::lock_guard<std::mutex> lock(entries_mutex);
+            auto found = entries.find(update.name);
+            if (found != entries.end() && found->second.generation == update.generation && !found->second.weak_source)
+                found->second.weak_source = obs_source_get_weak_source(text_source);
+        }
+
+        obs_source_release(text_source);
+    }
+    pending.clear();
+}
+
+void TextSourceRegistry::clear() {
+    std::lock_guard<std::mutex> lock(entries_mutex);
+    for (auto &entry: entries)
+        invalidate(entry.second);
+    entries.clear();
+}
+
+TextSourceRegistry::~TextSourceRegistry() {
+    obs_remove_tick_callback(tick_cb, this);
+    signal_handler_disconnect(obs_get_signal_handler(), "source_rename", source_rename_cb, this);
+    signal_handler_disconnect(obs_get_signal_handler(), "source_destroy", source_destroy_cb, this);
+
+    clear();
+    obs_data_release(update_data);
+}
+
+}
@@ -0,0 +1,77 @@
+// Copyright 2022 gab
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef OBS_SPEECH2TEXT_PLUGIN_TEXT_SOURCE_REGISTRY_H
+#define OBS_SPEECH2TEXT_PLUGIN_TEXT_SOURCE_REGISTRY_H
+
+#include <obs.h>
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace backend {
+
+struct TextSourceEntry {
+    obs_weak_source_t *weak_source = nullptr;
+    std::string text;
+    bool dirty = false;
+
+    // bumped whenever weak_source gets invalidated so a lookup that raced with it doesn't get stored
+    unsigned long generation = 0;
+};
+
+/*
+ Keeps weak references to the text sources captions get written to, looked up by name only once and
+ dropped again on OBS "source_rename"/"source_destroy" signals.
+
+ set_text() only stores the latest text, the sources are updated from an OBS tick callback so every
+ text source gets at most one update per video frame, with whatever text is the newest by then.
+*/
+class TextSourceRegistry {
+    struct PendingUpdate {
+        std::string name;
+        std::string text;
+        obs_weak_source_t *weak_source;
+        unsigned long generation;
+    };
+
+    std::mutex entries_mutex;
+    std::map<std::string, TextSourceEntry> entries;
+
+    // only used from the tick callback
+    std::vector<PendingUpdate> pending;
+    obs_data_t *update_data;
+
+    static void tick_cb(void *param, float seconds);
+    static void source_destroy_cb(void *param, calldata_t *calldata);
+    static void source_rename_cb(void *param, calldata_t *calldata);
+
+    void invalidate(TextSourceEntry &entry);
+    void flush();
+
+public:
+    TextSourceRegistry();
+
+    void set_text(const std::string &text_source_name, const std::string &text);
+
+    void clear();
+
+    ~TextSourceRegistry();
+};
+
+}
+
+#endif //OBS_SPEECH2TEXT_PLUGIN_TEXT_SOURCE_REGISTRY_H
@@ -15,38 +15,85 @@
 #ifndef OBS_SPEECH2TEXT_PLUGIN_THREADSAFE_CB_H
 #define OBS_SPEECH2TEXT_PLUGIN_THREADSAFE_CB_H
 
-#include <thread>
-#include <mutex>
+#include <atomic>
+#include <cstdint>
 #include <functional>
+#include <thread>
+#include <utility>
 
 namespace backend {
 
+/*
+ Callback that can be replaced or cleared while other threads are calling it, e.g. the audio and result
+ callbacks of the capture pipelines and inference streams.
+
+ Calling it never blocks: a caller registers itself in the counter of the current epoch, loads the callback and
+ calls it. set() and clear() swap in the new callback and then wait until every call that could still be using the
+ old one returned before deleting it: they advance the epoch and wait for the callers of the epoch before it, twice,
+ so callers that read the epoch right before it advanced are covered too. Replacing the callback is rare, calling it
+ is what's fast.
+
+ Like with the mutex before, clear() in a destructor returns only once no call is running anymore.
+ So set() and clear() must not be called from inside the callback itself, they would wait for themselves.
+*/
 template<typename T>
 class ThreadsafeCb {
-public:
-    T callback_fn;
-    bool lock_to_clear = true;
-    std::recursive_mutex mutex;
+    std::atomic<const T *> callback{nullptr};
+    std::atomic<uint64_t> epoch{0};
+    std::atomic<uint32_t> callers[2] = {{0}, {0}};
+
+    void wait_for_callers() {
+        for (int i = 0; i < 2; i++) {
+            const uint64_t previous = epoch.fetch_add(1);
+            while (callers[previous & 1].load())
+                std::this_thread::yield();
+        }
+    }
+
+    void replace(const T *new_callback) {
+        const T *old_callback = callback.exchange(new_callback);
+        if (!old_callback)
+            return;
 
+        wait_for_callers();
+        delete old_callback;
+    }
+
+public:
     ThreadsafeCb() {};
-    ThreadsafeCb(T callback_fn) : callback_fn(callback_fn), lock_to_clear(lock_to_clear) {}
+    ThreadsafeCb(T callback_fn) {
+        if (callback_fn)
+            callback.store(new T(std::move(callback_fn)));
+    }
+
+    ThreadsafeCb(const ThreadsafeCb &) = delete;
+    ThreadsafeCb &operator=(const ThreadsafeCb &) = delete;
+
+    // false if there is no callback
+    template<typename... Args>
+    bool invoke(Args &&... args) {
+        std::atomic<uint32_t> &epoch_callers = callers[epoch.load() & 1];
+        epoch_callers.fetch_add(1);
+
+        const T *callback_fn = callback.load();
+        if (callback_fn)
+            (*callback_fn)(std::forward<Args>(args)...);
+
+        epoch_callers.fetch_sub(1);
+        return callback_fn != nullptr;
+    }
+
+    // for skipping work nobody would get, the callback can still be gone when invoked right after
+    bool empty() const {
+        return callback.load(std::memory_order_relaxed) == nullptr;
+    }
 
     void clear() {
-        if (lock_to_clear) {
-            std::lock_guard<std::recursive_mutex> lock(mutex);
-            callback_fn = nullptr;
-        } else {
-            callback_fn = nullptr;
-        }
+        replace(nullptr);
     }
 
-    void set(T new_callback_fn, bool lock_to_clear = true) {
-        clear();
-        {
-            std::lock_guard<std::recursive_mutex> lock(mutex);
-            this->callback_fn = new_callback_fn;
-            this->lock_to_clear = lock_to_clear;
-        }
+    void set(T new_callback_fn) {
+        replace(new_callback_fn ? new T(std::move(new_callback_fn)) : nullptr);
     }
 
     ~ThreadsafeCb() {
@@ -56,4 +103,4 @@ public:
 
 }
 
-#endif // OBS_SPEECH2TEXT_PLUGIN_THREADSAFE_CB_H
\ No newline at end of file
+#endif // OBS_SPEECH2TEXT_PLUGIN_THREADSAFE_CB_H
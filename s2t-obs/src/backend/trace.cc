@@ -0,0 +1,191 @@
+// Copyright 2022 gab
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "trace.h"
+
+#include <cinttypes>
+#include <cstdio>
+
+#include <QSaveFile>
+
+#include "spdlog/spdlog.h"
+
+#include "worker_runtime.h"
+
+namespace backend {
+
+namespace {
+
+struct ThreadTrace {
+    std::string name;
+    std::shared_ptr<TraceBuffer> buffer;
+
+    ~ThreadTrace() {
+        if (buffer)
+            TraceRecorder::instance().release_buffer(buffer);
+    }
+};
+
+thread_local ThreadTrace thread_trace;
+
+struct DumpedSpan {
+    const char *name;
+    int64_t start_ns;
+    int64_t duration_ns;
+};
+
+}
+
+int64_t trace_now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void set_trace_thread_name(const std::string &name) {
+    thread_trace.name = name;
+}
+
+TraceRecorder &TraceRecorder::instance() {
+    static TraceRecorder recorder;
+    return recorder;
+}
+
+TraceBuffer &TraceRecorder::thread_buffer() {
+    if (!thread_trace.buffer) {
+        const int64_t thread_id = current_native_thread_id();
+        const std::string name = thread_trace.name.empty() ? "thread " + std::to_string(thread_id) : thread_trace.name;
+        thread_trace.buffer = std::make_shared<TraceBuffer>(thread_id, name);
+
+        std::lock_guard<std::mutex> lock(buffers_mutex);
+        buffers.push_back(thread_trace.buffer);
+    }
+    return *thread_trace.buffer;
+}
+
+void TraceRecorder::release_buffer(const std::shared_ptr<TraceBuffer> &buffer) {
+    std::lock_guard<std::mutex> lock(buffers_mutex);
+    for (auto it = buffers.begin(); it != buffers.end(); ++it) {
+        if (*it == buffer) {
+            buffers.erase(it);
+            break;
+        }
+    }
+
+    exited_buffers.push_back(buffer);
+    if (exited_buffers.size() > TRACE_MAX_EXITED_BUFFERS)
+        exited_buffers.erase(exited_buffers.begin());
+}
+
+static void append_json_string(std::string &out, const std::string &str) {
+    out.push_back('"');
+    for (const char c: str) {
+        if (c == '"' || c == '\\') {
+            out.push_back('\\');
+            out.push_back(c);
+        } else if ((unsigned char) c < 0x20) {
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", (unsigned int) c);
+            out.append(escaped);
+        } else {
+            out.push_back(c);
+        }
+    }
+    out.push_back('"');
+}
+
+// spans of the buffer that ended at or after from_ns and started before until_ns, without the ones its thread
+// overwrote while they were read
+static void dump_buffer(const TraceBuffer &buffer, int64_t from_ns, int64_t until_ns, std::vector<DumpedSpan> &spans) {
+    const uint64_t written = buffer.written.load(std::memory_order_acquire);
+    const uint64_t first = written > TRACE_BUFFER_SPANS ? written - TRACE_BUFFER_SPANS : 0;
+
+    spans.clear();
+    for (uint64_t index = first; index < written; index++) {
+        const TraceSpanRecord &record = buffer.spans[index % TRACE_BUFFER_SPANS];
+        spans.push_back(DumpedSpan{
+            record.name.load(std::memory_order_relaxed),
+            record.start_ns.load(std::memory_order_relaxed),
+            record.duration_ns.load(std::memory_order_relaxed)
+        });
+    }
+
+    // the one being recorded right now might be half written too
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const uint64_t written_after = buffer.written.load(std::memory_order_relaxed);
+    const uint64_t valid_from = written_after >= TRACE_BUFFER_SPANS ? written_after - TRACE_BUFFER_SPANS + 1 : 0;
+
+    size_t kept = 0;
+    for (size_t i = 0; i < spans.size(); i++) {
+        if (first + i < valid_from || !spans[i].name || spans[i].start_ns + spans[i].duration_ns < from_ns
+            || spans[i].start_ns > until_ns)
+            continue;
+        spans[kept++] = spans[i];
+    }
+    spans.resize(kept);
+}
+
+uint64_t TraceRecorder::write_chrome_trace(const QString &path, int64_t until_ns, int64_t window_ms) {
+    std::vector<std::shared_ptr<TraceBuffer>> to_dump;
+    {
+        std::lock_guard<std::mutex> lock(buffers_mutex);
+        to_dump = exited_buffers;
+        to_dump.insert(to_dump.end(), buffers.begin(), buffers.end());
+    }
+
+    const int64_t from_ns = until_ns - window_ms * 1000000;
+
+    std::string out;
+    out.append("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    out.append(R"({"name":"process_name","ph":"M","pid":1,"tid":0,"args":{"name":"obs-speech2text-plugin"}})");
+
+    uint64_t span_count = 0;
+    size_t thread_count = 0;
+    std::vector<DumpedSpan> spans;
+    char line[256];
+    for (const auto &buffer: to_dump) {
+        dump_buffer(*buffer, from_ns, until_ns, spans);
+        if (spans.empty())
+            continue;
+
+        snprintf(line, sizeof(line), ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%" PRId64 ",\"args\":{\"name\":",
+                 buffer->thread_id);
+        out.append(line);
+        append_json_string(out, buffer->thread_name);
+        out.append("}}");
+
+        // microseconds since the start of the window
+        for (const auto &span: spans) {
+            snprintf(line, sizeof(line), ",\n{\"ph\":\"X\",\"cat\":\"s2t\",\"pid\":1,\"tid\":%" PRId64 ",\"ts\":%.3f,\"dur\":%.3f,\"name\":",
+                     buffer->thread_id, (double) (span.start_ns - from_ns) / 1000.0, (double) span.duration_ns / 1000.0);
+            out.append(line);
+            append_json_string(out, span.name);
+            out.push_back('}');
+        }
+        span_count += spans.size();
+        thread_count++;
+    }
+    out.append("\n]}\n");
+
+    // QSaveFile for paths that aren't in the local 8 bit encoding on Windows, and never leaving half a file
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+        throw std::string("couldn't open trace file: " + path.toStdString());
+    if (file.write(out.data(), (qint64) out.size()) != (qint64) out.size() || !file.commit())
+        throw std::string("couldn't write trace file: " + path.toStdString());
+
+    spdlog::info("wrote {} trace spans of {} threads, last {} ms, to {}", span_count, thread_count, window_ms, path.toStdString());
+    return span_count;
+}
+
+}
@@ -0,0 +1,136 @@
+// Copyright 2022 gab
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef OBS_SPEECH2TEXT_PLUGIN_TRACE_H
+#define OBS_SPEECH2TEXT_PLUGIN_TRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <QString>
+
+namespace backend {
+
+// spans kept per thread before the oldest get overwritten, minutes at the ~100 spans/s of the audio thread
+#define TRACE_BUFFER_SPANS 16384
+
+// buffers of threads that exited, kept so streams that just reconnected still show up in a dump
+#define TRACE_MAX_EXITED_BUFFERS 8
+
+#define TRACE_DEFAULT_WINDOW_MS 30000
+
+struct TraceSpanRecord {
+    std::atomic<const char *> name{nullptr};
+    std::atomic<int64_t> start_ns{0};
+    std::atomic<int64_t> duration_ns{0};
+};
+
+/*
+ Ring of the spans of one thread. Only that thread writes, so recording is a few relaxed stores and a release
+ of the counter, no lock. A dump reading it while it's written skips whatever may have been overwritten meanwhile.
+*/
+struct TraceBuffer {
+    int64_t thread_id;
+    std::string thread_name;
+    std::atomic<uint64_t> written{0};
+    TraceSpanRecord spans[TRACE_BUFFER_SPANS];
+
+    TraceBuffer(int64_t thread_id, std::string thread_name) : thread_id(thread_id), thread_name(std::move(thread_name)) {}
+
+    void record(const char *name, int64_t start_ns, int64_t duration_ns) {
+        const uint64_t index = written.load(std::memory_order_relaxed);
+        TraceSpanRecord &span = spans[index % TRACE_BUFFER_SPANS];
+        span.name.store(name, std::memory_order_relaxed);
+        span.start_ns.store(start_ns, std::memory_order_relaxed);
+        span.duration_ns.store(duration_ns, std::memory_order_relaxed);
+        written.store(index + 1, std::memory_order_release);
+    }
+};
+
+/*
+ Collects the spans of every thread that records any, for dumping them as Chrome trace event JSON that Perfetto
+ (ui.perfetto.dev) and chrome://tracing open. Always recording while enabled, a dump covers the last window_ms.
+*/
+class TraceRecorder {
+    std::mutex buffers_mutex;
+    std::vector<std::shared_ptr<TraceBuffer>> buffers;
+    std::vector<std::shared_ptr<TraceBuffer>> exited_buffers;
+    std::atomic<bool> enabled{true};
+
+    TraceRecorder() = default;
+
+public:
+    static TraceRecorder &instance();
+
+    bool is_enabled() const {
+        return enabled.load(std::memory_order_relaxed);
+    }
+
+    void set_enabled(bool enable) {
+        enabled.store(enable, std::memory_order_relaxed);
+    }
+
+    // the calling thread's buffer, made on its first span
+    TraceBuffer &thread_buffer();
+
+    // called when a thread with a buffer exits
+    void release_buffer(const std::shared_ptr<TraceBuffer> &buffer);
+
+    // spans of the window_ms up to until_ns (trace_now_ns() time), throws std::string on errors.
+    // returns the number of spans written
+    uint64_t write_chrome_trace(const QString &path, int64_t until_ns, int64_t window_ms = TRACE_DEFAULT_WINDOW_MS);
+};
+
+// name for the calling thread's spans in dumps, before its first span. WorkerThreads get theirs
+void set_trace_thread_name(const std::string &name);
+
+int64_t trace_now_ns();
+
+/*
+ Records the time from its construction to its destruction as a span of the calling thread.
+ name has to outlive the recorder, only string literals.
+*/
+class TraceSpan {
+    const char *name;
+    int64_t start_ns = 0;
+
+public:
+    explicit TraceSpan(const char *name) : name(name) {
+        if (TraceRecorder::instance().is_enabled())
+            start_ns = trace_now_ns();
+    }
+
+    TraceSpan(const TraceSpan &) = delete;
+    TraceSpan &operator=(const TraceSpan &) = delete;
+
+    ~TraceSpan() {
+        if (start_ns)
+            TraceRecorder::instance().thread_buffer().record(name, start_ns, trace_now_ns() - start_ns);
+    }
+};
+
+}
+
+#define S2T_TRACE_CONCAT_(a, b) a##b
+#define S2T_TRACE_CONCAT(a, b) S2T_TRACE_CONCAT_(a, b)
+
+// span until the end of the enclosing scope
+#define S2T_TRACE_SPAN(name) backend::TraceSpan S2T_TRACE_CONCAT(s2t_trace_span_, __LINE__)(name)
+
+#endif //OBS_SPEECH2TEXT_PLUGIN_TRACE_H
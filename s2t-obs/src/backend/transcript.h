@@ -15,35 +15,29 @@
 #ifndef OBS_SPEECH2TEXT_PLUGIN_TRANSCRIPT_H
 #define OBS_SPEECH2TEXT_PLUGIN_TRANSCRIPT_H
 
+#include <charconv>
 #include <iomanip>
 #include <iostream>
+#include <mutex>
 #include <fstream>
 #include <sstream>
-#include <deque>
 
 #include <QDir>
+#include <QFile>
 #include <spdlog/spdlog.h>
 
+#include "caption_journal.h"
+#include "shutdown.h"
+#include "subtitle_cue_builder.h"
+#include "trace.h"
+#include "transcript_segments.h"
+#include "transcript_sink.h"
+#include "transcript_wal.h"
 #include "utils/ui.h"
 #include "utils/strings.h"
 
 namespace backend {
 
-using ResultTup = std::tuple<
-    std::chrono::steady_clock::time_point,
-    std::chrono::steady_clock::time_point,
-    std::string,
-    bool    //is_sentence_start: false for parts[1:] of a sentence that was split into multiple parts
-            // so those can be handled differently from normal single full sentences.
->;
-
-using ResultQueue = std::deque<ResultTup>;
-
-const std::string NEWLINE_STR = "\r\n";
-
-using MonoTP = std::chrono::steady_clock::time_point;
-using MonoDur = std::chrono::steady_clock::duration;
-
 QFileInfo find_unused_filename(const QFileInfo &output_directory,
     const QString &basename,
     const QString &extension,
@@ -110,17 +104,23 @@ QFileInfo find_transcript_filename_custom(const TranscriptOutputSettings &transc
     const QFileInfo &output_directory,
     const std::chrono::system_clock::time_point &started_at,
     const int tries,
+    const string &extra_suffix,
     bool &out_overwrite) {
 
-    // fully user supplied name, don't add any extension
+    // fully user supplied name, don't add any extension.
+    // Extra formats written next to it get a suffix, see transcript_format_custom_suffix(): "[custom].[suffix]"
     if (rel.filename_custom.empty())
         throw std::string("custom filename chosen but no filename given");
 
+    std::string filename = rel.filename_custom;
+    if (!extra_suffix.empty())
+        filename += "." + extra_suffix;
+
     if (rel.filename_custom_exists == "overwrite") {
         out_overwrite = true;
     }
 
-    auto file = QFileInfo(QDir(output_directory.absoluteFilePath()).absoluteFilePath(QString::fromStdString(rel.filename_custom)));
+    auto file = QFileInfo(QDir(output_directory.absoluteFilePath()).absoluteFilePath(QString::fromStdString(filename)));
     if (!file.exists())
         return file;
 
@@ -197,16 +197,19 @@ QFileInfo find_transcript_filename(const TranscriptOutputSettings &transcript_se
     const UseTranscriptSettings &rel,
     const QFileInfo &output_directory,
     const string &target_name,
+    const string &format,
+    const bool extra_format,
     const std::chrono::system_clock::time_point &started_at,
     const int tries,
     bool &out_overwrite) {
 
     out_overwrite = false;
+    const std::string extension = transcript_format_extension(format, "");
     if (rel.name_type == "custom") {
-        return find_transcript_filename_custom(transcript_settings, rel, output_directory, started_at, tries, out_overwrite);
+        return find_transcript_filename_custom(transcript_settings, rel, output_directory, started_at, tries,
+                                               extra_format ? transcript_format_custom_suffix(format) : "", out_overwrite);
     }
 
-    const std::string extension = transcript_format_extension(transcript_settings.format, "");
     if (rel.name_type == "datetime") {
         return find_transcript_filename_datetime(transcript_settings, rel, output_directory, started_at, tries, extension);
     }
@@ -218,17 +221,17 @@ QFileInfo find_transcript_filename(const TranscriptOutputSettings &transcript_se
 
         for (int i = 0; i < attempts; i++) {
             if (i) {
-                spdlog::info("transcript_writer_loop find_transcript_filename recording retry, attempt %d, sleeping %dms", i, sleep_ms);
+                spdlog::info("transcript_writer_loop find_transcript_filename recording retry, attempt {}, sleeping {}ms", i, sleep_ms);
                 std::this_thread::sleep_for(std::chrono::milliseconds(sleep_ms));
             }
             try {
                 return find_transcript_filename_recording(transcript_settings, output_directory, started_at, tries, extension, true);
             }
             catch (std::string &err) {
-                spdlog::error("transcript_writer_loop find_transcript_filename recording error, try %d: %s", i, err.c_str());
+                spdlog::error("transcript_writer_loop find_transcript_filename recording error, try {}: {}", i, err.c_str());
             }
             catch (...) {
-                spdlog::error("transcript_writer_loop find_transcript_filename recording error, try %d", i);
+                spdlog::error("transcript_writer_loop find_transcript_filename recording error, try {}", i);
             }
         }
 
@@ -242,552 +245,737 @@ QFileInfo find_transcript_filename(const TranscriptOutputSettings &transcript_se
     throw std::string("unsupported name type: " + rel.name_type);
 }
 
-std::string time_duration_stream(int milliseconds) {
-//    printf("milliseconds %d\n", milliseconds);
-    if (milliseconds < 0)
-        return "";
+bool relevant_result(const SrtState &settings, const CaptionOutput &caption_output) {
+    if (caption_output.output_result->clean_caption_text.empty())
+        return false;
 
-    std::ostringstream out;
-    out << std::setfill('0');
+    int start_offset_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        caption_output.output_result->caption_result.first_received_at - settings.transcript_started_at).count();
 
-    uint hours = milliseconds / 3600000;
-    milliseconds = milliseconds - (3600000 * hours);
+    if (start_offset_ms < 0) {
+        start_offset_ms = abs(start_offset_ms);
+        if (!settings.max_prestart_ms || start_offset_ms > settings.max_prestart_ms) {
+            spdlog::debug("relevant_result: result from before transcript started, too much from before, {}", start_offset_ms);
+            return false;
+        }
+    }
 
-    uint mins = milliseconds / 60000;
-    milliseconds = milliseconds - (60000 * mins);
+    int end_offset_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        caption_output.output_result->caption_result.received_at - settings.transcript_started_at).count();
 
-    uint secs = milliseconds / 1000;
-    milliseconds = milliseconds - (1000 * secs);
+    if (end_offset_ms < 0) {
+        spdlog::debug("relevant_result: result totally from before transcript started, ignore, {}", end_offset_ms);
+        return false;
+    }
 
-    out << std::setw(2) << hours << ":" << std::setw(2) << mins << ":" << std::setw(2) << secs << "," << std::setw(3) << milliseconds;
-    return out.str();
+    return true;
 }
 
-void fs_write_string(std::fstream &fs, const std::string &str) {
-    fs << str;
-    cerr << "writing:: " << str;
-}
+void write_transcript_caption_simple(TranscriptSink &sink,
+    const string &prefix,
+    const std::chrono::steady_clock::time_point &started_at,
+    const OutputCaptionResult &result,
+    const bool add_timestamps) {
 
-struct SrtState {
-    std::chrono::steady_clock::time_point transcript_started_at;
-    std::chrono::steady_clock::duration max_entry_duration;
-    uint sequence_number = 0;
-    uint line_length = 0;
-    bool add_punctuation = false;
-    bool split_sentence = false;
-    CapitalizationType capitalization = CAPITALIZATION_NORMAL;
-
-    // only use caption results that were created up to this many milliseconds before the transcript was created
-    // to prevent a sentence that had already started being spoken before the transcript started from going into the log
-    // if it was started too long ago
-    uint max_prestart_ms = 0;
-};
+    std::string &out = sink.append_buffer();
+    if (add_timestamps) {
+        int start_offset_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            result.caption_result.first_received_at - started_at).count();
+
+        int end_offset_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            result.caption_result.received_at - started_at).count();
 
-int batch_up_to(const SrtState &settings, ResultQueue &results) {
-    // returns index up to which the leading results can be combined into one
-    if (results.empty())
-        return -1;
+        if (start_offset_ms < 0)
+            start_offset_ms = 0;
 
-    auto &first_received_at = std::get<0>(results[0]);
+        if (end_offset_ms < 0)
+            end_offset_ms = 0;
 
-    uint take_until_ind = 0;
-    for (int i = 1; i < results.size(); i++) {
-        std::chrono::steady_clock::duration total = std::get<1>(results[i]) - first_received_at;
-        if (total <= settings.max_entry_duration)
-            take_until_ind = i;
-        else
-            break;
+        append_time_duration(out, start_offset_ms);
+        out.push_back('-');
+        append_time_duration(out, end_offset_ms);
+        out.push_back(' ');
     }
-    return take_until_ind;
+
+    out.append(prefix);
+    out.append(result.clean_caption_text);
+    out.push_back('\n');
+    sink.entry_appended();
 }
 
-std::string srt_entry_caption_text(const SrtState &settings, const ResultQueue &results, const int up_to_index) {
-    std::ostringstream text_os;
-    for (int i = 0; i < up_to_index + 1; i++) {
-        std::string line = std::get<2>(results[i]);
-        if (settings.add_punctuation
-            && settings.capitalization == CAPITALIZATION_NORMAL
-            && std::get<3>(results[i]) //only capitalize the first part
-            && !line.empty()
-            && isascii(line[0])) {
-            line[0] = toupper(line[0]);
+/*
+ One file of a TranscriptOutputHandler in one format. The handler decides once per result whether it's relevant
+ and which interim is held back, every format writer only encodes and buffers its own file.
+*/
+class TranscriptFormatWriter {
+    const std::string format;
+    const bool is_subtitle;
+    const MonoTP started_at;
+
+    TranscriptSink sink;
+    CaptionJournalWriter journal;
+    SubtitleCueBuilder cues;
+    std::unique_ptr<TranscriptSegmenter> segmenter;
+    TranscriptWalFile wal_file;
+
+    // between entries, continues in the next segment once the current one is full
+    bool roll_segment_if_due(const MonoTP &now) {
+        if (!segmenter || !segmenter->due(now, sink))
+            return !sink.failed();
+
+        // a segment ends with complete cues
+        if (is_subtitle)
+            cues.finish(sink);
+
+        const QString next_path = segmenter->next(now, sink);
+        if (!sink.open(next_path, true)) {
+            spdlog::error("transcript_writer_loop_{} error, couldn't open segment: '{}'", format, strerror(errno));
+            return false;
         }
+        cues.write_header(sink);
+        segmenter->header_written(sink);
+        return true;
+    }
 
-        text_os << line;
-//        printf("using line %d, '%s'\n", i, results[i]->clean_caption_text.c_str());
-        if (i) {
-            if (settings.add_punctuation) {
-                text_os << ". ";
-            } else
-                text_os << " ";
+    bool write_result_simple(const OutputCaptionResult &result, const string &prefix, bool add_timestamps) {
+        write_transcript_caption_simple(sink, prefix, started_at, result, add_timestamps);
+        if (sink.failed()) {
+            spdlog::error("transcript_writer_loop_{} error, write failed: '{}'", format, strerror(errno));
+            return false;
         }
+        return true;
     }
 
-    std::string text = text_os.str();
-    text.erase(std::remove(text.begin(), text.end(), '\r'), text.end());
-    std::replace(text.begin(), text.end(), '\n', ' ');
-//    printf("replaced '%s'\n", text.c_str());
+    bool write_raw(const OutputCaptionResult &result) {
+        string prefix;
+        if (result.interrupted && result.caption_result.final)
+            prefix = "IF    ";
+        else if (result.interrupted)
+            prefix = "I    ";
+        else if (result.caption_result.final)
+            prefix = "F    ";
+        else
+            prefix = "    ";
 
-    if (settings.line_length) {
-        std::vector<std::string> lines;
-        split_into_lines(lines, text, settings.line_length);
-        text.clear();
-        join_strings(lines, NEWLINE_STR, text);
+        return write_result_simple(result, prefix, true);
     }
 
-//    printf("lined %s\n", text.c_str());
-
-    return text;
-}
-
-int write_results_batch_srt(const SrtState &settings, std::fstream &fs, const ResultQueue &results, const int up_to_index) {
-    int start_offset_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-        std::get<0>(results[0]) - settings.transcript_started_at).count();
-
-    if (start_offset_ms < 0)
-        start_offset_ms = 0;
-
-    std::string start_offset_str = time_duration_stream(start_offset_ms);
-    if (start_offset_str.empty()) {
-        return -1;
+    bool write_journal(const OutputCaptionResult &result) {
+        journal.append(result);
+        if (journal.failed()) {
+            spdlog::error("transcript_writer_loop_journal error, write failed: '{}'", strerror(errno));
+            return false;
+        }
+        return true;
     }
 
-    const int end_offset_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-        std::get<1>(results[up_to_index]) - settings.transcript_started_at).count();
+public:
+    // srt_state: shared by all formats of the handler, srt and vtt cues are timed and wrapped with it
+    TranscriptFormatWriter(const std::string &format, const MonoTP &started_at, const SrtState &srt_state) :
+            format(format),
+            is_subtitle(format == "srt" || format == "vtt"),
+            started_at(started_at),
+            journal(started_at),
+            cues(format == "vtt" ? SUBTITLE_FORMAT_WEBVTT : SUBTITLE_FORMAT_SRT, srt_state) {}
 
-    if (end_offset_ms < 0) {
-        return 0;
+    static bool valid_format(const std::string &format) {
+        return format == "txt" || format == "txt_plain" || format == "srt" || format == "vtt" || format == "raw"
+            || format == "journal";
     }
 
-    const std::string end_offset_str = time_duration_stream(end_offset_ms);
-    if (end_offset_str.empty()) {
-        return -1;
+    const std::string &get_format() const {
+        return format;
     }
 
-    const std::string entry_text = srt_entry_caption_text(settings, results, up_to_index);
-    if (entry_text.empty()) {
-        return 0;
+    // where open() put the file, for the write-ahead log
+    const TranscriptWalFile &get_wal_file() const {
+        return wal_file;
     }
 
-    std::ostringstream entry_os;
-    entry_os << settings.sequence_number << NEWLINE_STR;
-    entry_os << start_offset_str << " --> " << end_offset_str << NEWLINE_STR;
-    entry_os << entry_text << NEWLINE_STR;
-    entry_os << NEWLINE_STR;
+    // before open(), journals aren't split
+    void set_segmenter(std::unique_ptr<TranscriptSegmenter> new_segmenter) {
+        if (format != "journal" && new_segmenter && new_segmenter->enabled())
+            segmenter = std::move(new_segmenter);
+    }
 
-    fs_write_string(fs, entry_os.str());
-    return entry_text.size();
-}
+    bool open(const QString &base_path, bool overwrite, const std::chrono::system_clock::time_point &started_at_sys) {
+        wal_file = TranscriptWalFile{format, base_path, overwrite ? 0 : QFileInfo(base_path).size(), (bool) segmenter};
 
-bool write_transcript_caption_results_srt(SrtState &settings, std::fstream &fs, ResultQueue &results, bool write_all) {
-    // batch up multiple results into a single entry if the duration of all of them combined is less than settings.max_entry_duration
-
-    const auto now = std::chrono::steady_clock::now();
-    while (!results.empty() && !fs.fail()) {
-        if (!write_all) {
-            auto since_first = now - std::get<0>(results[0]);
-            if (since_first <= settings.max_entry_duration) {
-                spdlog::debug(
-                    "write_transcript_caption_results_srt: current results still too recent, batch could still change, "
-                    "ignoring for now: %dms", (int) std::chrono::duration_cast<std::chrono::milliseconds>(since_first).count());
-                break;
-            }
+        QString path = base_path;
+        if (segmenter) {
+            path = segmenter->begin(base_path, format, std::chrono::steady_clock::now());
+            overwrite = true;
         }
 
-        const int up_to_index = batch_up_to(settings, results);
-        if (up_to_index < 0)
-            break;
-
-        spdlog::debug("write_transcript_caption_results_srt: using first %d items", up_to_index + 1);
-        const int ret = write_results_batch_srt(settings, fs, results, up_to_index);
-        if (ret > 0) {
-            if (fs.fail()) {
-                spdlog::error("write_transcript_caption_results_srt: failed writing entry %d, %s", settings.sequence_number, strerror(errno));
+        if (format != "journal") {
+            const bool new_file = overwrite || QFileInfo(path).size() == 0;
+            if (!sink.open(path, overwrite)) {
+                spdlog::error("transcript_writer_loop_{} error, couldn't open file: '{}'", format, strerror(errno));
                 return false;
             }
-            spdlog::debug("write_transcript_caption_results_srt: wrote srt entry %d", settings.sequence_number);
-            settings.sequence_number++;
-            for (int i = 0; i < up_to_index + 1; i++) {
-                results.pop_front();
-            }
-        } else if (ret == 0) {
-            spdlog::debug("write_transcript_caption_results_srt: skipped, still on entry %d", settings.sequence_number);
-            for (int i = 0; i < up_to_index + 1; i++) {
-                results.pop_front();
-            }
-        } else {
-            spdlog::error("write_transcript_caption_results_srt: failed writing entry %d", settings.sequence_number);
-            return false;
+            if (new_file)
+                cues.write_header(sink);
+            if (segmenter)
+                segmenter->header_written(sink);
+            return true;
         }
-    }
-    return true;
-}
 
-bool relevant_result(const SrtState &settings, const CaptionOutput &caption_output) {
-    if (caption_output.output_result->clean_caption_text.empty())
-        return false;
-
-    int start_offset_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-        caption_output.output_result->caption_result.first_received_at - settings.transcript_started_at).count();
+        // records are only ever appended to a fresh journal, so "append" can't work
+        if (!overwrite && QFileInfo(path).size() > 0) {
+            spdlog::error("transcript_writer_loop_journal error, caption journals can't be appended to: '{}'", path.toStdString());
+            return false;
+        }
 
-    if (start_offset_ms < 0) {
-        start_offset_ms = abs(start_offset_ms);
-        if (!settings.max_prestart_ms || start_offset_ms > settings.max_prestart_ms) {
-            spdlog::debug("relevant_result: result from before transcript started, too much from before, %d", start_offset_ms);
+        const int64_t started_at_unix_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            started_at_sys.time_since_epoch()).count();
+        if (!journal.open(path, started_at_unix_ms)) {
+            spdlog::error("transcript_writer_loop_journal error, couldn't open journal: '{}'", strerror(errno));
             return false;
         }
+        return true;
     }
 
-    int end_offset_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-        caption_output.output_result->caption_result.received_at - settings.transcript_started_at).count();
+    // relevant: not empty and not from too long before the transcript started, only raw and journal take the rest too.
+    // now: when the result was output, a cue that can't grow anymore by then is written before it
+    bool write(const std::shared_ptr<OutputCaptionResult> &result, bool relevant, const MonoTP &now) {
+        if (format == "raw")
+            return write_raw(*result) && roll_segment_if_due(now);
+        if (format == "journal")
+            return write_journal(*result);
 
-    if (end_offset_ms < 0) {
-        spdlog::debug("relevant_result: result totally from before transcript started, ignore, %d", end_offset_ms);
-        return false;
-    }
+        if (is_subtitle)
+            cues.emit_due(now, sink);
 
-    return true;
-}
+        if (!relevant || !result->caption_result.final)
+            return roll_segment_if_due(now);
 
-void split_vec(std::vector<std::vector<string>> &out, const std::vector<string> &words, size_t chunks) {
-    size_t length = words.size() / chunks;
-    size_t extra = words.size() % chunks;
+        if (format == "txt" && !write_result_simple(*result, "    ", true))
+            return false;
+        if (format == "txt_plain" && !write_result_simple(*result, "", false))
+            return false;
 
-    size_t begin = 0;
-    size_t end = 0;
-    for (size_t i = 0; i < (std::min)(chunks, words.size()); ++i) {
-        end += length;
-        if (extra > 0) {
-            end += 1;
-            extra--;
+        if (is_subtitle) {
+            cues.add(*result, sink);
+            if (sink.failed()) {
+                spdlog::error("transcript_writer_loop_{} error, write failed: '{}'", format, strerror(errno));
+                return false;
+            }
         }
-        out.push_back(std::vector<string>(words.begin() + begin, words.begin() + end));
-        begin = end;
+        return roll_segment_if_due(now);
     }
-}
-
-void split_res(const MonoTP &start, const MonoTP &end, const string &full_text, const MonoDur &max_duration, ResultQueue &results) {
-    MonoDur length = end - start;
 
-    double parts = (double) (std::chrono::duration_cast<std::chrono::milliseconds>(length).count()) /
-        (double) (std::chrono::duration_cast<std::chrono::milliseconds>(max_duration).count());
-    int parts_cnt = ceil(parts);
-    spdlog::debug("sentence longer than max duration, %lld >= %lld, splitting into %d parts (src %f)",
-        std::chrono::duration_cast<std::chrono::milliseconds>(length).count(),
-        std::chrono::duration_cast<std::chrono::milliseconds>(max_duration).count(), parts_cnt, parts);
+    void finish(const std::shared_ptr<OutputCaptionResult> &held_nonfinal_result) {
+        if (is_subtitle) {
+            if (held_nonfinal_result)
+                cues.add(*held_nonfinal_result, sink);
+            cues.finish(sink);
+        } else if (format == "txt" || format == "txt_plain") {
+            if (held_nonfinal_result)
+                write_result_simple(*held_nonfinal_result, format == "txt" ? "    " : "", format == "txt");
+        }
 
-    if (parts_cnt <= 1) {
-//        printf("split_res parts_cnt <= 1, no point: %d\n", parts_cnt);
-        results.emplace_back(start, end, full_text, true);
-        return;
+        // end of session, make sure it's all on disk
+        if (segmenter)
+            segmenter->finish(std::chrono::steady_clock::now(), sink);
+        else
+            sink.close();
+        journal.close();
     }
 
-    QString qtext = QString::fromStdString(full_text).simplified();
-    QStringList qwords = qtext.split(QRegExp("\\s+"));
-    std::vector<std::string> words;
-    for (int i = 0; i < qwords.size(); i++)
-        words.push_back(qwords.at(i).toStdString());
-
-    std::vector<std::vector<std::string>> word_vecs;
-    split_vec(word_vecs, words, parts_cnt);
-
-    MonoDur part_duration = length / parts_cnt;
-    int cnt = 0;
-    for (const auto &word_vec: word_vecs) {
-        std::string line;
-        join_strings(word_vec, " ", line);
-        if (!line.empty()) {
-            MonoDur part_start = part_duration * cnt;
-            MonoDur part_end = part_duration * (cnt + 1);
-            results.emplace_back(start + part_start, start + part_end, line, cnt == 0);
-        }
-        cnt++;
+    std::chrono::steady_clock::time_point wake_at() const {
+        if (format == "journal")
+            return journal.flush_due_at();
+        auto wake_at = std::min(sink.flush_due_at(), cues.cue_due_at());
+        if (segmenter)
+            wake_at = std::min(wake_at, segmenter->due_at(sink));
+        return wake_at;
     }
-}
 
-void add_result(SrtState &settings, ResultQueue &results, std::shared_ptr<OutputCaptionResult> output_res) {
-    std::string text = output_res->clean_caption_text;
-    string_capitalization(text, settings.capitalization);
+    // writes out a finished cue and flushes the file once due
+    bool on_wake(const MonoTP &now) {
+        if (format == "journal")
+            return journal.flush_due_at() > now || journal.flush();
 
-    bool split = false;
-    if (settings.split_sentence) {
-        std::chrono::steady_clock::duration length = output_res->caption_result.received_at - output_res->caption_result.first_received_at;
-        split = length > settings.max_entry_duration;
-    }
+        cues.emit_due(now, sink);
+        if (!roll_segment_if_due(now))
+            return false;
 
-    if (!split) {
-        results.emplace_back(output_res->caption_result.first_received_at, output_res->caption_result.received_at, text, true);
-        return;
+        if (sink.flush_due_at() <= now)
+            sink.flush();
+        return !sink.failed();
     }
+};
 
-//    auto before = results.size();
-    split_res(output_res->caption_result.first_received_at, output_res->caption_result.received_at,
-        text, settings.max_entry_duration, results);
-
-//    int cnt = 0;
-//    printf("added lines: %lu\n", results.size() - before);
-//    for (int i = before; i < results.size(); i++) {
-//        const auto &res = results[i];
-//        printf("line %d:  %lld -> %lld: '%s' \n", cnt++,
-//               std::chrono::duration_cast<std::chrono::milliseconds>(std::get<0>(res) - settings.transcript_started_at).count(),
-//               std::chrono::duration_cast<std::chrono::milliseconds>(std::get<1>(res) - settings.transcript_started_at).count(),
-//               std::get<2>(res).c_str()
-//        );
-//    }
-}
+/*
+ Writes the transcript files of one output (stream, recording or virtualcam), run by the OutputExecutor.
+ start() picks and opens a file per format, every caption is checked once and then handed to each format as
+ it comes in, finish() flushes whatever was still held back when the output stopped. A format whose file
+ fails is dropped without stopping the others.
+
+ Live transcripts also log every result to a TranscriptWal as it's queued for them, so recover_interrupted_transcripts()
+ can finish their files if OBS crashes or exits before the results got written or finish() ran.
+
+ Also used by export_caption_journal() to turn a caption journal into any of the other formats afterwards,
+ with open_export() instead of start() and the journaled receive times as the clock.
+*/
+class TranscriptOutputHandler : public CaptionOutputHandler {
+    const std::string target_name;
+    const TranscriptOutputSettings transcript_settings;
+    const std::chrono::system_clock::time_point started_at_sys;
+    const std::chrono::steady_clock::time_point started_at_steady;
+
+    SrtState srt_state;
+    TranscriptSegmentCompressor *segment_compressor;
+    std::vector<std::unique_ptr<TranscriptFormatWriter>> writers;
+    std::shared_ptr<OutputCaptionResult> held_nonfinal_result;
 
-void write_loop_srt(SrtState &settings, std::fstream &fs,
-    std::shared_ptr<CaptionOutputControl<TranscriptOutputSettings>> control) {
+    // journal() appends on the thread queueing the results, the executor thread syncs
+    mutable std::mutex wal_mutex;
+    bool wal_enabled = false;
+    // results queued before start() opened the WAL, appended once it's open
+    bool wal_opening = false;
+    std::vector<std::shared_ptr<OutputCaptionResult>> wal_pending;
+    std::unique_ptr<TranscriptWal> wal;
+    // out of time at shutdown, the files are left as they are and get rewritten from the WAL on the next start
+    bool left_for_recovery = false;
+
+    std::unique_ptr<TranscriptFormatWriter> open_file(const std::string &format, bool extra_format) {
+        const std::string &to_what = target_name;
+
+        UseTranscriptSettings use_settings;
+        try {
+            use_settings = build_use_settings(transcript_settings, target_name);
+        } catch (string ex) {
+            spdlog::error("transcript_writer_loop startup failed: {} {}", to_what.c_str(), ex.c_str());
+            return nullptr;
+        } catch (...) {
+            spdlog::error("transcript_writer_loop startup failed: {}", to_what.c_str());
+            return nullptr;
+        }
 
-    std::shared_ptr<OutputCaptionResult> held_nonfinal_result;
-    CaptionOutput caption_output;
-    ResultQueue results;
+        if (!TranscriptFormatWriter::valid_format(format)) {
+            spdlog::error("transcript_writer_loop {} error, invalid format: {}", to_what.c_str(), format.c_str());
+            return nullptr;
+        }
 
-    while (!control->stop) {
-        control->caption_queue.wait_dequeue(caption_output);
+        spdlog::info("transcript_writer_loop {} starting, format: {}", to_what.c_str(), format.c_str());
 
-        if (control->stop)
-            break;
+        QFileInfo output_directory(QString::fromStdString(transcript_settings.output_path));
+        if (!output_directory.exists()) {
+            spdlog::error("transcript_writer_loop {} error, output dir not found: {}", to_what.c_str(), transcript_settings.output_path.c_str());
+            return nullptr;
+        }
+        if (!output_directory.isDir()) {
+            spdlog::error("transcript_writer_loop {} error, output dir not a directory: {}", to_what.c_str(), transcript_settings.output_path.c_str());
+            return nullptr;
+        }
 
-        if (!caption_output.output_result || caption_output.is_clearance) {
-            continue;
+        QString transcript_file;
+        bool overwrite_file = false;
+        try {
+            transcript_file = find_transcript_filename(transcript_settings, use_settings, output_directory, target_name,
+                                                       format, extra_format, started_at_sys, 100, overwrite_file).absoluteFilePath();
+            spdlog::info("using transcript output file: '{}', overwrite existing: {}", transcript_file.toStdString().c_str(), overwrite_file);
+        }
+        catch (std::string &err) {
+            spdlog::error("transcript_writer_loop find_transcript_filename error: {}", err.c_str());
+            return nullptr;
+        }
+        catch (...) {
+            spdlog::error("transcript_writer_loop {} error, couldn't get an output filepath", to_what.c_str());
+            return nullptr;
         }
 
-        held_nonfinal_result = nullptr;
-        if (!relevant_result(settings, caption_output))
-            continue;
+        // an interrupted transcript in the same file gets finished first, this one goes after it
+        wait_for_transcript_recovery_of(transcript_file);
+
+        auto writer = std::make_unique<TranscriptFormatWriter>(format, started_at_steady, srt_state);
+        writer->set_segmenter(std::make_unique<TranscriptSegmenter>(
+            TranscriptSegmentSettings{
+                transcript_settings.segment_minutes,
+                transcript_settings.segment_megabytes,
+                transcript_settings.segment_compress
+            }, started_at_steady, started_at_sys, segment_compressor));
+        if (!writer->open(transcript_file, overwrite_file, started_at_sys))
+            return nullptr;
+        return writer;
+    }
+
+    // once the files are open, a crash from here on gets recovered on the next start.
+    // Journals are crash safe already and don't need it. wal_mutex held
+    void open_wal() {
+        TranscriptWalSession session;
+        session.target_name = target_name;
+        session.started_at_unix_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            started_at_sys.time_since_epoch()).count();
+        session.srt_target_duration_secs = transcript_settings.srt_target_duration_secs;
+        session.srt_target_line_length = transcript_settings.srt_target_line_length;
+        session.srt_add_punctuation = transcript_settings.srt_add_punctuation;
+        session.srt_split_single_sentences = transcript_settings.srt_split_single_sentences;
+        session.srt_capitalization = transcript_settings.srt_capitalization;
+        for (const auto &writer: writers) {
+            if (writer->get_format() != "journal")
+                session.files.push_back(writer->get_wal_file());
+        }
+        if (session.files.empty())
+            return;
 
-        if (caption_output.output_result->caption_result.final) {
-            add_result(settings, results, caption_output.output_result);
+        const QString directory = transcript_wal_directory();
+        if (directory.isEmpty()) {
+            spdlog::warn("transcript_writer_loop {}: no write-ahead log, transcript can't be recovered after a crash", target_name);
+            return;
+        }
 
-            if (!write_transcript_caption_results_srt(settings, fs, results, false)) {
-                return;
-            }
-        } else {
-            held_nonfinal_result = caption_output.output_result;
+        wal = std::make_unique<TranscriptWal>(started_at_steady);
+        if (!wal->open(directory, session)) {
+            spdlog::warn("transcript_writer_loop {}: no write-ahead log, transcript can't be recovered after a crash", target_name);
+            wal->remove();
+            wal = nullptr;
         }
     }
 
-    if (held_nonfinal_result) {
-        add_result(settings, results, held_nonfinal_result);
-        held_nonfinal_result = nullptr;
+    // wal_mutex held
+    void sync_wal() {
+        if (wal && !wal->sync()) {
+            spdlog::error("transcript_writer_loop {}: write-ahead log failed, continuing without it", target_name);
+            wal->remove();
+            wal = nullptr;
+        }
     }
 
-    if (!results.empty()) {
-        if (!write_transcript_caption_results_srt(settings, fs, results, true)) {
-            return;
+public:
+    // segment_compressor: compresses finished segments if the transcript gets split, can be null
+    TranscriptOutputHandler(const string &target_name, const TranscriptOutputSettings &transcript_settings,
+                            TranscriptSegmentCompressor *segment_compressor) :
+            TranscriptOutputHandler(target_name, transcript_settings, std::chrono::steady_clock::now(), segment_compressor) {
+        wal_enabled = true;
+        wal_opening = true;
+    }
+
+    TranscriptOutputHandler(const string &target_name, const TranscriptOutputSettings &transcript_settings,
+                            const MonoTP &started_at_steady, TranscriptSegmentCompressor *segment_compressor = nullptr) :
+            target_name(target_name),
+            transcript_settings(transcript_settings),
+            started_at_sys(std::chrono::system_clock::now()),
+            started_at_steady(started_at_steady),
+            srt_state(SrtState{
+                started_at_steady,
+                std::chrono::seconds(transcript_settings.srt_target_duration_secs ? transcript_settings.srt_target_duration_secs : 1),
+                transcript_settings.srt_target_line_length,
+                transcript_settings.srt_add_punctuation,
+                transcript_settings.srt_split_single_sentences,
+                transcript_settings.srt_capitalization, 1250
+            }),
+            segment_compressor(segment_compressor) {}
+
+    void start() override {
+        // one after the other, so with generated names formats sharing an extension get numbered ones instead of
+        // the same file. Custom names have a distinct suffix per format instead
+        bool extra_format = false;
+        for (const auto &format: transcript_settings.formats()) {
+            try {
+                auto writer = open_file(format, extra_format);
+                if (writer)
+                    writers.push_back(std::move(writer));
+            }
+            catch (std::exception &ex) {
+                spdlog::error("transcript_writer_loop {} {} error {}", target_name.c_str(), format.c_str(), ex.what());
+            }
+            extra_format = true;
         }
-    }
-}
 
-void write_transcript_caption_simple(std::fstream &fs,
-    const string &prefix,
-    const std::chrono::steady_clock::time_point &started_at,
-    const OutputCaptionResult &result,
-    const bool add_timestamps) {
+        std::lock_guard<std::mutex> lock(wal_mutex);
+        if (wal_enabled && !writers.empty())
+            open_wal();
 
-    std::ostringstream comb;
-    if (add_timestamps) {
-        int start_offset_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-            result.caption_result.first_received_at - started_at).count();
+        if (wal) {
+            for (const auto &result: wal_pending)
+                wal->append(*result);
+        }
+        wal_opening = false;
+        wal_pending.clear();
 
-        int end_offset_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-            result.caption_result.received_at - started_at).count();
+        if (!writers.empty())
+            spdlog::info("transcript_writer_loop {} writing {} formats", target_name, writers.size());
+    }
 
-        if (start_offset_ms < 0)
-            start_offset_ms = 0;
+    // writes to output_path as is in the main format, for exports
+    bool open_export(const QString &output_path) {
+        const std::string &format = transcript_settings.format;
+        if (!TranscriptFormatWriter::valid_format(format) || format == "journal") {
+            spdlog::error("transcript export error, invalid format: {}", format);
+            return false;
+        }
 
-        if (end_offset_ms < 0)
-            end_offset_ms = 0;
+        auto writer = std::make_unique<TranscriptFormatWriter>(format, started_at_steady, srt_state);
+        if (!writer->open(output_path, true, started_at_sys))
+            return false;
 
-        const std::string start_offset_str = time_duration_stream(start_offset_ms);
-        const std::string end_offset_str = time_duration_stream(end_offset_ms);
-        comb << start_offset_str << "-" << end_offset_str << " ";
-    }
+        writers.push_back(std::move(writer));
+        return true;
+    }
+
+    // the files of an interrupted session, each cut back to where the session started so it can be written again
+    bool open_recovery(const TranscriptWalSession &session) {
+        for (const auto &file: session.files) {
+            if (!TranscriptFormatWriter::valid_format(file.format) || file.format == "journal")
+                continue;
+
+            QString path = file.path;
+            bool overwrite = file.start_offset == 0;
+            if (file.segmented) {
+                // the segments closed before the crash stay as they are, the whole session goes next to them
+                const QFileInfo base(file.path);
+                const QString suffix = base.suffix().isEmpty()
+                    ? QString::fromStdString(transcript_format_extension(file.format, "txt")) : base.suffix();
+                try {
+                    path = find_unused_filename(QFileInfo(base.absolutePath()), base.completeBaseName() + "_recovered",
+                                                suffix, 100).absoluteFilePath();
+                } catch (...) {
+                    spdlog::error("transcript recovery: no free name for '{}'", file.path.toStdString());
+                    continue;
+                }
+                overwrite = true;
+            } else if (!overwrite && (QFileInfo(path).size() < file.start_offset || !QFile::resize(path, file.start_offset))) {
+                spdlog::error("transcript recovery: couldn't cut '{}' back to {} bytes", path.toStdString(), file.start_offset);
+                continue;
+            }
 
-    if (!prefix.empty())
-        comb << prefix;
+            auto writer = std::make_unique<TranscriptFormatWriter>(file.format, started_at_steady, srt_state);
+            if (!writer->open(path, overwrite, started_at_sys))
+                continue;
 
-    comb << result.clean_caption_text << std::endl;
-    fs_write_string(fs, comb.str());
-}
+            spdlog::info("transcript recovery: rewriting '{}'", path.toStdString());
+            writers.push_back(std::move(writer));
+        }
+        return !writers.empty();
+    }
 
-void write_loop_txt(SrtState &settings, std::fstream &fs, const std::chrono::steady_clock::time_point &started_at_steady,
-    std::shared_ptr<CaptionOutputControl<TranscriptOutputSettings>> control,
-    const bool add_timestamps, const bool add_spacer) {
+    // now: when the caption was output, srt batching depends on it
+    bool write(const CaptionOutput &caption_output, const MonoTP &now) {
+        if (writers.empty() || !caption_output.output_result || caption_output.is_clearance)
+            return !writers.empty();
 
-    std::shared_ptr<OutputCaptionResult> held_nonfinal_caption_result;
-    CaptionOutput caption_output;
-    const std::string prefix(add_spacer ? "    " : "");
+        S2T_TRACE_SPAN("transcript write");
+        const auto &result = caption_output.output_result;
+        const bool relevant = relevant_result(srt_state, caption_output);
 
-    while (!control->stop) {
-        control->caption_queue.wait_dequeue(caption_output);
+        held_nonfinal_result = nullptr;
+        if (relevant && !result->caption_result.final)
+            held_nonfinal_result = result;
 
-        if (control->stop)
-            break;
+        for (auto it = writers.begin(); it != writers.end();) {
+            if ((*it)->write(result, relevant, now)) {
+                ++it;
+                continue;
+            }
 
-        if (!caption_output.output_result || caption_output.is_clearance) {
-//            debug_log("got empty CaptionOutput.output_result???");
-            continue;
+            spdlog::error("transcript_writer_loop {} {} failed, stopping that format", target_name, (*it)->get_format());
+            (*it)->finish(nullptr);
+            it = writers.erase(it);
         }
+        return !writers.empty();
+    }
 
-        held_nonfinal_caption_result = nullptr;
-        if (!relevant_result(settings, caption_output))
-            continue;
+    void on_caption_output(const CaptionOutput &caption_output) override {
+        write(caption_output, std::chrono::steady_clock::now());
+    }
 
-        if (caption_output.output_result->caption_result.final) {
-            write_transcript_caption_simple(fs, prefix, started_at_steady, *caption_output.output_result, add_timestamps);
-            if (fs.fail()) {
-                spdlog::error("transcript_writer_loop_txt error, write failed: '%s'", strerror(errno));
-                return;
-            }
-        } else {
-            held_nonfinal_caption_result = caption_output.output_result;
-        }
+    // only with a working WAL, everything queued is in it then
+    bool skip_at_shutdown() override {
+        std::lock_guard<std::mutex> lock(wal_mutex);
+        if (!wal || wal->failed() || !wal->sync())
+            return false;
+
+        left_for_recovery = true;
+        return true;
     }
 
-    if (held_nonfinal_caption_result) {
-        write_transcript_caption_simple(fs, prefix, started_at_steady, *held_nonfinal_caption_result, add_timestamps);
-        if (fs.fail()) {
-            spdlog::error("transcript_writer_loop_txt error, write failed: '%s'", strerror(errno));
+    // before it's queued, what's still waiting for write() when OBS goes down is in the WAL already
+    void journal(const CaptionOutput &caption_output) override {
+        if (!caption_output.output_result || caption_output.is_clearance)
             return;
+
+        std::lock_guard<std::mutex> lock(wal_mutex);
+        if (wal)
+            wal->append(*caption_output.output_result);
+        else if (wal_opening)
+            wal_pending.push_back(caption_output.output_result);
+    }
+
+    std::chrono::steady_clock::time_point wake_at() const override {
+        auto wake_at = std::chrono::steady_clock::time_point::max();
+        for (const auto &writer: writers)
+            wake_at = std::min(wake_at, writer->wake_at());
+        std::lock_guard<std::mutex> lock(wal_mutex);
+        if (wal)
+            wake_at = std::min(wake_at, wal->sync_due_at());
+        return wake_at;
+    }
+
+    void on_wake() override {
+        const auto now = std::chrono::steady_clock::now();
+        {
+            std::lock_guard<std::mutex> lock(wal_mutex);
+            if (wal && wal->sync_due_at() <= now)
+                sync_wal();
         }
-    }
-    held_nonfinal_caption_result = nullptr;
-}
 
-void write_loop_raw(std::fstream &fs, const std::chrono::steady_clock::time_point &started_at_steady,
-    std::shared_ptr<CaptionOutputControl<TranscriptOutputSettings>> control) {
+        for (auto it = writers.begin(); it != writers.end();) {
+            if ((*it)->on_wake(now)) {
+                ++it;
+                continue;
+            }
 
-    CaptionOutput caption_output;
-    while (!control->stop) {
-        control->caption_queue.wait_dequeue(caption_output);
+            spdlog::error("transcript_writer_loop {} {} write failed, stopping that format", target_name, (*it)->get_format());
+            it = writers.erase(it);
+        }
+    }
 
-        if (control->stop)
-            break;
+    void finish() override {
+        if (writers.empty())
+            return;
 
-        if (!caption_output.output_result || caption_output.is_clearance) {
-//            spdlog::info("got empty CaptionOutput.output_result???");
-            continue;
+        if (left_for_recovery) {
+            writers.clear();
+            std::lock_guard<std::mutex> lock(wal_mutex);
+            wal->close();
+            wal = nullptr;
+            spdlog::warn("transcript_writer_loop {} out of time, left for recovery on the next start", target_name);
+            return;
         }
 
-        string prefix;
-        if (caption_output.output_result->interrupted && caption_output.output_result->caption_result.final)
-            prefix = "IF    ";
-        else if (caption_output.output_result->interrupted)
-            prefix = "I    ";
-        else if (caption_output.output_result->caption_result.final)
-            prefix = "F    ";
-        else
-            prefix = "    ";
+        for (auto &writer: writers)
+            writer->finish(held_nonfinal_result);
 
-        write_transcript_caption_simple(fs, prefix, started_at_steady, *caption_output.output_result, true);
-        if (fs.fail()) {
-            spdlog::error("transcript_writer_loop_raw error, write failed: '%s'", strerror(errno));
-            return;
+        held_nonfinal_result = nullptr;
+        writers.clear();
+
+        // the files are complete and on disk, nothing left to recover
+        std::lock_guard<std::mutex> lock(wal_mutex);
+        if (wal) {
+            wal->remove();
+            wal = nullptr;
         }
+        spdlog::info("transcript_writer_loop {} done", target_name);
+    }
+};
+
+/*
+ Writes the results of a caption journal received within [from_ms, to_ms] as a transcript in settings.format,
+ timestamps relative to from_ms. Goes through the same TranscriptOutputHandler as live transcripts so the output
+ is what it would have been had that format been picked while recording.
+*/
+// feeds the reader's records received up to to_ms to the handler, with their journaled receive times as the clock
+static bool replay_caption_journal(CaptionJournalReader &reader, TranscriptOutputHandler &handler,
+                                   const MonoTP &journal_started_at, int64_t to_ms, uint64_t &replayed) {
+    CaptionJournalRecord record;
+    while (reader.next(record) && record.received_ms <= to_ms) {
+        auto caption_result = std::make_shared<const RawResult>(
+            record.index, record.final, record.stability, std::move(record.caption_text), "",
+            journal_started_at + std::chrono::milliseconds(record.first_received_ms),
+            journal_started_at + std::chrono::milliseconds(record.received_ms));
+
+        auto output_result = std::make_shared<OutputCaptionResult>(caption_result, record.interrupted);
+        output_result->clean_caption_text = std::move(record.clean_caption_text);
+        output_result->output_line = std::move(record.output_line);
+
+        if (!handler.write(CaptionOutput(output_result, false), caption_result->received_at))
+            return false;
+        replayed++;
     }
+    return true;
 }
 
-void transcript_writer_loop(std::shared_ptr<CaptionOutputControl<TranscriptOutputSettings>> control,
-    const string target_name, const TranscriptOutputSettings transcript_settings) {
+bool export_caption_journal(const QString &journal_path, const QString &output_path,
+                            const TranscriptOutputSettings &settings, int64_t from_ms = 0, int64_t to_ms = INT64_MAX) {
+    CaptionJournalReader reader;
+    if (!reader.open(journal_path) || !reader.seek(from_ms))
+        return false;
 
-    const std::string format = transcript_settings.format;
-    auto started_at_sys = std::chrono::system_clock::now();
-    auto started_at_steady = std::chrono::steady_clock::now();
-    const std::string to_what = target_name;
+    const MonoTP journal_started_at;
+    TranscriptOutputHandler handler("export", settings, journal_started_at + std::chrono::milliseconds(from_ms));
+    if (!handler.open_export(output_path))
+        return false;
 
-    UseTranscriptSettings use_settings;
-    try {
-        use_settings = build_use_settings(transcript_settings, target_name);
-    } catch (string ex) {
-        spdlog::error("transcript_writer_loop startup failed: %s %s", to_what.c_str(), ex.c_str());
-        return;
-    } catch (...) {
-        spdlog::error("transcript_writer_loop startup failed: %s", to_what.c_str());
-        return;
-    }
+    uint64_t exported = 0;
+    if (!replay_caption_journal(reader, handler, journal_started_at, to_ms, exported))
+        return false;
 
-    if (format != "txt" && format != "txt_plain" && format != "srt" && format != "raw") {
-        spdlog::error("transcript_writer_loop %s error, invalid format: %s", to_what.c_str(), format.c_str());
-        return;
-    }
+    handler.finish();
+    spdlog::info("exported {} journaled results from '{}' to '{}'", exported, journal_path.toStdString(), output_path.toStdString());
+    return true;
+}
 
-    spdlog::info("transcript_writer_loop %s starting, format: %s", to_what.c_str(), format.c_str());
+static bool recover_transcript_session(const TranscriptWalSession &session) {
+    CaptionJournalReader reader;
+    if (!reader.open(session.journal_path))
+        return false;
 
-    QFileInfo output_directory(QString::fromStdString(control->arg.output_path));
-    if (!output_directory.exists()) {
-        spdlog::error("transcript_writer_loop %s error, output dir not found: %s", to_what.c_str(), control->arg.output_path.c_str());
-        return;
-    }
-    if (!output_directory.isDir()) {
-        spdlog::error("transcript_writer_loop %s error, output dir not a directory: %s", to_what.c_str(), control->arg.output_path.c_str());
-        return;
-    }
+    // only the subtitle settings matter, the files are already picked
+    const TranscriptOutputSettings settings(false, "", "srt", {}, "", "", "", "", "", "", "", "", "",
+                                            session.srt_target_duration_secs, session.srt_target_line_length,
+                                            session.srt_add_punctuation, session.srt_split_single_sentences,
+                                            (CapitalizationType) session.srt_capitalization,
+                                            false, false, false, 0, 0, false);
 
-    QString transcript_file;
-    bool overwrite_file = false;
-    try {
-        transcript_file = find_transcript_filename(transcript_settings, use_settings, output_directory, target_name, started_at_sys, 100, overwrite_file).absoluteFilePath();
-        spdlog::info("using transcript output file: '%s', overwrite existing: %d", transcript_file.toStdString().c_str(), overwrite_file);
-    }
-    catch (std::string &err) {
-        spdlog::error("transcript_writer_loop find_transcript_filename error: %s", err.c_str());
-        return;
-    }
-    catch (...) {
-        spdlog::error("transcript_writer_loop %s error, couldn't get an output filepath", to_what.c_str());
-        return;
-    }
+    const MonoTP journal_started_at;
+    TranscriptOutputHandler handler(session.target_name, settings, journal_started_at);
+    if (!handler.open_recovery(session))
+        return false;
 
-    try {
-        std::fstream fs;
+    uint64_t replayed = 0;
+    if (!replay_caption_journal(reader, handler, journal_started_at, INT64_MAX, replayed))
+        return false;
 
-#if _WIN32
-        fs.open(transcript_file.toStdWString(), std::fstream::out | std::ios::binary | (overwrite_file ? std::fstream::trunc : std::fstream::app));
-#else
-        fs.open(transcript_file.toStdString(),
-            std::fstream::out | std::ios::binary | (overwrite_file ? std::fstream::trunc : std::fstream::app));
-#endif
-        if (fs.fail()) {
-            spdlog::error("transcript_writer_loop %s error, couldn't open file", strerror(errno));
-            return;
-        }
+    handler.finish();
+    spdlog::info("transcript recovery: finished the {} transcript started at {} from {} logged results",
+                 session.target_name, session.started_at_unix_ms, replayed);
+    return true;
+}
 
-        const uint max_duration_secs = transcript_settings.srt_target_duration_secs ? transcript_settings.srt_target_duration_secs : 1;
-        SrtState settings = SrtState{
-            started_at_steady, std::chrono::seconds(max_duration_secs), 1,
-            transcript_settings.srt_target_line_length,
-            transcript_settings.srt_add_punctuation,
-            transcript_settings.srt_split_single_sentences,
-            transcript_settings.srt_capitalization, 1250
-        };
+/*
+ Finishes the transcripts of sessions that were interrupted by a crash, from the write-ahead logs left in
+ wal_directory. Every file is written again from where its session started, so it ends up as if the output had
+ stopped right after the last synced result, held back interims and partial subtitle cues included.
+ A session that can't be recovered keeps its journal, it can still be exported by hand.
+*/
+// stops early when OBS exits, what's left is found again on the next start
+// the sessions' files have to be in begin_transcript_recovery(), each is ended here
+static uint recover_transcript_sessions(const std::vector<TranscriptWalSession> &sessions) {
+    uint recovered = 0;
+    for (size_t i = 0; i < sessions.size(); i++) {
+        const auto &session = sessions[i];
+        if (PluginShutdown::in_progress()) {
+            spdlog::info("transcript recovery: shutting down, leaving the rest for the next start");
+            for (; i < sessions.size(); i++)
+                end_transcript_recovery(sessions[i]);
+            break;
+        }
 
-        spdlog::info("transcript_writer_loop starting write_loop: %s", format.c_str());
-        if (format == "raw")
-            write_loop_raw(fs, started_at_steady, control);
-        else if (format == "txt")
-            write_loop_txt(settings, fs, started_at_steady, control, true, true);
-        else if (format == "txt_plain")
-            write_loop_txt(settings, fs, started_at_steady, control, false, false);
-        else {
-            write_loop_srt(settings, fs, control);
+        spdlog::info("transcript recovery: found interrupted {} transcript '{}'", session.target_name,
+                     session.journal_path.toStdString());
+        if (recover_transcript_session(session)) {
+            remove_transcript_wal_session(session);
+            end_transcript_recovery(session);
+            recovered++;
+            continue;
         }
 
-        fs.close();
-    }
-    catch (std::exception &ex) {
-        spdlog::error("transcript_writer_loop %s error %s", to_what.c_str(), ex.what());
-        return;
-    }
-    catch (...) {
-        spdlog::error("transcript_writer_loop %s error", to_what.c_str());
-        return;
+        spdlog::error("transcript recovery: couldn't recover '{}', keeping its caption journal",
+                      session.journal_path.toStdString());
+        abandon_transcript_wal_session(session);
+        end_transcript_recovery(session);
     }
+    return recovered;
+}
 
-    spdlog::info("transcript_writer_loop %s done", to_what.c_str());
+uint recover_interrupted_transcripts(const QString &wal_directory) {
+    const std::vector<TranscriptWalSession> sessions = find_interrupted_transcript_sessions(wal_directory);
+    begin_transcript_recovery(sessions);
+    return recover_transcript_sessions(sessions);
 }
 
 }
 
-#endif //OBS_SPEECH2TEXT_PLUGIN_TRANSCRIPT_H
\ No newline at end of file
+#endif //OBS_SPEECH2TEXT_PLUGIN_TRANSCRIPT_H
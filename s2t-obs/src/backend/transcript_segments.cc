@@ -0,0 +1,267 @@
+// Copyright 2022 gab
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "transcript_segments.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+
+#include "spdlog/spdlog.h"
+
+#include "shutdown.h"
+#include "trace.h"
+
+namespace backend {
+
+TranscriptSegmentManifest::TranscriptSegmentManifest(const QString &path, const std::string &format) :
+        path(path),
+        format(format) {
+    QFile existing(path);
+    if (!existing.open(QIODevice::ReadOnly))
+        return;
+
+    const QJsonDocument doc = QJsonDocument::fromJson(existing.readAll());
+    if (doc.isObject())
+        earlier_segments = doc.object().value("segments").toArray();
+    else
+        spdlog::warn("transcript segments: replacing unreadable manifest '{}'", path.toStdString());
+}
+
+void TranscriptSegmentManifest::save_locked() {
+    QJsonArray all_segments = earlier_segments;
+    for (const auto &segment: segments) {
+        QJsonObject entry;
+        entry["file"] = segment.file_name;
+        entry["started_at"] = (qint64) segment.started_at_unix_ms;
+        entry["start_ms"] = (qint64) segment.start_ms;
+        entry["end_ms"] = (qint64) segment.end_ms;
+        entry["bytes"] = (qint64) segment.bytes;
+        entry["compression"] = segment.compressed ? TRANSCRIPT_SEGMENT_COMPRESSED_EXTENSION : "none";
+        all_segments.append(entry);
+    }
+
+    QJsonObject root;
+    root["version"] = TRANSCRIPT_SEGMENT_MANIFEST_VERSION;
+    root["format"] = QString::fromStdString(format);
+    root["segments"] = all_segments;
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)
+        || file.write(QJsonDocument(root).toJson()) < 0
+        || !file.commit()) {
+        spdlog::error("transcript segments: couldn't write manifest '{}'", path.toStdString());
+    }
+}
+
+size_t TranscriptSegmentManifest::add(const TranscriptSegment &segment) {
+    std::lock_guard<std::mutex> lock(mutex);
+    segments.push_back(segment);
+    save_locked();
+    return segments.size() - 1;
+}
+
+void TranscriptSegmentManifest::set_compressed(size_t segment_id, const QString &file_name, uint64_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (segment_id >= segments.size())
+        return;
+
+    segments[segment_id].file_name = file_name;
+    segments[segment_id].bytes = bytes;
+    segments[segment_id].compressed = true;
+    save_locked();
+}
+
+static bool compress_segment(const QString &path, QString &compressed_path, uint64_t &compressed_bytes) {
+    QFile input(path);
+    if (!input.open(QIODevice::ReadOnly))
+        return false;
+
+    const QByteArray compressed = qCompress(input.readAll(), 9);
+    input.close();
+    if (compressed.size() < 4)
+        return false;
+
+    // qCompress puts the uncompressed size in front of the zlib stream, leave it out so it's plain zlib
+    compressed_path = path + "." TRANSCRIPT_SEGMENT_COMPRESSED_EXTENSION;
+    QSaveFile output(compressed_path);
+    if (!output.open(QIODevice::WriteOnly)
+        || output.write(compressed.constData() + 4, compressed.size() - 4) != compressed.size() - 4
+        || !output.commit()) {
+        return false;
+    }
+
+    compressed_bytes = compressed.size() - 4;
+    return QFile::remove(path);
+}
+
+void TranscriptSegmentCompressor::run() {
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(jobs_mutex);
+            jobs_cv.wait(lock, [this]() { return stopping || !jobs.empty(); });
+            if (jobs.empty())
+                return;
+
+            // still there next time, only not compressed
+            if (stopping && PluginShutdown::past_deadline()) {
+                spdlog::warn("transcript segments: shutdown deadline passed, leaving {} segments uncompressed", jobs.size());
+                jobs.clear();
+                return;
+            }
+
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+
+        S2T_TRACE_SPAN("transcript segment compress");
+        QString compressed_path;
+        uint64_t compressed_bytes = 0;
+        if (!compress_segment(job.path, compressed_path, compressed_bytes)) {
+            spdlog::error("transcript segments: couldn't compress '{}'", job.path.toStdString());
+            continue;
+        }
+
+        job.manifest->set_compressed(job.segment_id, QFileInfo(compressed_path).fileName(), compressed_bytes);
+        spdlog::debug("transcript segments: compressed '{}', {} bytes", job.path.toStdString(), compressed_bytes);
+    }
+}
+
+void TranscriptSegmentCompressor::compress(const QString &path, std::shared_ptr<TranscriptSegmentManifest> manifest,
+                                           size_t segment_id) {
+    std::lock_guard<std::mutex> lock(jobs_mutex);
+    if (stopping)
+        return;
+
+    jobs.push_back(Job{path, std::move(manifest), segment_id});
+    if (!thread.joinable())
+        thread = WorkerThread("s2t compressor", WORKER_ROLE_DISK_IO, [this]() { run(); });
+    jobs_cv.notify_one();
+}
+
+void TranscriptSegmentCompressor::stop() {
+    {
+        std::lock_guard<std::mutex> lock(jobs_mutex);
+        stopping = true;
+    }
+    jobs_cv.notify_one();
+
+    thread.join();
+}
+
+TranscriptSegmentCompressor::~TranscriptSegmentCompressor() {
+    stop();
+}
+
+TranscriptSegmenter::TranscriptSegmenter(const TranscriptSegmentSettings &settings,
+                                         const std::chrono::steady_clock::time_point &transcript_started_at,
+                                         const std::chrono::system_clock::time_point &transcript_started_at_sys,
+                                         TranscriptSegmentCompressor *compressor) :
+        settings(settings),
+        transcript_started_at(transcript_started_at),
+        transcript_started_at_sys(transcript_started_at_sys),
+        compressor(compressor) {}
+
+QString TranscriptSegmenter::next_segment_path() {
+    // never overwrites, also not a segment that got compressed already
+    while (true) {
+        segment_number++;
+        QString file_name = QString("%1_%2").arg(base_name).arg(segment_number, 3, 10, QChar('0'));
+        if (!suffix.isEmpty())
+            file_name += "." + suffix;
+
+        const QString path = QDir(directory).absoluteFilePath(file_name);
+        if (!QFileInfo::exists(path) && !QFileInfo::exists(path + "." TRANSCRIPT_SEGMENT_COMPRESSED_EXTENSION))
+            return path;
+    }
+}
+
+QString TranscriptSegmenter::begin(const QString &base_path, const std::string &format,
+                                   const std::chrono::steady_clock::time_point &now) {
+    const QFileInfo base(base_path);
+    directory = base.absolutePath();
+    base_name = base.completeBaseName();
+    suffix = base.suffix();
+    // one per format, formats writing next to the same base name would overwrite each other's entries otherwise
+    manifest = std::make_shared<TranscriptSegmentManifest>(
+        QDir(directory).absoluteFilePath(base_name + "." + QString::fromStdString(format) + ".segments.json"), format);
+
+    segment_path = next_segment_path();
+    segment_started_at = now;
+    segment_header_bytes = 0;
+    return segment_path;
+}
+
+std::chrono::steady_clock::time_point TranscriptSegmenter::due_at(const TranscriptSink &sink) const {
+    // an empty segment never rolls over, the first entry after its time is up does it
+    if (!settings.max_minutes || segment_path.isEmpty() || segment_empty(sink))
+        return std::chrono::steady_clock::time_point::max();
+
+    return segment_started_at + std::chrono::minutes(settings.max_minutes);
+}
+
+bool TranscriptSegmenter::due(const std::chrono::steady_clock::time_point &now, const TranscriptSink &sink) const {
+    if (segment_path.isEmpty() || segment_empty(sink))
+        return false;
+
+    if (settings.max_megabytes && sink.size() >= (uint64_t) settings.max_megabytes * 1024 * 1024)
+        return true;
+
+    return now >= due_at(sink);
+}
+
+void TranscriptSegmenter::close_segment(const std::chrono::steady_clock::time_point &now, TranscriptSink &sink) {
+    const uint64_t bytes = sink.size();
+    sink.close();
+
+    const auto since_start = [this](const std::chrono::steady_clock::time_point &at) {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(at - transcript_started_at).count();
+    };
+
+    TranscriptSegment segment;
+    segment.file_name = QFileInfo(segment_path).fileName();
+    segment.started_at_unix_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        transcript_started_at_sys.time_since_epoch()).count() + since_start(segment_started_at);
+    segment.start_ms = since_start(segment_started_at);
+    segment.end_ms = since_start(now);
+    segment.bytes = bytes;
+
+    const size_t segment_id = manifest->add(segment);
+    if (compressor && settings.compress && bytes)
+        compressor->compress(segment_path, manifest, segment_id);
+}
+
+QString TranscriptSegmenter::next(const std::chrono::steady_clock::time_point &now, TranscriptSink &sink) {
+    close_segment(now, sink);
+
+    segment_path = next_segment_path();
+    segment_started_at = now;
+    segment_header_bytes = 0;
+    spdlog::info("transcript segments: continuing in '{}'", segment_path.toStdString());
+    return segment_path;
+}
+
+void TranscriptSegmenter::finish(const std::chrono::steady_clock::time_point &now, TranscriptSink &sink) {
+    if (segment_path.isEmpty())
+        return;
+
+    close_segment(now, sink);
+    segment_path.clear();
+}
+
+}
@@ -0,0 +1,167 @@
+// Copyright 2022 gab
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef OBS_SPEECH2TEXT_PLUGIN_TRANSCRIPT_SEGMENTS_H
+#define OBS_SPEECH2TEXT_PLUGIN_TRANSCRIPT_SEGMENTS_H
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <QJsonArray>
+#include <QString>
+
+#include "transcript_sink.h"
+#include "worker_runtime.h"
+
+namespace backend {
+
+#define TRANSCRIPT_SEGMENT_MANIFEST_VERSION 1
+#define TRANSCRIPT_SEGMENT_COMPRESSED_EXTENSION "zlib"
+
+struct TranscriptSegmentSettings {
+    uint max_minutes = 0;       // 0: no time limit
+    uint max_megabytes = 0;     // 0: no size limit
+    bool compress = false;
+};
+
+struct TranscriptSegment {
+    QString file_name;              // relative to the manifest
+    int64_t started_at_unix_ms = 0;
+    int64_t start_ms = 0;           // since the transcript started, same as the timestamps in it
+    int64_t end_ms = 0;
+    uint64_t bytes = 0;
+    bool compressed = false;
+};
+
+/*
+ "[transcript].[format].segments.json" next to the segments, lists every closed segment with its time range.
+ Segments of earlier sessions already in it are kept. Saved through QSaveFile so readers never see half of it,
+ the writer and the compressor thread both update it.
+*/
+class TranscriptSegmentManifest {
+    std::mutex mutex;
+    const QString path;
+    const std::string format;
+
+    QJsonArray earlier_segments;
+    std::vector<TranscriptSegment> segments;
+
+    void save_locked();
+
+public:
+    TranscriptSegmentManifest(const QString &path, const std::string &format);
+
+    // returns the id to update it with
+    size_t add(const TranscriptSegment &segment);
+
+    void set_compressed(size_t segment_id, const QString &file_name, uint64_t bytes);
+};
+
+/*
+ Compresses closed transcript segments with zlib (qCompress without its length prefix, so it's a plain zlib stream)
+ on one disk I/O worker thread, started with the first segment. Replaces "[segment]" by "[segment].zlib".
+*/
+class TranscriptSegmentCompressor {
+    struct Job {
+        QString path;
+        std::shared_ptr<TranscriptSegmentManifest> manifest;
+        size_t segment_id;
+    };
+
+    std::mutex jobs_mutex;
+    std::condition_variable jobs_cv;
+    std::deque<Job> jobs;
+    bool stopping = false;
+
+    WorkerThread thread;
+
+    void run();
+
+public:
+    void compress(const QString &path, std::shared_ptr<TranscriptSegmentManifest> manifest, size_t segment_id);
+
+    // compresses what's still queued and joins the thread
+    void stop();
+
+    ~TranscriptSegmentCompressor();
+};
+
+/*
+ Rolls one transcript file over into numbered segments, "[name]_001.[ext]", "[name]_002.[ext]", ...
+ once a segment reached max_minutes or max_megabytes. Closed segments go into the manifest and to the compressor.
+ The format writer owning the sink decides when an entry is complete and calls next() between entries.
+*/
+class TranscriptSegmenter {
+    const TranscriptSegmentSettings settings;
+    const std::chrono::steady_clock::time_point transcript_started_at;
+    const std::chrono::system_clock::time_point transcript_started_at_sys;
+    TranscriptSegmentCompressor *compressor;
+
+    QString directory;
+    QString base_name;
+    QString suffix;
+    std::shared_ptr<TranscriptSegmentManifest> manifest;
+
+    uint segment_number = 0;
+    QString segment_path;
+    std::chrono::steady_clock::time_point segment_started_at;
+    uint64_t segment_header_bytes = 0;
+
+    QString next_segment_path();
+
+    // nothing but the header in it
+    bool segment_empty(const TranscriptSink &sink) const {
+        return sink.size() <= segment_header_bytes;
+    }
+
+    void close_segment(const std::chrono::steady_clock::time_point &now, TranscriptSink &sink);
+
+public:
+    // compressor can be null, segments stay uncompressed then
+    TranscriptSegmenter(const TranscriptSegmentSettings &settings,
+                        const std::chrono::steady_clock::time_point &transcript_started_at,
+                        const std::chrono::system_clock::time_point &transcript_started_at_sys,
+                        TranscriptSegmentCompressor *compressor);
+
+    bool enabled() const {
+        return settings.max_minutes || settings.max_megabytes;
+    }
+
+    // base_path: file the whole transcript would have gone to, returns the first segment's
+    QString begin(const QString &base_path, const std::string &format, const std::chrono::steady_clock::time_point &now);
+
+    // call once the file header (WebVTT) of a new segment is in the sink, it doesn't count as content
+    void header_written(const TranscriptSink &sink) {
+        segment_header_bytes = sink.size();
+    }
+
+    // when the time limit is up, time_point::max() without one or while the segment is still empty
+    std::chrono::steady_clock::time_point due_at(const TranscriptSink &sink) const;
+
+    bool due(const std::chrono::steady_clock::time_point &now, const TranscriptSink &sink) const;
+
+    // closes the sink's segment, returns the path of the next one
+    QString next(const std::chrono::steady_clock::time_point &now, TranscriptSink &sink);
+
+    void finish(const std::chrono::steady_clock::time_point &now, TranscriptSink &sink);
+};
+
+}
+
+#endif //OBS_SPEECH2TEXT_PLUGIN_TRANSCRIPT_SEGMENTS_H
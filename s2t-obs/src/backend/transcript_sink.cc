@@ -0,0 +1,127 @@
+// Copyright 2022 gab
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "transcript_sink.h"
+
+#include <cerrno>
+#include <cstring>
+
+#if _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "spdlog/spdlog.h"
+
+namespace backend {
+
+TranscriptSink::TranscriptSink() {
+    buffer.reserve(TRANSCRIPT_SINK_FLUSH_BYTES + 4096);
+}
+
+bool TranscriptSink::open(const QString &path, bool overwrite) {
+    // reopened for the next file
+    close();
+    buffer.clear();
+    oldest_unflushed_at = std::chrono::steady_clock::time_point();
+    has_failed = false;
+    write_count = 0;
+    bytes_written = 0;
+
+#if _WIN32
+    file = _wfopen(path.toStdWString().c_str(), overwrite ? L"wb" : L"ab");
+#else
+    file = fopen(path.toStdString().c_str(), overwrite ? "wb" : "ab");
+#endif
+    if (!file) {
+        has_failed = true;
+        return false;
+    }
+
+    // buffer is the only buffering, every flush() is a single write
+    setvbuf(file, nullptr, _IONBF, 0);
+    return true;
+}
+
+void TranscriptSink::entry_appended() {
+    if (buffer.empty())
+        return;
+
+    if (oldest_unflushed_at == std::chrono::steady_clock::time_point())
+        oldest_unflushed_at = std::chrono::steady_clock::now();
+
+    if (buffer.size() >= TRANSCRIPT_SINK_FLUSH_BYTES)
+        flush();
+}
+
+std::chrono::steady_clock::time_point TranscriptSink::flush_due_at() const {
+    if (buffer.empty() || oldest_unflushed_at == std::chrono::steady_clock::time_point())
+        return std::chrono::steady_clock::time_point::max();
+
+    return oldest_unflushed_at + std::chrono::milliseconds(TRANSCRIPT_SINK_FLUSH_INTERVAL_MS);
+}
+
+bool TranscriptSink::flush() {
+    oldest_unflushed_at = std::chrono::steady_clock::time_point();
+    if (buffer.empty())
+        return !has_failed;
+
+    if (!file || has_failed) {
+        buffer.clear();
+        return false;
+    }
+
+    const size_t written = fwrite(buffer.data(), 1, buffer.size(), file);
+    write_count++;
+    bytes_written += written;
+    if (written != buffer.size()) {
+        spdlog::error("transcript write failed: '{}'", strerror(errno));
+        has_failed = true;
+    }
+    buffer.clear();
+    return !has_failed;
+}
+
+bool TranscriptSink::sync() {
+    if (!flush() || !file)
+        return false;
+
+#if _WIN32
+    const int ret = _commit(_fileno(file));
+#else
+    const int ret = fsync(fileno(file));
+#endif
+    if (ret) {
+        spdlog::error("transcript sync failed: '{}'", strerror(errno));
+        has_failed = true;
+    }
+    return !has_failed;
+}
+
+void TranscriptSink::close() {
+    if (!file)
+        return;
+
+    sync();
+    fclose(file);
+    file = nullptr;
+    spdlog::debug("transcript closed, {} bytes in {} writes", bytes_written, write_count);
+}
+
+TranscriptSink::~TranscriptSink() {
+    close();
+}
+
+}
@@ -0,0 +1,82 @@
+// Copyright 2022 gab
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef OBS_SPEECH2TEXT_PLUGIN_TRANSCRIPT_SINK_H
+#define OBS_SPEECH2TEXT_PLUGIN_TRANSCRIPT_SINK_H
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+#include <QString>
+
+namespace backend {
+
+#define TRANSCRIPT_SINK_FLUSH_BYTES (64 * 1024)
+#define TRANSCRIPT_SINK_FLUSH_INTERVAL_MS 10000
+
+/*
+ Transcript file with its own append buffer.
+
+ Entries get formatted straight into append_buffer(), the file is only written once the buffer grew past
+ TRANSCRIPT_SINK_FLUSH_BYTES or the oldest unwritten entry is TRANSCRIPT_SINK_FLUSH_INTERVAL_MS old, whoever
+ owns the sink has to call flush() at flush_due_at() for that. sync() also asks the OS to put it on disk,
+ close() does so at the end of the session.
+*/
+class TranscriptSink {
+    FILE *file = nullptr;
+    std::string buffer;
+    bool has_failed = false;
+
+    std::chrono::steady_clock::time_point oldest_unflushed_at;
+
+    uint64_t write_count = 0;
+    uint64_t bytes_written = 0;
+
+public:
+    TranscriptSink();
+
+    bool open(const QString &path, bool overwrite);
+
+    std::string &append_buffer() {
+        return buffer;
+    }
+
+    // call after appending a complete entry
+    void entry_appended();
+
+    // time_point::max() if nothing is waiting to be written
+    std::chrono::steady_clock::time_point flush_due_at() const;
+
+    bool flush();
+
+    bool sync();
+
+    void close();
+
+    bool failed() const {
+        return has_failed;
+    }
+
+    // bytes appended since open(), buffered ones included
+    uint64_t size() const {
+        return bytes_written + buffer.size();
+    }
+
+    ~TranscriptSink();
+};
+
+}
+
+#endif //OBS_SPEECH2TEXT_PLUGIN_TRANSCRIPT_SINK_H
@@ -0,0 +1,268 @@
+// Copyright 2022 gab
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "transcript_wal.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+
+#include <obs-module.h>
+
+#include "spdlog/spdlog.h"
+
+namespace backend {
+
+static const char *SESSION_SUFFIX = ".json";
+static const char *ABANDONED_SUFFIX = ".failed";
+
+QString transcript_wal_directory() {
+    char *config_path = obs_module_config_path("transcript_wal");
+    if (!config_path)
+        return QString();
+
+    const QString directory = QString::fromUtf8(config_path);
+    bfree(config_path);
+
+    if (!QDir().mkpath(directory)) {
+        spdlog::error("transcript wal: couldn't create '{}'", directory.toStdString());
+        return QString();
+    }
+    return directory;
+}
+
+static QJsonObject session_to_json(const TranscriptWalSession &session) {
+    QJsonArray files;
+    for (const auto &file: session.files) {
+        QJsonObject entry;
+        entry["format"] = QString::fromStdString(file.format);
+        entry["path"] = file.path;
+        entry["start_offset"] = (qint64) file.start_offset;
+        entry["segmented"] = file.segmented;
+        files.append(entry);
+    }
+
+    QJsonObject srt;
+    srt["target_duration_secs"] = (qint64) session.srt_target_duration_secs;
+    srt["target_line_length"] = (qint64) session.srt_target_line_length;
+    srt["add_punctuation"] = session.srt_add_punctuation;
+    srt["split_single_sentences"] = session.srt_split_single_sentences;
+    srt["capitalization"] = session.srt_capitalization;
+
+    QJsonObject root;
+    root["version"] = TRANSCRIPT_WAL_VERSION;
+    root["target"] = QString::fromStdString(session.target_name);
+    root["started_at"] = (qint64) session.started_at_unix_ms;
+    root["journal"] = QFileInfo(session.journal_path).fileName();
+    root["srt"] = srt;
+    root["files"] = files;
+    return root;
+}
+
+static bool session_from_json(const QString &session_path, TranscriptWalSession &session) {
+    QFile file(session_path);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    const QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+    if (!doc.isObject())
+        return false;
+
+    const QJsonObject root = doc.object();
+    if (root.value("version").toInt() != TRANSCRIPT_WAL_VERSION)
+        return false;
+
+    session.session_path = session_path;
+    session.journal_path = QFileInfo(session_path).dir().absoluteFilePath(root.value("journal").toString());
+    session.target_name = root.value("target").toString().toStdString();
+    session.started_at_unix_ms = root.value("started_at").toInteger();
+
+    const QJsonObject srt = root.value("srt").toObject();
+    session.srt_target_duration_secs = srt.value("target_duration_secs").toInt();
+    session.srt_target_line_length = srt.value("target_line_length").toInt();
+    session.srt_add_punctuation = srt.value("add_punctuation").toBool();
+    session.srt_split_single_sentences = srt.value("split_single_sentences").toBool();
+    session.srt_capitalization = srt.value("capitalization").toInt();
+
+    for (const auto &value: root.value("files").toArray()) {
+        const QJsonObject entry = value.toObject();
+        TranscriptWalFile wal_file;
+        wal_file.format = entry.value("format").toString().toStdString();
+        wal_file.path = entry.value("path").toString();
+        wal_file.start_offset = entry.value("start_offset").toInteger();
+        wal_file.segmented = entry.value("segmented").toBool();
+        if (wal_file.format.empty() || wal_file.path.isEmpty() || wal_file.start_offset < 0)
+            return false;
+        session.files.push_back(wal_file);
+    }
+    return !session.files.empty() && QFileInfo::exists(session.journal_path);
+}
+
+TranscriptWal::TranscriptWal(const std::chrono::steady_clock::time_point &started_at) :
+        journal(started_at),
+        sync_due(std::chrono::steady_clock::time_point::max()) {}
+
+bool TranscriptWal::open(const QString &directory, TranscriptWalSession session) {
+    const QDir dir(directory);
+    for (int i = 0; journal_path.isEmpty(); i++) {
+        QString file_name = QString("%1_%2").arg(QString::fromStdString(session.target_name)).arg(session.started_at_unix_ms);
+        if (i)
+            file_name += QString("_%1").arg(i);
+        file_name += ".s2tj";
+
+        const QString candidate = dir.absoluteFilePath(file_name);
+        if (!QFileInfo::exists(candidate) && !QFileInfo::exists(candidate + SESSION_SUFFIX))
+            journal_path = candidate;
+    }
+
+    if (!journal.open(journal_path, session.started_at_unix_ms) || !journal.sync()) {
+        spdlog::error("transcript wal: couldn't open '{}'", journal_path.toStdString());
+        return false;
+    }
+
+    // the session file last, whatever it names exists by then
+    session.journal_path = journal_path;
+    session_path = journal_path + SESSION_SUFFIX;
+    QSaveFile session_file(session_path);
+    if (!session_file.open(QIODevice::WriteOnly)
+        || session_file.write(QJsonDocument(session_to_json(session)).toJson()) < 0
+        || !session_file.commit()) {
+        spdlog::error("transcript wal: couldn't write '{}'", session_path.toStdString());
+        session_path.clear();
+        return false;
+    }
+
+    spdlog::debug("transcript wal: logging {} to '{}'", session.target_name, journal_path.toStdString());
+    return true;
+}
+
+void TranscriptWal::append(const OutputCaptionResult &result) {
+    journal.append(result);
+    if (sync_due == std::chrono::steady_clock::time_point::max())
+        sync_due = std::chrono::steady_clock::now() + std::chrono::milliseconds(TRANSCRIPT_WAL_SYNC_INTERVAL_MS);
+}
+
+bool TranscriptWal::sync() {
+    sync_due = std::chrono::steady_clock::time_point::max();
+    return journal.sync();
+}
+
+void TranscriptWal::close() {
+    journal.close();
+}
+
+void TranscriptWal::remove() {
+    journal.close();
+    if (journal_path.isEmpty())
+        return;
+
+    // the session file first, a journal without one is never recovered
+    if (!session_path.isEmpty())
+        QFile::remove(session_path);
+    QFile::remove(caption_journal_index_path(journal_path));
+    QFile::remove(journal_path);
+    journal_path.clear();
+    session_path.clear();
+}
+
+std::vector<TranscriptWalSession> find_interrupted_transcript_sessions(const QString &directory) {
+    std::vector<TranscriptWalSession> sessions;
+    if (directory.isEmpty())
+        return sessions;
+
+    const QDir dir(directory);
+    const QStringList session_files = dir.entryList(QStringList() << QString("*.s2tj") + SESSION_SUFFIX, QDir::Files);
+    for (const auto &session_file: session_files) {
+        TranscriptWalSession session;
+        const QString session_path = dir.absoluteFilePath(session_file);
+        if (!session_from_json(session_path, session)) {
+            spdlog::warn("transcript wal: unusable session '{}', skipping it", session_path.toStdString());
+            session.session_path = session_path;
+            abandon_transcript_wal_session(session);
+            continue;
+        }
+        sessions.push_back(std::move(session));
+    }
+
+    std::sort(sessions.begin(), sessions.end(), [](const TranscriptWalSession &a, const TranscriptWalSession &b) {
+        return a.started_at_unix_ms < b.started_at_unix_ms;
+    });
+    return sessions;
+}
+
+void remove_transcript_wal_session(const TranscriptWalSession &session) {
+    QFile::remove(session.session_path);
+    if (session.journal_path.isEmpty())
+        return;
+
+    QFile::remove(caption_journal_index_path(session.journal_path));
+    QFile::remove(session.journal_path);
+}
+
+void abandon_transcript_wal_session(const TranscriptWalSession &session) {
+    const QString abandoned_path = session.session_path + ABANDONED_SUFFIX;
+    QFile::remove(abandoned_path);
+    if (!QFile::rename(session.session_path, abandoned_path))
+        QFile::remove(session.session_path);
+}
+
+static std::mutex recovery_mutex;
+static std::condition_variable recovery_done_cv;
+// absolute paths, a session can list a file more than once and sessions can share one
+static std::multiset<std::string> recovering_paths;
+
+static std::string recovery_key(const QString &path) {
+    return QFileInfo(path).absoluteFilePath().toStdString();
+}
+
+void begin_transcript_recovery(const std::vector<TranscriptWalSession> &sessions) {
+    std::lock_guard<std::mutex> lock(recovery_mutex);
+    for (const auto &session: sessions) {
+        for (const auto &file: session.files)
+            recovering_paths.insert(recovery_key(file.path));
+    }
+}
+
+void end_transcript_recovery(const TranscriptWalSession &session) {
+    {
+        std::lock_guard<std::mutex> lock(recovery_mutex);
+        for (const auto &file: session.files) {
+            const auto it = recovering_paths.find(recovery_key(file.path));
+            if (it != recovering_paths.end())
+                recovering_paths.erase(it);
+        }
+    }
+    recovery_done_cv.notify_all();
+}
+
+void wait_for_transcript_recovery_of(const QString &path) {
+    const std::string key = recovery_key(path);
+    std::unique_lock<std::mutex> lock(recovery_mutex);
+    if (!recovering_paths.count(key))
+        return;
+
+    spdlog::info("transcript wal: waiting for the recovery of '{}'", key);
+    recovery_done_cv.wait(lock, [&key]() { return !recovering_paths.count(key); });
+}
+
+}
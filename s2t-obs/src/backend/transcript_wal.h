@@ -0,0 +1,123 @@
+// Copyright 2022 gab
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef OBS_SPEECH2TEXT_PLUGIN_TRANSCRIPT_WAL_H
+#define OBS_SPEECH2TEXT_PLUGIN_TRANSCRIPT_WAL_H
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <QString>
+
+#include "caption_journal.h"
+
+namespace backend {
+
+#define TRANSCRIPT_WAL_VERSION 1
+#define TRANSCRIPT_WAL_SYNC_INTERVAL_MS 1000
+
+/*
+ Write-ahead log of a transcript output, so a transcript interrupted by a crash can be finished on the next start.
+
+ Every result queued for the TranscriptOutputHandler goes into a caption journal "[dir]/[target]_[started at].s2tj",
+ synced at most TRANSCRIPT_WAL_SYNC_INTERVAL_MS after it came in. "[journal].json" next to it describes the session:
+ which files in which format it writes, how large each of them was when the session started and the settings the
+ subtitles are built with. A clean finish removes all of it, so whatever is still in the directory on the next
+ start was interrupted.
+*/
+
+struct TranscriptWalFile {
+    std::string format;
+    QString path;
+    // file size before the session wrote anything, recovery cuts it back to that and writes the session again
+    int64_t start_offset = 0;
+    // split into segments, recovered into a single "[name]_recovered.[ext]" next to them instead
+    bool segmented = false;
+};
+
+struct TranscriptWalSession {
+    QString session_path;   // "[journal].json"
+    QString journal_path;
+    std::string target_name;
+    int64_t started_at_unix_ms = 0;
+
+    uint srt_target_duration_secs = 0;
+    uint srt_target_line_length = 0;
+    bool srt_add_punctuation = false;
+    bool srt_split_single_sentences = false;
+    int srt_capitalization = 0;
+
+    std::vector<TranscriptWalFile> files;
+};
+
+// in the plugin's config directory, created if missing. Empty if OBS has none for the plugin.
+QString transcript_wal_directory();
+
+class TranscriptWal {
+    CaptionJournalWriter journal;
+    QString journal_path;
+    QString session_path;
+    std::chrono::steady_clock::time_point sync_due;
+
+public:
+    // started_at: of the transcript, the journaled times are relative to it
+    explicit TranscriptWal(const std::chrono::steady_clock::time_point &started_at);
+
+    // session.files, target_name, started_at and the srt settings, the paths are picked here
+    bool open(const QString &directory, TranscriptWalSession session);
+
+    void append(const OutputCaptionResult &result);
+
+    // time_point::max() while everything is synced
+    std::chrono::steady_clock::time_point sync_due_at() const {
+        return sync_due;
+    }
+
+    bool sync();
+
+    // transcript finished cleanly, nothing left to recover
+    void remove();
+
+    // keeps it for recovery on the next start
+    void close();
+
+    bool failed() const {
+        return journal.failed();
+    }
+};
+
+// sessions left behind in directory, oldest first
+std::vector<TranscriptWalSession> find_interrupted_transcript_sessions(const QString &directory);
+
+void remove_transcript_wal_session(const TranscriptWalSession &session);
+
+// keeps the journal for a manual export, but stops trying to recover it on every start
+void abandon_transcript_wal_session(const TranscriptWalSession &session);
+
+// Recovery cuts the files of a session back and writes them again. A new transcript can take the same file, a custom
+// name that gets appended to, so it has to wait until that's done.
+
+// the files of sessions about to be recovered, before any new transcript could open one of them
+void begin_transcript_recovery(const std::vector<TranscriptWalSession> &sessions);
+
+// recovered, abandoned or left for the next start, new transcripts can open its files again
+void end_transcript_recovery(const TranscriptWalSession &session);
+
+// blocks while path is still to be recovered
+void wait_for_transcript_recovery_of(const QString &path);
+
+}
+
+#endif //OBS_SPEECH2TEXT_PLUGIN_TRANSCRIPT_WAL_H
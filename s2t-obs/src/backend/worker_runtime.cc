@@ -0,0 +1,245 @@
+// Copyright 2022 gab
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "worker_runtime.h"
+
+#if _WIN32
+#include <windows.h>
+#elif __APPLE__
+#include <pthread.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <cerrno>
+#include <cstring>
+
+#include "spdlog/spdlog.h"
+
+#include "trace.h"
+
+namespace backend {
+
+const char *worker_role_name(WorkerRole role) {
+    switch (role) {
+        case WORKER_ROLE_CAPTURE:
+            return "capture";
+        case WORKER_ROLE_NETWORK:
+            return "network";
+        case WORKER_ROLE_FORMATTING:
+            return "formatting";
+        case WORKER_ROLE_DISK_IO:
+            return "disk_io";
+        default:
+            return "unknown";
+    }
+}
+
+WorkerRuntimeSettings default_WorkerRuntimeSettings() {
+    WorkerRuntimeSettings settings;
+    settings.roles[WORKER_ROLE_DISK_IO].nice = 10;
+    return settings;
+}
+
+int64_t current_native_thread_id() {
+#if _WIN32
+    return GetCurrentThreadId();
+#elif __APPLE__
+    uint64_t tid = 0;
+    pthread_threadid_np(nullptr, &tid);
+    return (int64_t) tid;
+#else
+    return (int64_t) syscall(SYS_gettid);
+#endif
+}
+
+static void set_current_thread_name(const std::string &name) {
+    const std::string os_name = name.substr(0, WORKER_THREAD_OS_NAME_MAX);
+#if _WIN32
+    SetThreadDescription(GetCurrentThread(), std::wstring(os_name.begin(), os_name.end()).c_str());
+#elif __APPLE__
+    pthread_setname_np(os_name.c_str());
+#else
+    pthread_setname_np(pthread_self(), os_name.c_str());
+#endif
+}
+
+static void set_current_thread_nice(const std::string &name, int nice) {
+    if (!nice)
+        return;
+
+#if _WIN32
+    int priority = THREAD_PRIORITY_NORMAL;
+    if (nice >= 10)
+        priority = THREAD_PRIORITY_LOWEST;
+    else if (nice > 0)
+        priority = THREAD_PRIORITY_BELOW_NORMAL;
+    else if (nice <= -10)
+        priority = THREAD_PRIORITY_HIGHEST;
+    else
+        priority = THREAD_PRIORITY_ABOVE_NORMAL;
+
+    if (!SetThreadPriority(GetCurrentThread(), priority))
+        spdlog::warn("worker '{}': couldn't set priority for nice {}", name, nice);
+#elif __APPLE__
+    spdlog::debug("worker '{}': nice per thread not supported, ignoring {}", name, nice);
+#else
+    // the nice value is per thread on Linux
+    if (setpriority(PRIO_PROCESS, (id_t) syscall(SYS_gettid), nice))
+        spdlog::warn("worker '{}': couldn't set nice {}: {}", name, nice, strerror(errno));
+#endif
+}
+
+static void set_current_thread_cpus(const std::string &name, const std::vector<uint> &cpus) {
+    if (cpus.empty())
+        return;
+
+#if _WIN32
+    DWORD_PTR mask = 0;
+    for (const uint cpu: cpus) {
+        if (cpu < sizeof(DWORD_PTR) * 8)
+            mask |= (DWORD_PTR) 1 << cpu;
+    }
+
+    if (!mask || !SetThreadAffinityMask(GetCurrentThread(), mask))
+        spdlog::warn("worker '{}': couldn't set cpu affinity", name);
+#elif __APPLE__
+    spdlog::debug("worker '{}': cpu affinity not supported, ignoring", name);
+#else
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    for (const uint cpu: cpus) {
+        if (cpu < CPU_SETSIZE)
+            CPU_SET(cpu, &cpu_set);
+    }
+
+    const int err = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+    if (err)
+        spdlog::warn("worker '{}': couldn't set cpu affinity: {}", name, strerror(err));
+#endif
+}
+
+WorkerRuntime::WorkerRuntime() :
+        settings(default_WorkerRuntimeSettings()) {}
+
+WorkerRuntime &WorkerRuntime::instance() {
+    static WorkerRuntime runtime;
+    return runtime;
+}
+
+void WorkerRuntime::configure(const WorkerRuntimeSettings &new_settings) {
+    std::lock_guard<std::mutex> lock(mutex);
+    settings = new_settings;
+}
+
+WorkerRoleSettings WorkerRuntime::role_settings(WorkerRole role) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (role < 0 || role >= WORKER_ROLE_COUNT)
+        return WorkerRoleSettings();
+
+    return settings.roles[role];
+}
+
+std::vector<WorkerInfo> WorkerRuntime::running_workers() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<WorkerInfo> running;
+    running.reserve(workers.size());
+    for (const auto &worker: workers)
+        running.push_back(worker.second);
+
+    return running;
+}
+
+void WorkerRuntime::log_workers() const {
+    const auto now = std::chrono::steady_clock::now();
+    const auto running = running_workers();
+
+    spdlog::info("{} worker threads running", running.size());
+    for (const auto &worker: running) {
+        spdlog::info("  '{}', {}, native id {}, running {} s", worker.name, worker_role_name(worker.role), worker.native_id,
+                     std::chrono::duration_cast<std::chrono::seconds>(now - worker.started_at).count());
+    }
+}
+
+uint64_t WorkerRuntime::register_worker(const std::string &name, WorkerRole role, int64_t native_id) {
+    std::lock_guard<std::mutex> lock(mutex);
+    const uint64_t id = next_id++;
+    workers.emplace(id, WorkerInfo{id, name, role, native_id, std::chrono::steady_clock::now()});
+    return id;
+}
+
+void WorkerRuntime::unregister_worker(uint64_t id) {
+    std::lock_guard<std::mutex> lock(mutex);
+    workers.erase(id);
+}
+
+static void run_worker(const std::string &name, WorkerRole role, const std::function<void()> &fn) {
+    WorkerRuntime &runtime = WorkerRuntime::instance();
+    const WorkerRoleSettings role_settings = runtime.role_settings(role);
+
+    set_current_thread_name(name);
+    set_trace_thread_name(name);
+    set_current_thread_nice(name, role_settings.nice);
+    set_current_thread_cpus(name, role_settings.cpus);
+
+    const uint64_t id = runtime.register_worker(name, role, current_native_thread_id());
+    spdlog::debug("worker '{}' ({}) starting", name, worker_role_name(role));
+
+    try {
+        fn();
+    }
+    catch (std::string &err) {
+        spdlog::error("worker '{}' error: {}", name, err);
+    }
+    catch (std::exception &ex) {
+        spdlog::error("worker '{}' error: {}", name, ex.what());
+    }
+
+    runtime.unregister_worker(id);
+    spdlog::debug("worker '{}' finished", name);
+}
+
+WorkerThread::WorkerThread(const std::string &name, WorkerRole role, std::function<void()> fn) :
+        thread(run_worker, name, role, std::move(fn)) {}
+
+WorkerThread &WorkerThread::operator=(WorkerThread &&other) {
+    if (this != &other) {
+        join();
+        thread = std::move(other.thread);
+    }
+    return *this;
+}
+
+void WorkerThread::join() {
+    if (!thread.joinable())
+        return;
+
+    if (thread.get_id() == std::this_thread::get_id()) {
+        spdlog::error("worker thread tried to join itself, detaching it");
+        thread.detach();
+        return;
+    }
+
+    thread.join();
+}
+
+WorkerThread::~WorkerThread() {
+    join();
+}
+
+}
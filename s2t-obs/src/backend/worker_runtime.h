@@ -0,0 +1,151 @@
+// Copyright 2022 gab
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef OBS_SPEECH2TEXT_PLUGIN_WORKER_RUNTIME_H
+#define OBS_SPEECH2TEXT_PLUGIN_WORKER_RUNTIME_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace backend {
+
+typedef unsigned int uint;
+
+// longest thread name Linux shows, longer ones only keep their full name in the registry
+#define WORKER_THREAD_OS_NAME_MAX 15
+
+enum WorkerRole {
+    WORKER_ROLE_CAPTURE,
+    WORKER_ROLE_NETWORK,
+    WORKER_ROLE_FORMATTING,
+    WORKER_ROLE_DISK_IO,
+
+    WORKER_ROLE_COUNT
+};
+
+const char *worker_role_name(WorkerRole role);
+
+struct WorkerRoleSettings {
+    int nice = 0;               // like nice(1), -20..19, higher runs at lower priority, 0 leaves it as is
+    std::vector<uint> cpus;     // cpus the threads may run on, empty: any
+
+    bool operator==(const WorkerRoleSettings &rhs) const {
+        return nice == rhs.nice &&
+               cpus == rhs.cpus;
+    }
+
+    bool operator!=(const WorkerRoleSettings &rhs) const {
+        return !(rhs == *this);
+    }
+};
+
+struct WorkerRuntimeSettings {
+    WorkerRoleSettings roles[WORKER_ROLE_COUNT];
+
+    bool operator==(const WorkerRuntimeSettings &rhs) const {
+        for (int i = 0; i < WORKER_ROLE_COUNT; i++) {
+            if (roles[i] != rhs.roles[i])
+                return false;
+        }
+        return true;
+    }
+
+    bool operator!=(const WorkerRuntimeSettings &rhs) const {
+        return !(rhs == *this);
+    }
+};
+
+// disk I/O in the background, everything else like OBS's own threads
+WorkerRuntimeSettings default_WorkerRuntimeSettings();
+
+// what top/perf show for the calling thread
+int64_t current_native_thread_id();
+
+struct WorkerInfo {
+    uint64_t id;
+    std::string name;
+    WorkerRole role;
+    int64_t native_id;      // what top/perf show: tid on Linux, thread id on Windows
+    std::chrono::steady_clock::time_point started_at;
+};
+
+/*
+ Registry of the plugin's own worker threads and the nice level and cpu affinity per role they get when they start.
+ Threads started before configure() keep what they got.
+*/
+class WorkerRuntime {
+    mutable std::mutex mutex;
+    WorkerRuntimeSettings settings;
+    std::map<uint64_t, WorkerInfo> workers;
+    uint64_t next_id = 1;
+
+    WorkerRuntime();
+
+public:
+    static WorkerRuntime &instance();
+
+    void configure(const WorkerRuntimeSettings &new_settings);
+
+    WorkerRoleSettings role_settings(WorkerRole role) const;
+
+    std::vector<WorkerInfo> running_workers() const;
+
+    void log_workers() const;
+
+    // called by the worker threads themselves
+    uint64_t register_worker(const std::string &name, WorkerRole role, int64_t native_id);
+
+    void unregister_worker(uint64_t id);
+};
+
+/*
+ Named std::thread set up for its role, registered with the WorkerRuntime while it runs.
+ Joined when destroyed instead of detached, so whoever owns it knows the thread is done afterwards.
+*/
+class WorkerThread {
+    std::thread thread;
+
+public:
+    WorkerThread() = default;
+
+    WorkerThread(const std::string &name, WorkerRole role, std::function<void()> fn);
+
+    WorkerThread(WorkerThread &&) = default;
+
+    // joins the current thread first
+    WorkerThread &operator=(WorkerThread &&other);
+
+    bool joinable() const {
+        return thread.joinable();
+    }
+
+    std::thread::id get_id() const {
+        return thread.get_id();
+    }
+
+    // not from the thread itself, that would wait forever, it gets detached then
+    void join();
+
+    ~WorkerThread();
+};
+
+}
+
+#endif //OBS_SPEECH2TEXT_PLUGIN_WORKER_RUNTIME_H
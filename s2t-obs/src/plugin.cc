@@ -12,12 +12,16 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <chrono>
 #include <iostream>
 #include <moodycamel/blockingconcurrentqueue.h>
 
 #include <spdlog/spdlog.h>
 #include <obs-frontend-api.h>
 
+#include "backend/logging.h"
+#include "backend/shutdown.h"
+#include "backend/worker_runtime.h"
 #include "ui/caption_main_widget.h"
 #include "ui/caption_manager.h"
 
@@ -27,6 +31,14 @@ ui::CaptionManager *caption_manager = nullptr;
 bool frontend_finished_loading = false;
 bool saving = false;
 
+static std::chrono::steady_clock::time_point module_loaded_at;
+
+// everything here runs on the UI thread while OBS is loading, adds to OBS's startup time
+static void log_startup_step(const char *step, const std::chrono::steady_clock::time_point &started_at) {
+    spdlog::info("startup: {} took {} ms", step,
+                 std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started_at).count());
+}
+
 static void obs_event(enum obs_frontend_event ev, void *) {
     if (ev == OBS_FRONTEND_EVENT_FINISHED_LOADING) {
         ev_finished_loading();
@@ -45,8 +57,13 @@ static void obs_event(enum obs_frontend_event ev, void *) {
 
 void ev_finished_loading() {
     frontend_finished_loading = true;
+    log_startup_step("module load to frontend loaded", module_loaded_at);
+
+    // starts captioning if enabled, the first stream connects right away instead of waiting for audio
+    const auto started_at = std::chrono::steady_clock::now();
     if (caption_widget)
         caption_widget->show();
+    log_startup_step("caption start", started_at);
 }
 
 void ev_streaming_started() {
@@ -71,17 +88,33 @@ void ev_recording_stopped() {
 
 void ev_exit() {
     spdlog::info("frontend exit, closing caption...");
-    
+
+    const uint shutdown_budget_ms = caption_manager ? caption_manager->plugin_settings.shutdown_budget_ms
+                                                    : PLUGIN_SHUTDOWN_BUDGET_MS;
+    backend::PluginShutdown::begin(std::chrono::milliseconds(shutdown_budget_ms));
+
     if (caption_widget) {
+        backend::ShutdownTimer timer("caption widget");
         delete caption_widget;
         caption_widget = nullptr;
     }
 
     if (caption_manager) {
+        backend::ShutdownTimer timer("caption manager");
         delete caption_manager;
         caption_manager = nullptr;
     }
+
+    {
+        backend::ShutdownTimer timer("transcript recovery");
+        backend::SourceCaptioner::wait_for_transcript_recovery();
+    }
+
+    // everything above joined its threads, anything listed here leaked one
+    backend::WorkerRuntime::instance().log_workers();
+    backend::PluginShutdown::finish();
     spdlog::info("frontend exit, caption closed.");
+    backend::flush_logging();
 } 
 
 static void save_and_load_event_callback(obs_data_t *save_data, bool saving, void *) {
@@ -90,21 +123,39 @@ static void save_and_load_event_callback(obs_data_t *save_data, bool saving, voi
     }
 
     if (!saving) { // load the plugin at the opening of OBS
+        auto started_at = std::chrono::steady_clock::now();
         auto settings = load_caption_manager(save_data);
+        log_startup_step("settings load", started_at);
         if (caption_manager && caption_widget) {
             caption_manager->update_settings(settings);
         } else if (caption_manager || caption_widget) {
             error_log("only one of caption_manager and caption_widget is alive. Fatal error.");
         } else {
+            // before any worker thread starts
+            backend::WorkerRuntime::instance().configure(settings.worker_settings);
+
+            // before anything can start a new transcript
+            started_at = std::chrono::steady_clock::now();
+            backend::SourceCaptioner::recover_interrupted_transcripts_in_background();
+            log_startup_step("transcript recovery scan", started_at);
+
+            started_at = std::chrono::steady_clock::now();
             caption_manager = CaptionManger(settings);
+            log_startup_step("caption manager", started_at);
+
+            // the settings dialog is only built once it's opened
+            started_at = std::chrono::steady_clock::now();
             caption_widget = CaptionWidget(*caption_manager);
             load_UI();
+            log_startup_step("caption dock", started_at);
         }
     }
 }
 
 bool obs_module_load(void) {
-    spdlog::info("obs-speech2text-plugin unloaded.");
+    module_loaded_at = std::chrono::steady_clock::now();
+    backend::init_logging();
+    spdlog::info("obs-speech2text-plugin loaded.");
     obs_frontend_add_event_callback(obs_event, nullptr);
     obs_frontend_add_save_callback(save_and_load_event_callback, nullptr);
     return true;
@@ -112,4 +163,5 @@ bool obs_module_load(void) {
 
 bool obs_module_unload(void) {
     spdlog::info("obs-speech2text-plugin unloaded.");
+    backend::shutdown_logging();
 }
\ No newline at end of file
@@ -14,18 +14,38 @@
 
 #include "caption_dock_widget.h"
 
+#include "backend/trace.h"
 #include "utils/ui.h"
 
+#include <QApplication>
+#include <QClipboard>
+#include <QDateTime>
+#include <QDir>
+#include <QFileDialog>
+#include <QFileInfo>
 #include <QLabel>
 #include <QLineEdit>
 
 namespace ui {
 
+#define DOCK_SEARCH_MAX_HITS 50
+#define DOCK_SEARCH_DEBOUNCE_MS 250
+
+// "1:02:03"
+static QString offset_string(int64_t ms) {
+    const int64_t secs = ms / 1000;
+    return QString("%1:%2:%3")
+        .arg(secs / 3600)
+        .arg(secs / 60 % 60, 2, 10, QChar('0'))
+        .arg(secs % 60, 2, 10, QChar('0'));
+}
+
 CaptionDockWidget::CaptionDockWidget(const QString &title, CaptionManager &manager, CaptionMainWidget &caption_main_widget)
-        : QDockWidget(title), manager(manager), caption_main_widget(caption_main_widget) {
+        : QDockWidget(title), manager(manager), caption_main_widget(caption_main_widget), search_executor("search") {
     setupUi(this);
     setWindowTitle(title);
     captionLinesPlainTextEdit->clear();
+    searchResultsListWidget->hide();
 
     setFeatures(QDockWidget::AllDockWidgetFeatures);
     setFloating(true);
@@ -33,6 +53,10 @@ CaptionDockWidget::CaptionDockWidget(const QString &title, CaptionManager &manag
     QObject::connect(&manager.source_captioner, &SourceCaptioner::caption_source_status_changed, this, &CaptionDockWidget::handle_source_capture_status_change, Qt::QueuedConnection);
     QObject::connect(&manager.source_captioner, &SourceCaptioner::caption_result_received, this, &CaptionDockWidget::handle_caption_data_cb, Qt::QueuedConnection);
 
+    search_timer.setSingleShot(true);
+    search_timer.setInterval(DOCK_SEARCH_DEBOUNCE_MS);
+    QObject::connect(&search_timer, &QTimer::timeout, this, &CaptionDockWidget::run_search);
+
     QFontMetrics fm = this->captionLinesPlainTextEdit->fontMetrics();
     spdlog::info("dock: {} {} fs: {}", this->minimumWidth(), this->maximumWidth(), this->captionLinesPlainTextEdit->font().pointSize());
 
@@ -64,7 +88,7 @@ void CaptionDockWidget::handle_source_capture_status_change(std::shared_ptr<Sour
 void CaptionDockWidget::handle_caption_data_cb(
     std::shared_ptr<OutputCaptionResult> caption_result,
     bool cleared,
-    std::string recent_caption_text
+    backend::RecentCaptionTextPtr recent_caption_text
 ) {
     if (cleared) {
         captionLinesPlainTextEdit->setPlainText("");
@@ -93,4 +117,131 @@ void CaptionDockWidget::on_settingsToolButton_clicked() {
     caption_main_widget.show_settings_widget();
 }
 
+void CaptionDockWidget::on_traceToolButton_clicked() {
+    // the last 30 seconds up to the click, not up to whenever the file dialog got closed
+    const int64_t clicked_ns = backend::trace_now_ns();
+    const QString default_path = QDir::home().filePath(
+        QString("s2t-trace-%1.json").arg(QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss")));
+    const QString path = QFileDialog::getSaveFileName(this, "Save trace", default_path, "Chrome trace (*.json)");
+    if (path.isEmpty())
+        return;
+
+    try {
+        const uint64_t spans = backend::TraceRecorder::instance().write_chrome_trace(path, clicked_ns);
+        statusTextLabel->setText(QString("Trace saved, %1 spans").arg(spans));
+    }
+    catch (std::string &err) {
+        spdlog::error("couldn't save trace: {}", err);
+        statusTextLabel->setText("Couldn't save trace");
+    }
+}
+
+void CaptionDockWidget::on_exportToolButton_clicked() {
+    const QString journal_path = QFileDialog::getOpenFileName(this, "Export caption journal", QDir::homePath(),
+                                                              "Caption journal (*.s2tj)");
+    if (journal_path.isEmpty())
+        return;
+
+    const QFileInfo journal_file(journal_path);
+    const QString default_path = journal_file.dir().filePath(journal_file.completeBaseName() + ".srt");
+    const QString output_path = QFileDialog::getSaveFileName(this, "Export transcript", default_path,
+                                                             "SubRip (*.srt);;WebVTT (*.vtt);;Text (*.txt)");
+    if (output_path.isEmpty())
+        return;
+
+    statusTextLabel->setText("Exporting journal...");
+    const backend::TranscriptOutputSettings settings = manager.plugin_settings.source_cap_settings.transcript_settings;
+    search_executor.post([this, journal_path, output_path, settings]() {
+        const bool exported = backend::SourceCaptioner::export_caption_journal(journal_path, output_path, settings);
+        QMetaObject::invokeMethod(this, [this, exported, output_path]() {
+            statusTextLabel->setText(exported
+                ? QString("Exported to %1").arg(QFileInfo(output_path).fileName())
+                : QString("Couldn't export journal"));
+        }, Qt::QueuedConnection);
+    });
+}
+
+void CaptionDockWidget::on_searchLineEdit_textChanged(const QString &text) {
+    search_timer.start();
+}
+
+void CaptionDockWidget::run_search() {
+    const QString query = searchLineEdit->text();
+    const uint64_t generation = ++search_generation;
+    if (query.trimmed().isEmpty()) {
+        show_search_hits(generation, query, {});
+        return;
+    }
+
+    search_executor.post([this, generation, query]() {
+        // typed on while this one was waiting
+        if (generation != search_generation)
+            return;
+
+        std::vector<backend::CaptionSearchHit> hits;
+        manager.source_captioner.search_captions(query.toStdString(), DOCK_SEARCH_MAX_HITS, hits);
+        QMetaObject::invokeMethod(this, [this, generation, query, hits = std::move(hits)]() mutable {
+            show_search_hits(generation, query, std::move(hits));
+        }, Qt::QueuedConnection);
+    });
+}
+
+void CaptionDockWidget::show_search_hits(uint64_t generation, const QString &text, std::vector<backend::CaptionSearchHit> hits) {
+    if (generation != search_generation)
+        return;
+
+    search_hits = std::move(hits);
+    searchResultsListWidget->clear();
+    searchResultsListWidget->setVisible(!text.trimmed().isEmpty());
+    if (search_hits.empty()) {
+        if (!text.trimmed().isEmpty())
+            searchResultsListWidget->addItem("No captions found");
+        return;
+    }
+
+    // recording time where there is one, that's what the hits get looked up in afterwards
+    for (size_t i = 0; i < search_hits.size(); i++) {
+        const auto &hit = search_hits[i];
+        QString at;
+        if (hit.recording_ms >= 0)
+            at = "REC " + offset_string(hit.recording_ms);
+        else if (hit.stream_ms >= 0)
+            at = "LIVE " + offset_string(hit.stream_ms);
+        else
+            at = offset_string(hit.session_ms);
+
+        auto *item = new QListWidgetItem(QString("[%1] %2").arg(at, QString::fromStdString(hit.text)));
+        item->setData(Qt::UserRole, (qulonglong) i);
+        searchResultsListWidget->addItem(item);
+    }
+}
+
+void CaptionDockWidget::on_searchResultsListWidget_itemActivated(QListWidgetItem *item) {
+    if (!item || !item->data(Qt::UserRole).isValid())
+        return;
+
+    const size_t hit_index = item->data(Qt::UserRole).toULongLong();
+    if (hit_index >= search_hits.size())
+        return;
+
+    // OBS can't seek in its outputs, so jumping means handing over the time to look up in the recording
+    const auto &hit = search_hits[hit_index];
+    QString label;
+    int64_t offset_ms;
+    if (hit.recording_ms >= 0) {
+        label = "Recording";
+        offset_ms = hit.recording_ms;
+    } else if (hit.stream_ms >= 0) {
+        label = "Stream";
+        offset_ms = hit.stream_ms;
+    } else {
+        label = "Since captioning started";
+        offset_ms = hit.session_ms;
+    }
+
+    const QString time = offset_string(offset_ms);
+    QApplication::clipboard()->setText(time);
+    statusTextLabel->setText(QString("%1 %2, copied").arg(label, time));
+}
+
 }
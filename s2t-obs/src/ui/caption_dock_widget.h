@@ -18,10 +18,14 @@
 #include "ui_caption_dock_widget.h"
 
 #include "backend/caption.h"
+#include "backend/output_executor.h"
 #include "caption_manager.h"
 #include "caption_main_widget.h"
 
 #include <QDockWidget>
+#include <QListWidgetItem>
+#include <QTimer>
+#include <atomic>
 #include <spdlog/spdlog.h>
 
 namespace ui {
@@ -32,12 +36,33 @@ private:
     CaptionManager &manager;
     CaptionMainWidget &caption_main_widget;
     std::string last_output_line;
+    std::vector<backend::CaptionSearchHit> search_hits;
 
-    void handle_caption_data_cb(std::shared_ptr<OutputCaptionResult> caption_result, bool cleared, std::string recent_caption_text);
+    // typing restarts it, the search runs once it stopped for a bit
+    QTimer search_timer;
+    // newest search, results of older ones get dropped
+    std::atomic<uint64_t> search_generation{0};
+
+    // searches read evicted captions back from disk and journal exports run, off the UI thread. Last, so it's joined first
+    backend::OutputExecutor search_executor;
+
+    void run_search();
+
+    void show_search_hits(uint64_t generation, const QString &query, std::vector<backend::CaptionSearchHit> hits);
+
+    void handle_caption_data_cb(std::shared_ptr<OutputCaptionResult> caption_result, bool cleared, backend::RecentCaptionTextPtr recent_caption_text);
 
 private slots:
     void on_settingsToolButton_clicked();
 
+    void on_traceToolButton_clicked();
+
+    void on_exportToolButton_clicked();
+
+    void on_searchLineEdit_textChanged(const QString &text);
+
+    void on_searchResultsListWidget_itemActivated(QListWidgetItem *item);
+
 public:
     CaptionDockWidget(const QString &title, CaptionManager &manager, CaptionMainWidget &caption_main_widget);
     void handle_source_capture_status_change(std::shared_ptr<CaptionSourceStatus> status);==
@@ -17,6 +17,8 @@
 #include "utils/ui.h"
 #include "utils/caption.h"
 
+#include <chrono>
+
 #include <QTimer>
 #include <QThread>
 
@@ -25,8 +27,7 @@ namespace ui {
 CaptionMainWidget::CaptionMainWidget(PluginManager &manager) :
 QWidget(),
 Ui_CaptionMainWidget(),
-manager(manager),
-caption_settings_widget(manager.get_settings()) {
+manager(manager) {
 
     setupUi(this);
 
@@ -37,8 +38,6 @@ caption_settings_widget(manager.get_settings()) {
     QObject::connect(this->settingsToolButton, &QToolButton::clicked, this, &CaptionMainWidget::show_settings_widget);
     statusTextLabel->hide();
     
-    QObject::connect(&caption_settings_widget, &CaptionSettingsWidget::settings_accepted, this, &CaptionMainWidget::accept_widget_settings);
-    QObject::connect(&caption_settings_widget, &CaptionSettingsWidget::preview_requested, this &CaptionMainWidget::show_self);
     QObject::connect(&manager.source_captioner, &CaptionSource::caption_result_received, this, &CaptionMainWidget::handle_caption_data_cb, Qt::QueuedConnection);
     QObject::connect(&manager.source_captioner, &CaptionSource::caption_source_status_changed, this, &CaptionMainWidget::handle_caption_source_status_change, Qt::QueuedConnection);
     QObject::connect(&manager.source_captioner, &CaptionSource::settings_changed, this, &CaptionMainWidget::settings_changed_event);
@@ -66,7 +65,7 @@ void CaptionMainWidget::update_caption_text_ui() {
 
     auto latest_caption_result = std::get<0>(*latest_caption_result_tup);
     bool was_cleared = std::get<1>(*latest_caption_result_tup);
-    std::string latest_caption_text_history = std::get<2>(*latest_caption_result_tup);
+    const auto &latest_caption_text_history = std::get<2>(*latest_caption_result_tup);
 
     if (was_cleared) {
         this->captionLinesPlainTextEdit->clear();
@@ -82,15 +81,31 @@ void CaptionMainWidget::update_caption_text_ui() {
         this->captionLinesPlainTextEdit->setPlainText(QString::fromStdString(single_caption_line));
     }
 
-    this->captionHistoryPlainTextEdit->setPlainText(latest_caption_text_history.c_str());
+    if (latest_caption_text_history)
+        this->captionHistoryPlainTextEdit->setPlainText(QString::fromStdString(*latest_caption_text_history));
+    else
+        this->captionHistoryPlainTextEdit->clear();
 }
 
 void CaptionMainWidget::external_state_changed() {
     manager.external_state_changed(is_streaming_live(), is_recording_live(), is_virtualcam_on());
 }
 
+CaptionSettingsWidget &CaptionMainWidget::settings_widget() {
+    if (!caption_settings_widget) {
+        const auto started_at = std::chrono::steady_clock::now();
+        caption_settings_widget = std::make_unique<CaptionSettingsWidget>(manager.get_settings());
+        QObject::connect(caption_settings_widget.get(), &CaptionSettingsWidget::settings_accepted, this, &CaptionMainWidget::accept_widget_settings);
+        QObject::connect(caption_settings_widget.get(), &CaptionSettingsWidget::preview_requested, this, &CaptionMainWidget::show_self);
+        spdlog::debug("CaptionMainWidget settings widget built in {} ms",
+                      std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started_at).count());
+    }
+    return *caption_settings_widget;
+}
+
 void CaptionMainWidget::scene_collection_changed() {
-    caption_settings_widget.hide();
+    if (caption_settings_widget)
+        caption_settings_widget->hide();
 }
 
 void CaptionMainWidget::stream_started_event() {
@@ -123,8 +138,8 @@ void CaptionMainWidget::virtualcam_stopped_event() {
     external_state_changed();
 }
 
-void CaptionMainWidget::handle_caption_data_cb(std::shared_ptr<OutputCaptionResult> caption_result, bool cleared, std::string recent_caption_text) {
-    latest_caption_result_tup = std::make_unique<CaptionResultTup>(caption_result, cleared, recent_caption_text);
+void CaptionMainWidget::handle_caption_data_cb(std::shared_ptr<OutputCaptionResult> caption_result, bool cleared, backend::RecentCaptionTextPtr recent_caption_text) {
+    latest_caption_result_tup = std::make_unique<CaptionResultTup>(caption_result, cleared, std::move(recent_caption_text));
     if (isVisible())
         this->update_caption_text_ui();
 }
@@ -136,19 +151,21 @@ void CaptionMainWidget::show_self() {
 
 void CaptionMainWidget::show_settings_widget() {
     spdlog::debug("CaptionMainWidget show_settings_widget");
-    if (caption_settings_widget.isHidden()) {
+    CaptionSettingsWidget &widget = settings_widget();
+    if (widget.isHidden()) {
         spdlog::debug("updating caption widget settings");
-        caption_settings_widget.set_settings(manager.plugin_settings);
+        widget.set_settings(manager.plugin_settings);
     }
 
-    caption_settings_widget.show();
-    caption_settings_widget.raise();
+    widget.show();
+    widget.raise();
 }
 
 void CaptionMainWidget::accept_widget_settings(CaptionSettings new_settings) {
-    spdlog::info("CaptionMainWidget accept_widget_settings: {}", &caption_settings_widget);
+    spdlog::info("CaptionMainWidget accept_widget_settings: {}", (void *) caption_settings_widget.get());
     new_settings.print();
-    caption_settings_widget.hide();
+    if (caption_settings_widget)
+        caption_settings_widget->hide();
     manager.update_settings(new_settings);
 }
 
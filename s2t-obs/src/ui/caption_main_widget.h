@@ -22,6 +22,8 @@
 #include "caption_manager.h"
 #include "caption_settings_widget.h"
 
+#include <memory>
+
 #include <QWidget>
 #include <spdlog/spdlog.h>
 #include <blockingconcurrentqueue.h>
@@ -29,12 +31,13 @@
 
 namespace ui {
 
-typedef std::tuple<std::shared_ptr<CaptionResult>, bool, std::string> CaptionResultTup;
+typedef std::tuple<std::shared_ptr<CaptionResult>, bool, backend::RecentCaptionTextPtr> CaptionResultTup;
 
 class CaptionMainWidget : public QWidget, Ui_CaptionMainWidget {
 Q_OBJECT
     CaptionManager &manager;
-    CaptionSettingsWidget caption_settings_widget;
+    // built the first time it's opened, its comboboxes are slow to set up
+    std::unique_ptr<CaptionSettingsWidget> caption_settings_widget;
     std::unique_ptr<CaptionResultTup> latest_caption_result_tup;
 
 signals:
@@ -45,9 +48,10 @@ private:
     void hideEvent(QShowEvent *event) override;
     void do_process_item_queue();
     void accept_widget_settings(CaptionSettings new_settings);
-    void handle_caption_data_cb(std::shared_ptr<OutputCaptionResult> caption_result, bool cleared, std::string recent_catpion_text);
+    void handle_caption_data_cb(std::shared_ptr<OutputCaptionResult> caption_result, bool cleared, backend::RecentCaptionTextPtr recent_caption_text);
     void handle_caption_source_status_change(std::shared_ptr<CaptionSourceStatus> status);
     void settings_changed_event(CaptionSettings &settings);
+    CaptionSettingsWidget &settings_widget();
 
 public slots:
     void show_settings_widget();
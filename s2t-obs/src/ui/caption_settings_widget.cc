@@ -16,6 +16,7 @@
 
 #include "backend/settings.h"
 
+#include <QCheckBox>
 #include <QLineEdit>
 #include <QFileDialog>
 
@@ -163,6 +164,14 @@ CaptionSettingsWidget::CaptionSettingsWidget(const CaptionSettings &latests_sett
     setup_combobox_capitalization(*srtCapitalizationComboBox);
     setup_combobox_output_target(*outputTargetComboBox);
     setup_combobox_transcript_format(*transcriptFormatComboBox);
+    for (int i = 0; i < transcriptFormatComboBox->count(); i++) {
+        auto checkBox = new QCheckBox(transcriptFormatComboBox->itemData(i).toString(), transcriptExtraFormatsWidget);
+        checkBox->setToolTip(transcriptFormatComboBox->itemText(i));
+        checkBox->setProperty("format", transcriptFormatComboBox->itemData(i));
+        transcriptExtraFormatsWidget->layout()->addWidget(checkBox);
+        transcriptExtraFormatCheckBoxes.push_back(checkBox);
+        QObject::connect(checkBox, &QCheckBox::toggled, this, [this]() { transcript_format_index_change(0); });
+    }
 
     setup_combobox_recording_filename(*recordingTranscriptFilenameComboBox);
     setup_combobox_streaming_filename(*streamingTranscriptFilenameComboBox);
@@ -277,11 +286,21 @@ void CaptionSettingsWidget::update_scene_collection_ui(const std::string &use_sc
 }
 
 void CaptionSettingsWidget::transcript_format_index_change(int new_index) {
-    const bool isSrt = transcriptFormatComboBox->currentData().toString().toStdString() == "srt";
-    transcriptSrtSettingsWidget->setVisible(isSrt);
-
     const auto format = transcriptFormatComboBox->currentData().toString().toStdString();
     const QString extension = QString::fromStdString(transcript_format_extension(format, "[ext]"));
+
+    // the main format is always written
+    // srt and vtt share the subtitle settings
+    bool isSrt = format == "srt" || format == "vtt";
+    for (auto checkBox: transcriptExtraFormatCheckBoxes) {
+        const auto checkbox_format = checkBox->property("format").toString().toStdString();
+        const bool is_main_format = checkbox_format == format;
+        checkBox->setVisible(!is_main_format);
+        if (!is_main_format && checkBox->isChecked() && (checkbox_format == "srt" || checkbox_format == "vtt"))
+            isSrt = true;
+    }
+    transcriptSrtSettingsWidget->setVisible(isSrt);
+
     update_combobox_recording_filename(*recordingTranscriptFilenameComboBox, extension);
     update_combobox_streaming_filename(*streamingTranscriptFilenameComboBox, extension);
     update_combobox_virtualcam_filename(*virtualcamTranscriptFilenameComboBox, extension);
@@ -377,11 +396,20 @@ void CaptionSettingsWidget::accept_current_settings() {
 
     transcript_settings.output_path = transcriptFolderPathLineEdit->text().toStdString();
     transcript_settings.format = transcriptFormatComboBox->currentData().toString().toStdString();
+    transcript_settings.extra_formats.clear();
+    for (auto checkBox: transcriptExtraFormatCheckBoxes) {
+        const auto extra_format = checkBox->property("format").toString().toStdString();
+        if (checkBox->isChecked() && extra_format != transcript_settings.format)
+            transcript_settings.extra_formats.push_back(extra_format);
+    }
     transcript_settings.srt_target_duration_secs = srtDurationSpinBox->value();
     transcript_settings.srt_target_line_length = srtLineLengthSpinBox->value();
     transcript_settings.srt_add_punctuation = srtAddPunctuationCheckBox->isChecked();
     transcript_settings.srt_split_single_sentences = srtSplitSentencesCheckBox->isChecked();
     transcript_settings.srt_capitalization = (CapitalizationType) srtCapitalizationComboBox->currentData().toInt();
+    transcript_settings.segment_minutes = transcriptSegmentMinutesSpinBox->value();
+    transcript_settings.segment_megabytes = transcriptSegmentMegabytesSpinBox->value();
+    transcript_settings.segment_compress = transcriptSegmentCompressCheckBox->isChecked();
 
     transcript_settings.recording_filename_type = recordingTranscriptFilenameComboBox->currentData().toString().toStdString();
     transcript_settings.recording_filename_custom = recordingTranscriptCustomNameOverwriteLineEdit->text().toStdString();
@@ -437,12 +465,20 @@ void CaptionSettingsWidget::updateUi() {
 
     transcriptFolderPathLineEdit->setText(QString::fromStdString(source_settings.transcript_settings.output_path));
     combobox_set_data_str(*transcriptFormatComboBox, source_settings.transcript_settings.format.c_str(), 0);
+    const auto &extra_formats = source_settings.transcript_settings.extra_formats;
+    for (auto checkBox: transcriptExtraFormatCheckBoxes) {
+        const auto extra_format = checkBox->property("format").toString().toStdString();
+        checkBox->setChecked(std::find(extra_formats.begin(), extra_formats.end(), extra_format) != extra_formats.end());
+    }
     transcript_format_index_change(0);
     srtDurationSpinBox->setValue(source_settings.transcript_settings.srt_target_duration_secs);
     srtLineLengthSpinBox->setValue(source_settings.transcript_settings.srt_target_line_length);
     srtAddPunctuationCheckBox->setChecked(source_settings.transcript_settings.srt_add_punctuation);
     srtSplitSentencesCheckBox->setChecked(source_settings.transcript_settings.srt_split_single_sentences);
     combobox_set_data_int(*srtCapitalizationComboBox, source_settings.transcript_settings.srt_capitalization, 0);
+    transcriptSegmentMinutesSpinBox->setValue(source_settings.transcript_settings.segment_minutes);
+    transcriptSegmentMegabytesSpinBox->setValue(source_settings.transcript_settings.segment_megabytes);
+    transcriptSegmentCompressCheckBox->setChecked(source_settings.transcript_settings.segment_compress);
 
     combobox_set_data_str(*recordingTranscriptFilenameComboBox, source_settings.transcript_settings.recording_filename_type.c_str(), 0);
     combobox_set_data_str(*recordingTranscriptCustomNameExistsCombobox,
@@ -34,6 +34,7 @@ Q_OBJECT
     CaptionSettingsWidget current_settings;
     std::string scene_collection_name;
     OpenCaptionSettingsList *caption_settings_widget;
+    std::vector<QCheckBox *> transcriptExtraFormatCheckBoxes;
 
     void accept_current_settings();
 
@@ -11,6 +11,7 @@
 #include "backend/overlapping_caption.h"
 #include "ui.h"
 #include "storage.h"
+#include "strings.h"
 
 namespace utils {
 
@@ -57,6 +58,8 @@ static CaptionFormatSettings default_CaptionFormatSettings() {
         emptyDefaultReplacer(),
         true,
         15.0,
+        10,
+        0.0,
     };
 }
 
@@ -74,11 +77,48 @@ static SceneCollectionSettings default_SceneCollectionSettings() {
     };
 }
 
+// extra transcript formats are stored as "srt,txt"
+static std::string join_transcript_formats(const std::vector<std::string> &formats) {
+    std::string joined;
+    join_strings(formats, ",", joined);
+    return joined;
+}
+
+static std::vector<std::string> split_transcript_formats(const std::string &joined) {
+    std::vector<std::string> formats;
+    for (const auto &format: QString::fromStdString(joined).split(',', Qt::SkipEmptyParts))
+        formats.push_back(format.trimmed().toStdString());
+    return formats;
+}
+
+// worker cpus are stored as "0,2,3"
+static std::string join_worker_cpus(const std::vector<uint> &cpus) {
+    std::vector<std::string> cpu_strings;
+    for (const uint cpu: cpus)
+        cpu_strings.push_back(std::to_string(cpu));
+
+    std::string joined;
+    join_strings(cpu_strings, ",", joined);
+    return joined;
+}
+
+static std::vector<uint> split_worker_cpus(const std::string &joined) {
+    std::vector<uint> cpus;
+    for (const auto &cpu_string: QString::fromStdString(joined).split(',', Qt::SkipEmptyParts)) {
+        bool ok = false;
+        const uint cpu = cpu_string.trimmed().toUInt(&ok);
+        if (ok)
+            cpus.push_back(cpu);
+    }
+    return cpus;
+}
+
 static TranscriptOutputSettings default_TranscriptOutputSettings() {
     return {
         false,
         "",
         "srt",
+        {},
         "recording",
         "",
         "append",
@@ -96,6 +136,9 @@ static TranscriptOutputSettings default_TranscriptOutputSettings() {
         true,
         true,
         true,
+        0,
+        0,
+        true,
     };
 }
 
@@ -129,6 +172,12 @@ static void enforce_CaptionPluginSettings_values(PluginSettings &settings) {
     if (source_settings.format_settings.caption_line_count <= 0 || source_settings.format_settings.caption_line_count > 4)
         source_settings.format_settings.caption_line_count = 1;
 
+    if (source_settings.format_settings.interim_updates_per_second > 60)
+        source_settings.format_settings.interim_updates_per_second = 60;
+
+    if (source_settings.format_settings.interim_min_stability < 0.0 || source_settings.format_settings.interim_min_stability > 1.0)
+        source_settings.format_settings.interim_min_stability = 0.0;
+
     if (source_settings.format_settings.capitalization < 0 || source_settings.format_settings.capitalization > 2)
         source_settings.format_settings.capitalization = (CapitalizationType) 0;
 
@@ -136,6 +185,20 @@ static void enforce_CaptionPluginSettings_values(PluginSettings &settings) {
         || source_settings.transcript_settings.srt_capitalization > 2)
         source_settings.transcript_settings.srt_capitalization = (CapitalizationType) 0;
 
+    if (source_settings.transcript_settings.segment_minutes > 7 * 24 * 60)
+        source_settings.transcript_settings.segment_minutes = 0;
+
+    if (source_settings.transcript_settings.segment_megabytes > 4096)
+        source_settings.transcript_settings.segment_megabytes = 0;
+
+    if (settings.shutdown_budget_ms < 100 || settings.shutdown_budget_ms > 60000)
+        settings.shutdown_budget_ms = PLUGIN_SHUTDOWN_BUDGET_MS;
+
+    for (auto &role_settings: settings.worker_settings.roles) {
+        if (role_settings.nice < -20 || role_settings.nice > 19)
+            role_settings.nice = 0;
+    }
+
     // backwards compatibility with old settings that had off, mild, strict instead off/on.
     // ensure old strict/2 falls back to on/1 not off/0 default.
     if (source_settings.stream_settings.stream_settings.profanity_filter == 2)
@@ -265,6 +328,8 @@ static CaptionPluginSettings get_CaptionPluginSettings_from_data(obs_data_t *loa
 
     obs_data_set_default_double(load_data, "caption_timeout_secs", source_settings.format_settings.caption_timeout_seconds);
     obs_data_set_default_bool(load_data, "caption_timeout_enabled", source_settings.format_settings.caption_timeout_enabled);
+    obs_data_set_default_int(load_data, "caption_interim_updates_per_second", source_settings.format_settings.interim_updates_per_second);
+    obs_data_set_default_double(load_data, "caption_interim_min_stability", source_settings.format_settings.interim_min_stability);
 
     obs_data_set_default_bool(load_data, "transcript_enabled", source_settings.transcript_settings.enabled);
     obs_data_set_default_bool(load_data, "transcript_for_stream_enabled",
@@ -275,6 +340,8 @@ static CaptionPluginSettings get_CaptionPluginSettings_from_data(obs_data_t *loa
                               source_settings.transcript_settings.virtualcam_transcripts_enabled);
     obs_data_set_default_string(load_data, "transcript_folder_path", source_settings.transcript_settings.output_path.c_str());
     obs_data_set_default_string(load_data, "transcript_format", source_settings.transcript_settings.format.c_str());
+    obs_data_set_default_string(load_data, "transcript_extra_formats",
+                                join_transcript_formats(source_settings.transcript_settings.extra_formats).c_str());
 
     obs_data_set_default_string(load_data, "transcript_recording_name_type",
                                 source_settings.transcript_settings.recording_filename_type.c_str());
@@ -308,6 +375,12 @@ static CaptionPluginSettings get_CaptionPluginSettings_from_data(obs_data_t *loa
                               source_settings.transcript_settings.srt_split_single_sentences);
     obs_data_set_default_int(load_data, "transcript_srt_capitalization",
                              source_settings.transcript_settings.srt_capitalization);
+    obs_data_set_default_int(load_data, "transcript_segment_minutes",
+                             source_settings.transcript_settings.segment_minutes);
+    obs_data_set_default_int(load_data, "transcript_segment_megabytes",
+                             source_settings.transcript_settings.segment_megabytes);
+    obs_data_set_default_bool(load_data, "transcript_segment_compress",
+                              source_settings.transcript_settings.segment_compress);
 
     settings.enabled = obs_data_get_bool(load_data, "enabled");
     source_settings.streaming_output_enabled = obs_data_get_bool(load_data, "streaming_output_enabled");
@@ -326,6 +399,8 @@ static CaptionPluginSettings get_CaptionPluginSettings_from_data(obs_data_t *loa
 
     source_settings.format_settings.caption_timeout_enabled = obs_data_get_bool(load_data, "caption_timeout_enabled");
     source_settings.format_settings.caption_timeout_seconds = obs_data_get_double(load_data, "caption_timeout_secs");
+    source_settings.format_settings.interim_updates_per_second = (uint) obs_data_get_int(load_data, "caption_interim_updates_per_second");
+    source_settings.format_settings.interim_min_stability = obs_data_get_double(load_data, "caption_interim_min_stability");
 
 
     auto word_reps = std::vector<Filter>();
@@ -358,6 +433,8 @@ static CaptionPluginSettings get_CaptionPluginSettings_from_data(obs_data_t *loa
 
     source_settings.transcript_settings.output_path = obs_data_get_string(load_data, "transcript_folder_path");
     source_settings.transcript_settings.format = obs_data_get_string(load_data, "transcript_format");
+    source_settings.transcript_settings.extra_formats = split_transcript_formats(
+            obs_data_get_string(load_data, "transcript_extra_formats"));
 
     source_settings.transcript_settings.recording_filename_type = obs_data_get_string(load_data, "transcript_recording_name_type");
     source_settings.transcript_settings.recording_filename_custom = obs_data_get_string(load_data, "transcript_recording_name_custom");
@@ -377,6 +454,24 @@ static CaptionPluginSettings get_CaptionPluginSettings_from_data(obs_data_t *loa
     source_settings.transcript_settings.srt_split_single_sentences = obs_data_get_bool(load_data, "transcript_srt_split_single_sentences");
     source_settings.transcript_settings.srt_capitalization = (CapitalizationType) obs_data_get_int(load_data,
                                                                                                    "transcript_srt_capitalization");
+    source_settings.transcript_settings.segment_minutes = obs_data_get_int(load_data, "transcript_segment_minutes");
+    source_settings.transcript_settings.segment_megabytes = obs_data_get_int(load_data, "transcript_segment_megabytes");
+    source_settings.transcript_settings.segment_compress = obs_data_get_bool(load_data, "transcript_segment_compress");
+
+    obs_data_set_default_int(load_data, "shutdown_budget_ms", settings.shutdown_budget_ms);
+    settings.shutdown_budget_ms = obs_data_get_int(load_data, "shutdown_budget_ms");
+
+    // "worker_[role]_nice", "worker_[role]_cpus", no UI, only for tuning by hand
+    for (int role = 0; role < backend::WORKER_ROLE_COUNT; role++) {
+        backend::WorkerRoleSettings &role_settings = settings.worker_settings.roles[role];
+        const std::string key_prefix = std::string("worker_") + backend::worker_role_name((backend::WorkerRole) role);
+
+        obs_data_set_default_int(load_data, (key_prefix + "_nice").c_str(), role_settings.nice);
+        obs_data_set_default_string(load_data, (key_prefix + "_cpus").c_str(), join_worker_cpus(role_settings.cpus).c_str());
+
+        role_settings.nice = obs_data_get_int(load_data, (key_prefix + "_nice").c_str());
+        role_settings.cpus = split_worker_cpus(obs_data_get_string(load_data, (key_prefix + "_cpus").c_str()));
+    }
 
     enforce_CaptionPluginSettings_values(settings);
 
@@ -404,6 +499,8 @@ static void set_CaptionPluginSettings_on_data(obs_data_t *save_data, const Plugi
 
     obs_data_set_bool(save_data, "caption_timeout_enabled", source_settings.format_settings.caption_timeout_enabled);
     obs_data_set_double(save_data, "caption_timeout_secs", source_settings.format_settings.caption_timeout_seconds);
+    obs_data_set_int(save_data, "caption_interim_updates_per_second", source_settings.format_settings.interim_updates_per_second);
+    obs_data_set_double(save_data, "caption_interim_min_stability", source_settings.format_settings.interim_min_stability);
 
     set_WordReplacements(save_data, source_settings.format_settings.replacer.user_replacements());
 
@@ -418,6 +515,8 @@ static void set_CaptionPluginSettings_on_data(obs_data_t *save_data, const Plugi
                       settings.source_cap_settings.transcript_settings.virtualcam_transcripts_enabled);
     obs_data_set_string(save_data, "transcript_folder_path", settings.source_cap_settings.transcript_settings.output_path.c_str());
     obs_data_set_string(save_data, "transcript_format", settings.source_cap_settings.transcript_settings.format.c_str());
+    obs_data_set_string(save_data, "transcript_extra_formats",
+                        join_transcript_formats(settings.source_cap_settings.transcript_settings.extra_formats).c_str());
 
     obs_data_set_string(save_data, "transcript_recording_name_type",
                         settings.source_cap_settings.transcript_settings.recording_filename_type.c_str());
@@ -451,6 +550,22 @@ static void set_CaptionPluginSettings_on_data(obs_data_t *save_data, const Plugi
                       settings.source_cap_settings.transcript_settings.srt_split_single_sentences);
     obs_data_set_int(save_data, "transcript_srt_capitalization",
                      settings.source_cap_settings.transcript_settings.srt_capitalization);
+    obs_data_set_int(save_data, "transcript_segment_minutes",
+                     settings.source_cap_settings.transcript_settings.segment_minutes);
+    obs_data_set_int(save_data, "transcript_segment_megabytes",
+                     settings.source_cap_settings.transcript_settings.segment_megabytes);
+    obs_data_set_bool(save_data, "transcript_segment_compress",
+                      settings.source_cap_settings.transcript_settings.segment_compress);
+
+    obs_data_set_int(save_data, "shutdown_budget_ms", settings.shutdown_budget_ms);
+
+    for (int role = 0; role < backend::WORKER_ROLE_COUNT; role++) {
+        const backend::WorkerRoleSettings &role_settings = settings.worker_settings.roles[role];
+        const std::string key_prefix = std::string("worker_") + backend::worker_role_name((backend::WorkerRole) role);
+
+        obs_data_set_int(save_data, (key_prefix + "_nice").c_str(), role_settings.nice);
+        obs_data_set_string(save_data, (key_prefix + "_cpus").c_str(), join_worker_cpus(role_settings.cpus).c_str());
+    }
 
     obs_data_set_string(save_data, "plugin_version", VERSION_STRING);
 }
@@ -608,9 +723,11 @@ static void setup_combobox_transcript_format(QComboBox &comboBox) {
         comboBox.removeItem(0);
 
     comboBox.addItem("SubRip Subtitle (.srt) ", "srt");
+    comboBox.addItem("WebVTT Subtitle (.vtt)", "vtt");
     comboBox.addItem("Text with timestamps (.txt)", "txt");
     comboBox.addItem("Text only (.txt)", "txt_plain");
     comboBox.addItem("Raw (For Debug/Tools, Very Spammy, .log)", "raw");
+    comboBox.addItem("Caption Journal (export any format later, .s2tj)", "journal");
 }
 
 
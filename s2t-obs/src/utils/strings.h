@@ -15,9 +15,9 @@
 #ifndef OBS_SPEECH2TEXT_PLUGIN_STRINGS_H
 #define OBS_SPEECH2TEXT_PLUGIN_STRINGS_H
 
-#include <QVector>
-#include <QStringList>
-#include <QTextBoundaryFinder>
+#include <string_view>
+
+#include "unicode.h"
 
 namespace utils {
 
@@ -35,86 +35,106 @@ static void lstrip(std::string &s) {
     }));
 }
 
-static bool isAscii(const std::string &text) {
-    for (auto c: text) {
-        if (static_cast<unsigned char>(c) > 127) {
-            return false;
+static void split_into_lines_utf8_valid(vector<string> &output_lines, std::string_view text, const uint max_line_length) {
+    // Words are runs of non whitespace, any whitespace run between them counts as a single space.
+    // Lengths are in UTF-16 code units and words longer than a line get split between grapheme clusters.
+    string line;
+    uint line_length = 0;
+
+    size_t pos = 0;
+    while (pos < text.size()) {
+        char32_t cp;
+        size_t next_pos = pos;
+        utf8_decode(text, next_pos, cp);
+        if (is_unicode_space(cp)) {
+            pos = next_pos;
+            continue;
         }
-    }
-    return true;
-}
-
-static void splitSmallest(QVector<QString> &out_chars, const QString &word) {
-    QTextBoundaryFinder test(QTextBoundaryFinder::Grapheme, word);
-    int start = 0;
-    while (test.toNextBoundary() != -1 && test.position() <= word.length()) {
-        out_chars.push_back(word.mid(start, test.position() - start));
-        start = test.position();
-    }
-
-    for (int i = 0; i < out_chars.length(); i++) {
-    }
-}
-
-static void split_into_lines_unicode_ish(vector<string> &output_lines, const string &text, const uint max_line_length) {
-    QString qtext = QString::fromStdString(text).simplified();
 
-    QStringList words = qtext.split(QRegExp("\\s+"));
-    uint cnt = 0;
-
-    QString line;
-    for (auto word: words) {
+        const size_t word_start = pos;
+        uint word_length = 0;
+        while (pos < text.size()) {
+            next_pos = pos;
+            utf8_decode(text, next_pos, cp);
+            if (is_unicode_space(cp))
+                break;
+            word_length += utf16_length(cp);
+            pos = next_pos;
+        }
+        const std::string_view word = text.substr(word_start, pos - word_start);
 
-        int new_len = line.size() + (line.isEmpty() ? 0 : 1) + word.size();
+        const uint new_len = line_length + (line.empty() ? 0 : 1) + word_length;
         if (new_len <= max_line_length) {
             // still fits into line
-            if (!line.isEmpty())
-                line.append(" ");
+            if (!line.empty()) {
+                line.push_back(' ');
+                line_length++;
+            }
             line.append(word);
-        } else {
-            if (word.length() > max_line_length) {
-                // current word longer than single line, split
+            line_length += word_length;
+            continue;
+        }
 
-                if (!line.isEmpty()) {
-                    if (line.length() + 2 <= max_line_length) {
-                        // enough space for " " and more
-                        line.append(" ");
-                    } else {
-                        // current line is full (or would be with added space),
-                        // add it and clear
-                        output_lines.push_back(line.toStdString());
-                        line = "";
-                    }
-                }
+        if (word_length <= max_line_length) {
+            if (!line.empty())
+                output_lines.push_back(line);
+            line.assign(word);
+            line_length = word_length;
+            continue;
+        }
 
-                QVector<QString> gms;
-                splitSmallest(gms, word);
+        // current word longer than single line, split
+        if (!line.empty()) {
+            if (line_length + 2 <= max_line_length) {
+                // enough space for " " and more
+                line.push_back(' ');
+                line_length++;
+            } else {
+                // current line is full (or would be with added space),
+                // add it and clear
+                output_lines.push_back(line);
+                line.clear();
+                line_length = 0;
+            }
+        }
 
-                for (auto i: gms) {
-                    if (line.length() + i.length() <= max_line_length) {
-                        line.append(i);
-                    } else {
-                        output_lines.push_back(line.toStdString());
-                        line = i;
-                    }
-                }
+        GraphemeCursor graphemes(word);
+        std::string_view cluster;
+        while (const uint cluster_length = graphemes.next(cluster)) {
+            if (line.empty() || line_length + cluster_length <= max_line_length) {
+                // a cluster wider than a line gets one of its own
+                line.append(cluster);
+                line_length += cluster_length;
             } else {
-                if (!line.isEmpty())
-                    output_lines.push_back(line.toStdString());
-                line = word;
+                output_lines.push_back(line);
+                line.assign(cluster);
+                line_length = cluster_length;
             }
         }
     }
 
-    if (!line.isEmpty())
-        output_lines.push_back(line.toStdString());
+    if (!line.empty())
+        output_lines.push_back(line);
+}
+
+static void split_into_lines_utf8(vector<string> &output_lines, std::string_view text, const uint max_line_length) {
+    if (is_valid_utf8(text)) {
+        split_into_lines_utf8_valid(output_lines, text, max_line_length);
+        return;
+    }
+    split_into_lines_utf8_valid(output_lines, sanitized_utf8(text), max_line_length);
 }
 
-static void split_into_lines_ascii(vector<string> &output_lines, const string &text, const uint max_line_length) {
-    istringstream stream(text);
-    string word;
+static void split_into_lines_ascii(vector<string> &output_lines, std::string_view text, const uint max_line_length) {
     string line;
-    while (getline(stream, word, ' ')) {
+    size_t word_start = 0;
+    while (word_start <= text.size()) {
+        size_t word_end = text.find(' ', word_start);
+        if (word_end == std::string_view::npos)
+            word_end = text.size();
+
+        const std::string_view word = text.substr(word_start, word_end - word_start);
+        word_start = word_end + 1;
         if (word.empty())
             continue;
 
@@ -163,12 +183,12 @@ static void split_into_lines_ascii(vector<string> &output_lines, const string &t
 }
 
 
-static void split_into_lines(vector<string> &output_lines, const string &text, const uint max_line_length) {
+static void split_into_lines(vector<string> &output_lines, std::string_view text, const uint max_line_length) {
     // Split into multiple lines, none longer than [max_line_length].
     // Only splits a word if the word itself is longer than max_line_length.
 
-    if (!isAscii(text)) {
-        split_into_lines_unicode_ish(output_lines, text, max_line_length);
+    if (!is_ascii(text)) {
+        split_into_lines_utf8(output_lines, text, max_line_length);
         return;
     }
     split_into_lines_ascii(output_lines, text, max_line_length);
@@ -0,0 +1,272 @@
+// Copyright 2022 gab
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef OBS_SPEECH2TEXT_PLUGIN_UNICODE_H
+#define OBS_SPEECH2TEXT_PLUGIN_UNICODE_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+#include "unicode_tables.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define S2T_HAS_SSE2 1
+#endif
+
+namespace utils {
+
+// Minimal UTF-8 helpers for caption line splitting, so non ASCII text doesn't need a round trip through QString.
+// Line lengths are counted in UTF-16 code units, same as QString::length(), to keep the existing line wrapping.
+
+#define UNICODE_REPLACEMENT_CHARACTER_UTF8 "\xEF\xBF\xBD"
+
+static bool is_ascii(std::string_view text) {
+    const char *data = text.data();
+    size_t size = text.size();
+    size_t i = 0;
+
+#if S2T_HAS_SSE2
+    for (; i + 16 <= size; i += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        if (_mm_movemask_epi8(chunk))
+            return false;
+    }
+#endif
+
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        memcpy(&word, data + i, sizeof(word));
+        if (word & 0x8080808080808080ULL)
+            return false;
+    }
+
+    for (; i < size; i++) {
+        if (static_cast<unsigned char>(data[i]) > 127)
+            return false;
+    }
+    return true;
+}
+
+// Decodes the code point at pos and moves pos past it.
+// Returns false for invalid/truncated sequences, pos is then moved by a single byte.
+static bool utf8_decode(std::string_view text, size_t &pos, char32_t &code_point) {
+    const auto lead = static_cast<unsigned char>(text[pos]);
+    size_t length;
+    char32_t cp;
+
+    if (lead < 0x80) {
+        code_point = lead;
+        pos++;
+        return true;
+    } else if (lead >= 0xC2 && lead <= 0xDF) {
+        length = 2;
+        cp = lead & 0x1F;
+    } else if (lead >= 0xE0 && lead <= 0xEF) {
+        length = 3;
+        cp = lead & 0x0F;
+    } else if (lead >= 0xF0 && lead <= 0xF4) {
+        length = 4;
+        cp = lead & 0x07;
+    } else {
+        pos++;
+        return false;
+    }
+
+    if (pos + length > text.size()) {
+        pos++;
+        return false;
+    }
+
+    for (size_t i = 1; i < length; i++) {
+        const auto cont = static_cast<unsigned char>(text[pos + i]);
+        if ((cont & 0xC0) != 0x80) {
+            pos++;
+            return false;
+        }
+        cp = (cp << 6) | (cont & 0x3F);
+    }
+
+    // overlong encodings, surrogates and out of range values
+    if ((length == 3 && cp < 0x800) || (length == 4 && (cp < 0x10000 || cp > 0x10FFFF))
+        || (cp >= 0xD800 && cp <= 0xDFFF)) {
+        pos++;
+        return false;
+    }
+
+    code_point = cp;
+    pos += length;
+    return true;
+}
+
+static bool is_valid_utf8(std::string_view text) {
+    size_t pos = 0;
+    char32_t cp;
+    while (pos < text.size()) {
+        if (!utf8_decode(text, pos, cp))
+            return false;
+    }
+    return true;
+}
+
+// copy of text with every invalid byte replaced with U+FFFD, like QString::fromStdString() does
+static std::string sanitized_utf8(std::string_view text) {
+    std::string output;
+    output.reserve(text.size());
+
+    size_t pos = 0;
+    char32_t cp;
+    while (pos < text.size()) {
+        const size_t start = pos;
+        if (utf8_decode(text, pos, cp))
+            output.append(text.data() + start, pos - start);
+        else
+            output.append(UNICODE_REPLACEMENT_CHARACTER_UTF8);
+    }
+    return output;
+}
+
+static unsigned int utf16_length(char32_t code_point) {
+    return code_point >= 0x10000 ? 2 : 1;
+}
+
+// same set as QChar::isSpace()
+static bool is_unicode_space(char32_t cp) {
+    if (cp < 0x80)
+        return cp == ' ' || (cp >= 0x09 && cp <= 0x0D);
+
+    return cp == 0x85 || cp == 0xA0 || cp == 0x1680 || (cp >= 0x2000 && cp <= 0x200A)
+           || cp == 0x2028 || cp == 0x2029 || cp == 0x202F || cp == 0x205F || cp == 0x3000;
+}
+
+static GraphemeBreakProperty grapheme_break_property(char32_t cp) {
+    if (cp < 0x80) {
+        if (cp == '\r')
+            return GRAPHEME_CR;
+        if (cp == '\n')
+            return GRAPHEME_LF;
+        return cp < 0x20 || cp == 0x7F ? GRAPHEME_CONTROL : GRAPHEME_OTHER;
+    }
+
+    if (cp >= 0xAC00 && cp <= 0xD7A3)
+        return (cp - 0xAC00) % 28 == 0 ? GRAPHEME_LV : GRAPHEME_LVT;
+
+    // ranges are sorted, binary search
+    size_t low = 0;
+    size_t high = sizeof(GRAPHEME_BREAK_RANGES) / sizeof(GRAPHEME_BREAK_RANGES[0]);
+    while (low < high) {
+        const size_t mid = (low + high) / 2;
+        if (cp < GRAPHEME_BREAK_RANGES[mid].first)
+            high = mid;
+        else if (cp > GRAPHEME_BREAK_RANGES[mid].last)
+            low = mid + 1;
+        else
+            return GRAPHEME_BREAK_RANGES[mid].property;
+    }
+    return GRAPHEME_OTHER;
+}
+
+static bool is_grapheme_extend(GraphemeBreakProperty property) {
+    return property == GRAPHEME_EXTEND || property == GRAPHEME_CONJUNCT_EXTEND || property == GRAPHEME_CONJUNCT_LINKER;
+}
+
+struct GraphemeCursor {
+    // extended grapheme cluster iteration over valid UTF-8, UAX #29 of UNICODE_TABLES_VERSION plus the Indic
+    // conjunct rule (GB9c) of 15.1 that ICU already followed
+    std::string_view text;
+    size_t pos = 0;
+
+    explicit GraphemeCursor(std::string_view text) : text(text) {}
+
+    // moves to the end of the next cluster, returns its size in UTF-16 code units, 0 at the end of text
+    unsigned int next(std::string_view &cluster) {
+        if (pos >= text.size())
+            return 0;
+
+        const size_t start = pos;
+        char32_t cp = 0;
+        utf8_decode(text, pos, cp);
+        unsigned int units = utf16_length(cp);
+
+        GraphemeBreakProperty prev = grapheme_break_property(cp);
+        // for GB11, the text so far ends in Extended_Pictographic Extend*, or in that followed by a ZWJ
+        bool after_pictographic = prev == GRAPHEME_EXTENDED_PICTOGRAPHIC;
+        bool zwj_after_pictographic = false;
+        unsigned int regional_indicators = prev == GRAPHEME_REGIONAL_INDICATOR ? 1 : 0;
+        // for GB9c, the text so far ends in a consonant, then combining marks, one of them a virama
+        bool consonant = prev == GRAPHEME_CONJUNCT_CONSONANT;
+        bool consonant_linked = false;
+
+        while (pos < text.size()) {
+            size_t next_pos = pos;
+            utf8_decode(text, next_pos, cp);
+            const GraphemeBreakProperty cur = grapheme_break_property(cp);
+
+            bool join;
+            if (prev == GRAPHEME_CR)
+                join = cur == GRAPHEME_LF;                                                          // GB3, GB4
+            else if (prev == GRAPHEME_LF || prev == GRAPHEME_CONTROL)
+                join = false;                                                                       // GB4
+            else if (cur == GRAPHEME_CR || cur == GRAPHEME_LF || cur == GRAPHEME_CONTROL)
+                join = false;                                                                       // GB5
+            else if (prev == GRAPHEME_L
+                     && (cur == GRAPHEME_L || cur == GRAPHEME_V || cur == GRAPHEME_LV || cur == GRAPHEME_LVT))
+                join = true;                                                                        // GB6
+            else if ((prev == GRAPHEME_LV || prev == GRAPHEME_V) && (cur == GRAPHEME_V || cur == GRAPHEME_T))
+                join = true;                                                                        // GB7
+            else if ((prev == GRAPHEME_LVT || prev == GRAPHEME_T) && cur == GRAPHEME_T)
+                join = true;                                                                        // GB8
+            else if (is_grapheme_extend(cur) || cur == GRAPHEME_ZWJ || cur == GRAPHEME_SPACING_MARK)
+                join = true;                                                                        // GB9, GB9a
+            else if (prev == GRAPHEME_PREPEND)
+                join = true;                                                                        // GB9b
+            else if (cur == GRAPHEME_CONJUNCT_CONSONANT && consonant_linked)
+                join = true;                                                                        // GB9c
+            else if (prev == GRAPHEME_ZWJ && cur == GRAPHEME_EXTENDED_PICTOGRAPHIC)
+                join = zwj_after_pictographic;                                                      // GB11
+            else if (prev == GRAPHEME_REGIONAL_INDICATOR && cur == GRAPHEME_REGIONAL_INDICATOR)
+                join = regional_indicators % 2 == 1;                                                // GB12, GB13
+            else
+                join = false;                                                                       // GB999
+
+            if (!join)
+                break;
+
+            zwj_after_pictographic = cur == GRAPHEME_ZWJ && after_pictographic;
+            if (cur == GRAPHEME_EXTENDED_PICTOGRAPHIC)
+                after_pictographic = true;
+            else if (!is_grapheme_extend(cur))
+                after_pictographic = false;
+            if (cur == GRAPHEME_CONJUNCT_LINKER)
+                consonant_linked = consonant;
+            else if (cur != GRAPHEME_CONJUNCT_EXTEND && cur != GRAPHEME_ZWJ) {
+                consonant = cur == GRAPHEME_CONJUNCT_CONSONANT;
+                consonant_linked = false;
+            }
+            regional_indicators = cur == GRAPHEME_REGIONAL_INDICATOR ? regional_indicators + 1 : 0;
+
+            units += utf16_length(cp);
+            prev = cur;
+            pos = next_pos;
+        }
+
+        cluster = text.substr(start, pos - start);
+        return units;
+    }
+};
+}
+
+#endif //OBS_SPEECH2TEXT_PLUGIN_UNICODE_H
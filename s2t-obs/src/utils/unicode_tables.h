@@ -0,0 +1,795 @@
+// Copyright 2022 gab
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Generated by tools/gen_unicode_tables.cc from the Unicode 15.0 character database of ICU 72.1, don't edit.
+
+#ifndef OBS_SPEECH2TEXT_PLUGIN_UNICODE_TABLES_H
+#define OBS_SPEECH2TEXT_PLUGIN_UNICODE_TABLES_H
+
+namespace utils {
+
+#define UNICODE_TABLES_VERSION "15.0"
+
+// Grapheme_Cluster_Break, and Extended_Pictographic from emoji-data.txt, which never overlap.
+// Other and the Hangul syllables (LV, LVT) are left out.
+// For the Indic conjunct rule (GB9c): consonants of the scripts it covers, taken out of Other, and their
+// viramas and the other Extend code points with a non zero combining class, taken out of Extend.
+enum GraphemeBreakProperty {
+    GRAPHEME_OTHER,
+    GRAPHEME_CR,
+    GRAPHEME_LF,
+    GRAPHEME_CONTROL,
+    GRAPHEME_EXTEND,
+    GRAPHEME_ZWJ,
+    GRAPHEME_REGIONAL_INDICATOR,
+    GRAPHEME_PREPEND,
+    GRAPHEME_SPACING_MARK,
+    GRAPHEME_L,
+    GRAPHEME_V,
+    GRAPHEME_T,
+    GRAPHEME_LV,
+    GRAPHEME_LVT,
+    GRAPHEME_EXTENDED_PICTOGRAPHIC,
+    GRAPHEME_CONJUNCT_CONSONANT,
+    GRAPHEME_CONJUNCT_LINKER,
+    GRAPHEME_CONJUNCT_EXTEND,
+};
+
+struct GraphemeBreakRange {
+    char32_t first;
+    char32_t last;
+    GraphemeBreakProperty property;
+};
+
+static const GraphemeBreakRange GRAPHEME_BREAK_RANGES[] = {
+    {0x0000, 0x0009, GRAPHEME_CONTROL},
+    {0x000A, 0x000A, GRAPHEME_LF},
+    {0x000B, 0x000C, GRAPHEME_CONTROL},
+    {0x000D, 0x000D, GRAPHEME_CR},
+    {0x000E, 0x001F, GRAPHEME_CONTROL},
+    {0x007F, 0x009F, GRAPHEME_CONTROL},
+    {0x00A9, 0x00A9, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x00AD, 0x00AD, GRAPHEME_CONTROL},
+    {0x00AE, 0x00AE, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x0300, 0x034E, GRAPHEME_CONJUNCT_EXTEND},
+    {0x034F, 0x034F, GRAPHEME_EXTEND},
+    {0x0350, 0x036F, GRAPHEME_CONJUNCT_EXTEND},
+    {0x0483, 0x0487, GRAPHEME_CONJUNCT_EXTEND},
+    {0x0488, 0x0489, GRAPHEME_EXTEND},
+    {0x0591, 0x05BD, GRAPHEME_CONJUNCT_EXTEND},
+    {0x05BF, 0x05BF, GRAPHEME_CONJUNCT_EXTEND},
+    {0x05C1, 0x05C2, GRAPHEME_CONJUNCT_EXTEND},
+    {0x05C4, 0x05C5, GRAPHEME_CONJUNCT_EXTEND},
+    {0x05C7, 0x05C7, GRAPHEME_CONJUNCT_EXTEND},
+    {0x0600, 0x0605, GRAPHEME_PREPEND},
+    {0x0610, 0x061A, GRAPHEME_CONJUNCT_EXTEND},
+    {0x061C, 0x061C, GRAPHEME_CONTROL},
+    {0x064B, 0x065F, GRAPHEME_CONJUNCT_EXTEND},
+    {0x0670, 0x0670, GRAPHEME_CONJUNCT_EXTEND},
+    {0x06D6, 0x06DC, GRAPHEME_CONJUNCT_EXTEND},
+    {0x06DD, 0x06DD, GRAPHEME_PREPEND},
+    {0x06DF, 0x06E4, GRAPHEME_CONJUNCT_EXTEND},
+    {0x06E7, 0x06E8, GRAPHEME_CONJUNCT_EXTEND},
+    {0x06EA, 0x06ED, GRAPHEME_CONJUNCT_EXTEND},
+    {0x070F, 0x070F, GRAPHEME_PREPEND},
+    {0x0711, 0x0711, GRAPHEME_CONJUNCT_EXTEND},
+    {0x0730, 0x074A, GRAPHEME_CONJUNCT_EXTEND},
+    {0x07A6, 0x07B0, GRAPHEME_EXTEND},
+    {0x07EB, 0x07F3, GRAPHEME_CONJUNCT_EXTEND},
+    {0x07FD, 0x07FD, GRAPHEME_CONJUNCT_EXTEND},
+    {0x0816, 0x0819, GRAPHEME_CONJUNCT_EXTEND},
+    {0x081B, 0x0823, GRAPHEME_CONJUNCT_EXTEND},
+    {0x0825, 0x0827, GRAPHEME_CONJUNCT_EXTEND},
+    {0x0829, 0x082D, GRAPHEME_CONJUNCT_EXTEND},
+    {0x0859, 0x085B, GRAPHEME_CONJUNCT_EXTEND},
+    {0x0890, 0x0891, GRAPHEME_PREPEND},
+    {0x0898, 0x089F, GRAPHEME_CONJUNCT_EXTEND},
+    {0x08CA, 0x08E1, GRAPHEME_CONJUNCT_EXTEND},
+    {0x08E2, 0x08E2, GRAPHEME_PREPEND},
+    {0x08E3, 0x08FF, GRAPHEME_CONJUNCT_EXTEND},
+    {0x0900, 0x0902, GRAPHEME_EXTEND},
+    {0x0903, 0x0903, GRAPHEME_SPACING_MARK},
+    {0x0915, 0x0939, GRAPHEME_CONJUNCT_CONSONANT},
+    {0x093A, 0x093A, GRAPHEME_EXTEND},
+    {0x093B, 0x093B, GRAPHEME_SPACING_MARK},
+    {0x093C, 0x093C, GRAPHEME_CONJUNCT_EXTEND},
+    {0x093E, 0x0940, GRAPHEME_SPACING_MARK},
+    {0x0941, 0x0948, GRAPHEME_EXTEND},
+    {0x0949, 0x094C, GRAPHEME_SPACING_MARK},
+    {0x094D, 0x094D, GRAPHEME_CONJUNCT_LINKER},
+    {0x094E, 0x094F, GRAPHEME_SPACING_MARK},
+    {0x0951, 0x0954, GRAPHEME_CONJUNCT_EXTEND},
+    {0x0955, 0x0957, GRAPHEME_EXTEND},
+    {0x0958, 0x095F, GRAPHEME_CONJUNCT_CONSONANT},
+    {0x0962, 0x0963, GRAPHEME_EXTEND},
+    {0x0978, 0x097F, GRAPHEME_CONJUNCT_CONSONANT},
+    {0x0981, 0x0981, GRAPHEME_EXTEND},
+    {0x0982, 0x0983, GRAPHEME_SPACING_MARK},
+    {0x0995, 0x09A8, GRAPHEME_CONJUNCT_CONSONANT},
+    {0x09AA, 0x09B0, GRAPHEME_CONJUNCT_CONSONANT},
+    {0x09B2, 0x09B2, GRAPHEME_CONJUNCT_CONSONANT},
+    {0x09B6, 0x09B9, GRAPHEME_CONJUNCT_CONSONANT},
+    {0x09BC, 0x09BC, GRAPHEME_CONJUNCT_EXTEND},
+    {0x09BE, 0x09BE, GRAPHEME_EXTEND},
+    {0x09BF, 0x09C0, GRAPHEME_SPACING_MARK},
+    {0x09C1, 0x09C4, GRAPHEME_EXTEND},
+    {0x09C7, 0x09C8, GRAPHEME_SPACING_MARK},
+    {0x09CB, 0x09CC, GRAPHEME_SPACING_MARK},
+    {0x09CD, 0x09CD, GRAPHEME_CONJUNCT_LINKER},
+    {0x09D7, 0x09D7, GRAPHEME_EXTEND},
+    {0x09DC, 0x09DD, GRAPHEME_CONJUNCT_CONSONANT},
+    {0x09DF, 0x09DF, GRAPHEME_CONJUNCT_CONSONANT},
+    {0x09E2, 0x09E3, GRAPHEME_EXTEND},
+    {0x09F0, 0x09F1, GRAPHEME_CONJUNCT_CONSONANT},
+    {0x09FE, 0x09FE, GRAPHEME_CONJUNCT_EXTEND},
+    {0x0A01, 0x0A02, GRAPHEME_EXTEND},
+    {0x0A03, 0x0A03, GRAPHEME_SPACING_MARK},
+    {0x0A3C, 0x0A3C, GRAPHEME_CONJUNCT_EXTEND},
+    {0x0A3E, 0x0A40, GRAPHEME_SPACING_MARK},
+    {0x0A41, 0x0A42, GRAPHEME_EXTEND},
+    {0x0A47, 0x0A48, GRAPHEME_EXTEND},
+    {0x0A4B, 0x0A4C, GRAPHEME_EXTEND},
+    {0x0A4D, 0x0A4D, GRAPHEME_CONJUNCT_EXTEND},
+    {0x0A51, 0x0A51, GRAPHEME_EXTEND},
+    {0x0A70, 0x0A71, GRAPHEME_EXTEND},
+    {0x0A75, 0x0A75, GRAPHEME_EXTEND},
+    {0x0A81, 0x0A82, GRAPHEME_EXTEND},
+    {0x0A83, 0x0A83, GRAPHEME_SPACING_MARK},
+    {0x0A95, 0x0AA8, GRAPHEME_CONJUNCT_CONSONANT},
+    {0x0AAA, 0x0AB0, GRAPHEME_CONJUNCT_CONSONANT},
+    {0x0AB2, 0x0AB3, GRAPHEME_CONJUNCT_CONSONANT},
+    {0x0AB5, 0x0AB9, GRAPHEME_CONJUNCT_CONSONANT},
+    {0x0ABC, 0x0ABC, GRAPHEME_CONJUNCT_EXTEND},
+    {0x0ABE, 0x0AC0, GRAPHEME_SPACING_MARK},
+    {0x0AC1, 0x0AC5, GRAPHEME_EXTEND},
+    {0x0AC7, 0x0AC8, GRAPHEME_EXTEND},
+    {0x0AC9, 0x0AC9, GRAPHEME_SPACING_MARK},
+    {0x0ACB, 0x0ACC, GRAPHEME_SPACING_MARK},
+    {0x0ACD, 0x0ACD, GRAPHEME_CONJUNCT_LINKER},
+    {0x0AE2, 0x0AE3, GRAPHEME_EXTEND},
+    {0x0AF9, 0x0AF9, GRAPHEME_CONJUNCT_CONSONANT},
+    {0x0AFA, 0x0AFF, GRAPHEME_EXTEND},
+    {0x0B01, 0x0B01, GRAPHEME_EXTEND},
+    {0x0B02, 0x0B03, GRAPHEME_SPACING_MARK},
+    {0x0B15, 0x0B28, GRAPHEME_CONJUNCT_CONSONANT},
+    {0x0B2A, 0x0B30, GRAPHEME_CONJUNCT_CONSONANT},
+    {0x0B32, 0x0B33, GRAPHEME_CONJUNCT_CONSONANT},
+    {0x0B35, 0x0B39, GRAPHEME_CONJUNCT_CONSONANT},
+    {0x0B3C, 0x0B3C, GRAPHEME_CONJUNCT_EXTEND},
+    {0x0B3E, 0x0B3F, GRAPHEME_EXTEND},
+    {0x0B40, 0x0B40, GRAPHEME_SPACING_MARK},
+    {0x0B41, 0x0B44, GRAPHEME_EXTEND},
+    {0x0B47, 0x0B48, GRAPHEME_SPACING_MARK},
+    {0x0B4B, 0x0B4C, GRAPHEME_SPACING_MARK},
+    {0x0B4D, 0x0B4D, GRAPHEME_CONJUNCT_LINKER},
+    {0x0B55, 0x0B57, GRAPHEME_EXTEND},
+    {0x0B5C, 0x0B5D, GRAPHEME_CONJUNCT_CONSONANT},
+    {0x0B5F, 0x0B5F, GRAPHEME_CONJUNCT_CONSONANT},
+    {0x0B62, 0x0B63, GRAPHEME_EXTEND},
+    {0x0B71, 0x0B71, GRAPHEME_CONJUNCT_CONSONANT},
+    {0x0B82, 0x0B82, GRAPHEME_EXTEND},
+    {0x0BBE, 0x0BBE, GRAPHEME_EXTEND},
+    {0x0BBF, 0x0BBF, GRAPHEME_SPACING_MARK},
+    {0x0BC0, 0x0BC0, GRAPHEME_EXTEND},
+    {0x0BC1, 0x0BC2, GRAPHEME_SPACING_MARK},
+    {0x0BC6, 0x0BC8, GRAPHEME_SPACING_MARK},
+    {0x0BCA, 0x0BCC, GRAPHEME_SPACING_MARK},
+    {0x0BCD, 0x0BCD, GRAPHEME_CONJUNCT_EXTEND},
+    {0x0BD7, 0x0BD7, GRAPHEME_EXTEND},
+    {0x0C00, 0x0C00, GRAPHEME_EXTEND},
+    {0x0C01, 0x0C03, GRAPHEME_SPACING_MARK},
+    {0x0C04, 0x0C04, GRAPHEME_EXTEND},
+    {0x0C15, 0x0C28, GRAPHEME_CONJUNCT_CONSONANT},
+    {0x0C2A, 0x0C39, GRAPHEME_CONJUNCT_CONSONANT},
+    {0x0C3C, 0x0C3C, GRAPHEME_CONJUNCT_EXTEND},
+    {0x0C3E, 0x0C40, GRAPHEME_EXTEND},
+    {0x0C41, 0x0C44, GRAPHEME_SPACING_MARK},
+    {0x0C46, 0x0C48, GRAPHEME_EXTEND},
+    {0x0C4A, 0x0C4C, GRAPHEME_EXTEND},
+    {0x0C4D, 0x0C4D, GRAPHEME_CONJUNCT_LINKER},
+    {0x0C55, 0x0C56, GRAPHEME_CONJUNCT_EXTEND},
+    {0x0C58, 0x0C5A, GRAPHEME_CONJUNCT_CONSONANT},
+    {0x0C62, 0x0C63, GRAPHEME_EXTEND},
+    {0x0C81, 0x0C81, GRAPHEME_EXTEND},
+    {0x0C82, 0x0C83, GRAPHEME_SPACING_MARK},
+    {0x0CBC, 0x0CBC, GRAPHEME_CONJUNCT_EXTEND},
+    {0x0CBE, 0x0CBE, GRAPHEME_SPACING_MARK},
+    {0x0CBF, 0x0CBF, GRAPHEME_EXTEND},
+    {0x0CC0, 0x0CC1, GRAPHEME_SPACING_MARK},
+    {0x0CC2, 0x0CC2, GRAPHEME_EXTEND},
+    {0x0CC3, 0x0CC4, GRAPHEME_SPACING_MARK},
+    {0x0CC6, 0x0CC6, GRAPHEME_EXTEND},
+    {0x0CC7, 0x0CC8, GRAPHEME_SPACING_MARK},
+    {0x0CCA, 0x0CCB, GRAPHEME_SPACING_MARK},
+    {0x0CCC, 0x0CCC, GRAPHEME_EXTEND},
+    {0x0CCD, 0x0CCD, GRAPHEME_CONJUNCT_EXTEND},
+    {0x0CD5, 0x0CD6, GRAPHEME_EXTEND},
+    {0x0CE2, 0x0CE3, GRAPHEME_EXTEND},
+    {0x0CF3, 0x0CF3, GRAPHEME_SPACING_MARK},
+    {0x0D00, 0x0D01, GRAPHEME_EXTEND},
+    {0x0D02, 0x0D03, GRAPHEME_SPACING_MARK},
+    {0x0D15, 0x0D3A, GRAPHEME_CONJUNCT_CONSONANT},
+    {0x0D3B, 0x0D3C, GRAPHEME_CONJUNCT_EXTEND},
+    {0x0D3E, 0x0D3E, GRAPHEME_EXTEND},
+    {0x0D3F, 0x0D40, GRAPHEME_SPACING_MARK},
+    {0x0D41, 0x0D44, GRAPHEME_EXTEND},
+    {0x0D46, 0x0D48, GRAPHEME_SPACING_MARK},
+    {0x0D4A, 0x0D4C, GRAPHEME_SPACING_MARK},
+    {0x0D4D, 0x0D4D, GRAPHEME_CONJUNCT_LINKER},
+    {0x0D4E, 0x0D4E, GRAPHEME_PREPEND},
+    {0x0D57, 0x0D57, GRAPHEME_EXTEND},
+    {0x0D62, 0x0D63, GRAPHEME_EXTEND},
+    {0x0D81, 0x0D81, GRAPHEME_EXTEND},
+    {0x0D82, 0x0D83, GRAPHEME_SPACING_MARK},
+    {0x0DCA, 0x0DCA, GRAPHEME_CONJUNCT_EXTEND},
+    {0x0DCF, 0x0DCF, GRAPHEME_EXTEND},
+    {0x0DD0, 0x0DD1, GRAPHEME_SPACING_MARK},
+    {0x0DD2, 0x0DD4, GRAPHEME_EXTEND},
+    {0x0DD6, 0x0DD6, GRAPHEME_EXTEND},
+    {0x0DD8, 0x0DDE, GRAPHEME_SPACING_MARK},
+    {0x0DDF, 0x0DDF, GRAPHEME_EXTEND},
+    {0x0DF2, 0x0DF3, GRAPHEME_SPACING_MARK},
+    {0x0E31, 0x0E31, GRAPHEME_EXTEND},
+    {0x0E33, 0x0E33, GRAPHEME_SPACING_MARK},
+    {0x0E34, 0x0E37, GRAPHEME_EXTEND},
+    {0x0E38, 0x0E3A, GRAPHEME_CONJUNCT_EXTEND},
+    {0x0E47, 0x0E47, GRAPHEME_EXTEND},
+    {0x0E48, 0x0E4B, GRAPHEME_CONJUNCT_EXTEND},
+    {0x0E4C, 0x0E4E, GRAPHEME_EXTEND},
+    {0x0EB1, 0x0EB1, GRAPHEME_EXTEND},
+    {0x0EB3, 0x0EB3, GRAPHEME_SPACING_MARK},
+    {0x0EB4, 0x0EB7, GRAPHEME_EXTEND},
+    {0x0EB8, 0x0EBA, GRAPHEME_CONJUNCT_EXTEND},
+    {0x0EBB, 0x0EBC, GRAPHEME_EXTEND},
+    {0x0EC8, 0x0ECB, GRAPHEME_CONJUNCT_EXTEND},
+    {0x0ECC, 0x0ECE, GRAPHEME_EXTEND},
+    {0x0F18, 0x0F19, GRAPHEME_CONJUNCT_EXTEND},
+    {0x0F35, 0x0F35, GRAPHEME_CONJUNCT_EXTEND},
+    {0x0F37, 0x0F37, GRAPHEME_CONJUNCT_EXTEND},
+    {0x0F39, 0x0F39, GRAPHEME_CONJUNCT_EXTEND},
+    {0x0F3E, 0x0F3F, GRAPHEME_SPACING_MARK},
+    {0x0F71, 0x0F72, GRAPHEME_CONJUNCT_EXTEND},
+    {0x0F73, 0x0F73, GRAPHEME_EXTEND},
+    {0x0F74, 0x0F74, GRAPHEME_CONJUNCT_EXTEND},
+    {0x0F75, 0x0F79, GRAPHEME_EXTEND},
+    {0x0F7A, 0x0F7D, GRAPHEME_CONJUNCT_EXTEND},
+    {0x0F7E, 0x0F7E, GRAPHEME_EXTEND},
+    {0x0F7F, 0x0F7F, GRAPHEME_SPACING_MARK},
+    {0x0F80, 0x0F80, GRAPHEME_CONJUNCT_EXTEND},
+    {0x0F81, 0x0F81, GRAPHEME_EXTEND},
+    {0x0F82, 0x0F84, GRAPHEME_CONJUNCT_EXTEND},
+    {0x0F86, 0x0F87, GRAPHEME_CONJUNCT_EXTEND},
+    {0x0F8D, 0x0F97, GRAPHEME_EXTEND},
+    {0x0F99, 0x0FBC, GRAPHEME_EXTEND},
+    {0x0FC6, 0x0FC6, GRAPHEME_CONJUNCT_EXTEND},
+    {0x102D, 0x1030, GRAPHEME_EXTEND},
+    {0x1031, 0x1031, GRAPHEME_SPACING_MARK},
+    {0x1032, 0x1036, GRAPHEME_EXTEND},
+    {0x1037, 0x1037, GRAPHEME_CONJUNCT_EXTEND},
+    {0x1039, 0x103A, GRAPHEME_CONJUNCT_EXTEND},
+    {0x103B, 0x103C, GRAPHEME_SPACING_MARK},
+    {0x103D, 0x103E, GRAPHEME_EXTEND},
+    {0x1056, 0x1057, GRAPHEME_SPACING_MARK},
+    {0x1058, 0x1059, GRAPHEME_EXTEND},
+    {0x105E, 0x1060, GRAPHEME_EXTEND},
+    {0x1071, 0x1074, GRAPHEME_EXTEND},
+    {0x1082, 0x1082, GRAPHEME_EXTEND},
+    {0x1084, 0x1084, GRAPHEME_SPACING_MARK},
+    {0x1085, 0x1086, GRAPHEME_EXTEND},
+    {0x108D, 0x108D, GRAPHEME_CONJUNCT_EXTEND},
+    {0x109D, 0x109D, GRAPHEME_EXTEND},
+    {0x1100, 0x115F, GRAPHEME_L},
+    {0x1160, 0x11A7, GRAPHEME_V},
+    {0x11A8, 0x11FF, GRAPHEME_T},
+    {0x135D, 0x135F, GRAPHEME_CONJUNCT_EXTEND},
+    {0x1712, 0x1713, GRAPHEME_EXTEND},
+    {0x1714, 0x1714, GRAPHEME_CONJUNCT_EXTEND},
+    {0x1715, 0x1715, GRAPHEME_SPACING_MARK},
+    {0x1732, 0x1733, GRAPHEME_EXTEND},
+    {0x1734, 0x1734, GRAPHEME_SPACING_MARK},
+    {0x1752, 0x1753, GRAPHEME_EXTEND},
+    {0x1772, 0x1773, GRAPHEME_EXTEND},
+    {0x17B4, 0x17B5, GRAPHEME_EXTEND},
+    {0x17B6, 0x17B6, GRAPHEME_SPACING_MARK},
+    {0x17B7, 0x17BD, GRAPHEME_EXTEND},
+    {0x17BE, 0x17C5, GRAPHEME_SPACING_MARK},
+    {0x17C6, 0x17C6, GRAPHEME_EXTEND},
+    {0x17C7, 0x17C8, GRAPHEME_SPACING_MARK},
+    {0x17C9, 0x17D1, GRAPHEME_EXTEND},
+    {0x17D2, 0x17D2, GRAPHEME_CONJUNCT_EXTEND},
+    {0x17D3, 0x17D3, GRAPHEME_EXTEND},
+    {0x17DD, 0x17DD, GRAPHEME_CONJUNCT_EXTEND},
+    {0x180B, 0x180D, GRAPHEME_EXTEND},
+    {0x180E, 0x180E, GRAPHEME_CONTROL},
+    {0x180F, 0x180F, GRAPHEME_EXTEND},
+    {0x1885, 0x1886, GRAPHEME_EXTEND},
+    {0x18A9, 0x18A9, GRAPHEME_CONJUNCT_EXTEND},
+    {0x1920, 0x1922, GRAPHEME_EXTEND},
+    {0x1923, 0x1926, GRAPHEME_SPACING_MARK},
+    {0x1927, 0x1928, GRAPHEME_EXTEND},
+    {0x1929, 0x192B, GRAPHEME_SPACING_MARK},
+    {0x1930, 0x1931, GRAPHEME_SPACING_MARK},
+    {0x1932, 0x1932, GRAPHEME_EXTEND},
+    {0x1933, 0x1938, GRAPHEME_SPACING_MARK},
+    {0x1939, 0x193B, GRAPHEME_CONJUNCT_EXTEND},
+    {0x1A17, 0x1A18, GRAPHEME_CONJUNCT_EXTEND},
+    {0x1A19, 0x1A1A, GRAPHEME_SPACING_MARK},
+    {0x1A1B, 0x1A1B, GRAPHEME_EXTEND},
+    {0x1A55, 0x1A55, GRAPHEME_SPACING_MARK},
+    {0x1A56, 0x1A56, GRAPHEME_EXTEND},
+    {0x1A57, 0x1A57, GRAPHEME_SPACING_MARK},
+    {0x1A58, 0x1A5E, GRAPHEME_EXTEND},
+    {0x1A60, 0x1A60, GRAPHEME_CONJUNCT_EXTEND},
+    {0x1A62, 0x1A62, GRAPHEME_EXTEND},
+    {0x1A65, 0x1A6C, GRAPHEME_EXTEND},
+    {0x1A6D, 0x1A72, GRAPHEME_SPACING_MARK},
+    {0x1A73, 0x1A74, GRAPHEME_EXTEND},
+    {0x1A75, 0x1A7C, GRAPHEME_CONJUNCT_EXTEND},
+    {0x1A7F, 0x1A7F, GRAPHEME_CONJUNCT_EXTEND},
+    {0x1AB0, 0x1ABD, GRAPHEME_CONJUNCT_EXTEND},
+    {0x1ABE, 0x1ABE, GRAPHEME_EXTEND},
+    {0x1ABF, 0x1ACE, GRAPHEME_CONJUNCT_EXTEND},
+    {0x1B00, 0x1B03, GRAPHEME_EXTEND},
+    {0x1B04, 0x1B04, GRAPHEME_SPACING_MARK},
+    {0x1B34, 0x1B34, GRAPHEME_CONJUNCT_EXTEND},
+    {0x1B35, 0x1B3A, GRAPHEME_EXTEND},
+    {0x1B3B, 0x1B3B, GRAPHEME_SPACING_MARK},
+    {0x1B3C, 0x1B3C, GRAPHEME_EXTEND},
+    {0x1B3D, 0x1B41, GRAPHEME_SPACING_MARK},
+    {0x1B42, 0x1B42, GRAPHEME_EXTEND},
+    {0x1B43, 0x1B44, GRAPHEME_SPACING_MARK},
+    {0x1B6B, 0x1B73, GRAPHEME_CONJUNCT_EXTEND},
+    {0x1B80, 0x1B81, GRAPHEME_EXTEND},
+    {0x1B82, 0x1B82, GRAPHEME_SPACING_MARK},
+    {0x1BA1, 0x1BA1, GRAPHEME_SPACING_MARK},
+    {0x1BA2, 0x1BA5, GRAPHEME_EXTEND},
+    {0x1BA6, 0x1BA7, GRAPHEME_SPACING_MARK},
+    {0x1BA8, 0x1BA9, GRAPHEME_EXTEND},
+    {0x1BAA, 0x1BAA, GRAPHEME_SPACING_MARK},
+    {0x1BAB, 0x1BAB, GRAPHEME_CONJUNCT_EXTEND},
+    {0x1BAC, 0x1BAD, GRAPHEME_EXTEND},
+    {0x1BE6, 0x1BE6, GRAPHEME_CONJUNCT_EXTEND},
+    {0x1BE7, 0x1BE7, GRAPHEME_SPACING_MARK},
+    {0x1BE8, 0x1BE9, GRAPHEME_EXTEND},
+    {0x1BEA, 0x1BEC, GRAPHEME_SPACING_MARK},
+    {0x1BED, 0x1BED, GRAPHEME_EXTEND},
+    {0x1BEE, 0x1BEE, GRAPHEME_SPACING_MARK},
+    {0x1BEF, 0x1BF1, GRAPHEME_EXTEND},
+    {0x1BF2, 0x1BF3, GRAPHEME_SPACING_MARK},
+    {0x1C24, 0x1C2B, GRAPHEME_SPACING_MARK},
+    {0x1C2C, 0x1C33, GRAPHEME_EXTEND},
+    {0x1C34, 0x1C35, GRAPHEME_SPACING_MARK},
+    {0x1C36, 0x1C36, GRAPHEME_EXTEND},
+    {0x1C37, 0x1C37, GRAPHEME_CONJUNCT_EXTEND},
+    {0x1CD0, 0x1CD2, GRAPHEME_CONJUNCT_EXTEND},
+    {0x1CD4, 0x1CE0, GRAPHEME_CONJUNCT_EXTEND},
+    {0x1CE1, 0x1CE1, GRAPHEME_SPACING_MARK},
+    {0x1CE2, 0x1CE8, GRAPHEME_CONJUNCT_EXTEND},
+    {0x1CED, 0x1CED, GRAPHEME_CONJUNCT_EXTEND},
+    {0x1CF4, 0x1CF4, GRAPHEME_CONJUNCT_EXTEND},
+    {0x1CF7, 0x1CF7, GRAPHEME_SPACING_MARK},
+    {0x1CF8, 0x1CF9, GRAPHEME_CONJUNCT_EXTEND},
+    {0x1DC0, 0x1DFF, GRAPHEME_CONJUNCT_EXTEND},
+    {0x200B, 0x200B, GRAPHEME_CONTROL},
+    {0x200C, 0x200C, GRAPHEME_EXTEND},
+    {0x200D, 0x200D, GRAPHEME_ZWJ},
+    {0x200E, 0x200F, GRAPHEME_CONTROL},
+    {0x2028, 0x202E, GRAPHEME_CONTROL},
+    {0x203C, 0x203C, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x2049, 0x2049, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x2060, 0x206F, GRAPHEME_CONTROL},
+    {0x20D0, 0x20DC, GRAPHEME_CONJUNCT_EXTEND},
+    {0x20DD, 0x20E0, GRAPHEME_EXTEND},
+    {0x20E1, 0x20E1, GRAPHEME_CONJUNCT_EXTEND},
+    {0x20E2, 0x20E4, GRAPHEME_EXTEND},
+    {0x20E5, 0x20F0, GRAPHEME_CONJUNCT_EXTEND},
+    {0x2122, 0x2122, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x2139, 0x2139, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x2194, 0x2199, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x21A9, 0x21AA, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x231A, 0x231B, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x2328, 0x2328, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x2388, 0x2388, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x23CF, 0x23CF, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x23E9, 0x23F3, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x23F8, 0x23FA, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x24C2, 0x24C2, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x25AA, 0x25AB, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x25B6, 0x25B6, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x25C0, 0x25C0, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x25FB, 0x25FE, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x2600, 0x2605, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x2607, 0x2612, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x2614, 0x2685, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x2690, 0x2705, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x2708, 0x2712, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x2714, 0x2714, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x2716, 0x2716, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x271D, 0x271D, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x2721, 0x2721, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x2728, 0x2728, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x2733, 0x2734, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x2744, 0x2744, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x2747, 0x2747, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x274C, 0x274C, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x274E, 0x274E, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x2753, 0x2755, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x2757, 0x2757, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x2763, 0x2767, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x2795, 0x2797, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x27A1, 0x27A1, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x27B0, 0x27B0, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x27BF, 0x27BF, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x2934, 0x2935, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x2B05, 0x2B07, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x2B1B, 0x2B1C, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x2B50, 0x2B50, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x2B55, 0x2B55, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x2CEF, 0x2CF1, GRAPHEME_CONJUNCT_EXTEND},
+    {0x2D7F, 0x2D7F, GRAPHEME_CONJUNCT_EXTEND},
+    {0x2DE0, 0x2DFF, GRAPHEME_CONJUNCT_EXTEND},
+    {0x302A, 0x302F, GRAPHEME_CONJUNCT_EXTEND},
+    {0x3030, 0x3030, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x303D, 0x303D, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x3099, 0x309A, GRAPHEME_CONJUNCT_EXTEND},
+    {0x3297, 0x3297, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x3299, 0x3299, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0xA66F, 0xA66F, GRAPHEME_CONJUNCT_EXTEND},
+    {0xA670, 0xA672, GRAPHEME_EXTEND},
+    {0xA674, 0xA67D, GRAPHEME_CONJUNCT_EXTEND},
+    {0xA69E, 0xA69F, GRAPHEME_CONJUNCT_EXTEND},
+    {0xA6F0, 0xA6F1, GRAPHEME_CONJUNCT_EXTEND},
+    {0xA802, 0xA802, GRAPHEME_EXTEND},
+    {0xA806, 0xA806, GRAPHEME_CONJUNCT_EXTEND},
+    {0xA80B, 0xA80B, GRAPHEME_EXTEND},
+    {0xA823, 0xA824, GRAPHEME_SPACING_MARK},
+    {0xA825, 0xA826, GRAPHEME_EXTEND},
+    {0xA827, 0xA827, GRAPHEME_SPACING_MARK},
+    {0xA82C, 0xA82C, GRAPHEME_CONJUNCT_EXTEND},
+    {0xA880, 0xA881, GRAPHEME_SPACING_MARK},
+    {0xA8B4, 0xA8C3, GRAPHEME_SPACING_MARK},
+    {0xA8C4, 0xA8C4, GRAPHEME_CONJUNCT_EXTEND},
+    {0xA8C5, 0xA8C5, GRAPHEME_EXTEND},
+    {0xA8E0, 0xA8F1, GRAPHEME_CONJUNCT_EXTEND},
+    {0xA8FF, 0xA8FF, GRAPHEME_EXTEND},
+    {0xA926, 0xA92A, GRAPHEME_EXTEND},
+    {0xA92B, 0xA92D, GRAPHEME_CONJUNCT_EXTEND},
+    {0xA947, 0xA951, GRAPHEME_EXTEND},
+    {0xA952, 0xA953, GRAPHEME_SPACING_MARK},
+    {0xA960, 0xA97C, GRAPHEME_L},
+    {0xA980, 0xA982, GRAPHEME_EXTEND},
+    {0xA983, 0xA983, GRAPHEME_SPACING_MARK},
+    {0xA9B3, 0xA9B3, GRAPHEME_CONJUNCT_EXTEND},
+    {0xA9B4, 0xA9B5, GRAPHEME_SPACING_MARK},
+    {0xA9B6, 0xA9B9, GRAPHEME_EXTEND},
+    {0xA9BA, 0xA9BB, GRAPHEME_SPACING_MARK},
+    {0xA9BC, 0xA9BD, GRAPHEME_EXTEND},
+    {0xA9BE, 0xA9C0, GRAPHEME_SPACING_MARK},
+    {0xA9E5, 0xA9E5, GRAPHEME_EXTEND},
+    {0xAA29, 0xAA2E, GRAPHEME_EXTEND},
+    {0xAA2F, 0xAA30, GRAPHEME_SPACING_MARK},
+    {0xAA31, 0xAA32, GRAPHEME_EXTEND},
+    {0xAA33, 0xAA34, GRAPHEME_SPACING_MARK},
+    {0xAA35, 0xAA36, GRAPHEME_EXTEND},
+    {0xAA43, 0xAA43, GRAPHEME_EXTEND},
+    {0xAA4C, 0xAA4C, GRAPHEME_EXTEND},
+    {0xAA4D, 0xAA4D, GRAPHEME_SPACING_MARK},
+    {0xAA7C, 0xAA7C, GRAPHEME_EXTEND},
+    {0xAAB0, 0xAAB0, GRAPHEME_CONJUNCT_EXTEND},
+    {0xAAB2, 0xAAB4, GRAPHEME_CONJUNCT_EXTEND},
+    {0xAAB7, 0xAAB8, GRAPHEME_CONJUNCT_EXTEND},
+    {0xAABE, 0xAABF, GRAPHEME_CONJUNCT_EXTEND},
+    {0xAAC1, 0xAAC1, GRAPHEME_CONJUNCT_EXTEND},
+    {0xAAEB, 0xAAEB, GRAPHEME_SPACING_MARK},
+    {0xAAEC, 0xAAED, GRAPHEME_EXTEND},
+    {0xAAEE, 0xAAEF, GRAPHEME_SPACING_MARK},
+    {0xAAF5, 0xAAF5, GRAPHEME_SPACING_MARK},
+    {0xAAF6, 0xAAF6, GRAPHEME_CONJUNCT_EXTEND},
+    {0xABE3, 0xABE4, GRAPHEME_SPACING_MARK},
+    {0xABE5, 0xABE5, GRAPHEME_EXTEND},
+    {0xABE6, 0xABE7, GRAPHEME_SPACING_MARK},
+    {0xABE8, 0xABE8, GRAPHEME_EXTEND},
+    {0xABE9, 0xABEA, GRAPHEME_SPACING_MARK},
+    {0xABEC, 0xABEC, GRAPHEME_SPACING_MARK},
+    {0xABED, 0xABED, GRAPHEME_CONJUNCT_EXTEND},
+    {0xD7B0, 0xD7C6, GRAPHEME_V},
+    {0xD7CB, 0xD7FB, GRAPHEME_T},
+    {0xFB1E, 0xFB1E, GRAPHEME_CONJUNCT_EXTEND},
+    {0xFE00, 0xFE0F, GRAPHEME_EXTEND},
+    {0xFE20, 0xFE2F, GRAPHEME_CONJUNCT_EXTEND},
+    {0xFEFF, 0xFEFF, GRAPHEME_CONTROL},
+    {0xFF9E, 0xFF9F, GRAPHEME_EXTEND},
+    {0xFFF0, 0xFFFB, GRAPHEME_CONTROL},
+    {0x101FD, 0x101FD, GRAPHEME_CONJUNCT_EXTEND},
+    {0x102E0, 0x102E0, GRAPHEME_CONJUNCT_EXTEND},
+    {0x10376, 0x1037A, GRAPHEME_CONJUNCT_EXTEND},
+    {0x10A01, 0x10A03, GRAPHEME_EXTEND},
+    {0x10A05, 0x10A06, GRAPHEME_EXTEND},
+    {0x10A0C, 0x10A0C, GRAPHEME_EXTEND},
+    {0x10A0D, 0x10A0D, GRAPHEME_CONJUNCT_EXTEND},
+    {0x10A0E, 0x10A0E, GRAPHEME_EXTEND},
+    {0x10A0F, 0x10A0F, GRAPHEME_CONJUNCT_EXTEND},
+    {0x10A38, 0x10A3A, GRAPHEME_CONJUNCT_EXTEND},
+    {0x10A3F, 0x10A3F, GRAPHEME_CONJUNCT_EXTEND},
+    {0x10AE5, 0x10AE6, GRAPHEME_CONJUNCT_EXTEND},
+    {0x10D24, 0x10D27, GRAPHEME_CONJUNCT_EXTEND},
+    {0x10EAB, 0x10EAC, GRAPHEME_CONJUNCT_EXTEND},
+    {0x10EFD, 0x10EFF, GRAPHEME_CONJUNCT_EXTEND},
+    {0x10F46, 0x10F50, GRAPHEME_CONJUNCT_EXTEND},
+    {0x10F82, 0x10F85, GRAPHEME_CONJUNCT_EXTEND},
+    {0x11000, 0x11000, GRAPHEME_SPACING_MARK},
+    {0x11001, 0x11001, GRAPHEME_EXTEND},
+    {0x11002, 0x11002, GRAPHEME_SPACING_MARK},
+    {0x11038, 0x11045, GRAPHEME_EXTEND},
+    {0x11046, 0x11046, GRAPHEME_CONJUNCT_EXTEND},
+    {0x11070, 0x11070, GRAPHEME_CONJUNCT_EXTEND},
+    {0x11073, 0x11074, GRAPHEME_EXTEND},
+    {0x1107F, 0x1107F, GRAPHEME_CONJUNCT_EXTEND},
+    {0x11080, 0x11081, GRAPHEME_EXTEND},
+    {0x11082, 0x11082, GRAPHEME_SPACING_MARK},
+    {0x110B0, 0x110B2, GRAPHEME_SPACING_MARK},
+    {0x110B3, 0x110B6, GRAPHEME_EXTEND},
+    {0x110B7, 0x110B8, GRAPHEME_SPACING_MARK},
+    {0x110B9, 0x110BA, GRAPHEME_CONJUNCT_EXTEND},
+    {0x110BD, 0x110BD, GRAPHEME_PREPEND},
+    {0x110C2, 0x110C2, GRAPHEME_EXTEND},
+    {0x110CD, 0x110CD, GRAPHEME_PREPEND},
+    {0x11100, 0x11102, GRAPHEME_CONJUNCT_EXTEND},
+    {0x11127, 0x1112B, GRAPHEME_EXTEND},
+    {0x1112C, 0x1112C, GRAPHEME_SPACING_MARK},
+    {0x1112D, 0x11132, GRAPHEME_EXTEND},
+    {0x11133, 0x11134, GRAPHEME_CONJUNCT_EXTEND},
+    {0x11145, 0x11146, GRAPHEME_SPACING_MARK},
+    {0x11173, 0x11173, GRAPHEME_CONJUNCT_EXTEND},
+    {0x11180, 0x11181, GRAPHEME_EXTEND},
+    {0x11182, 0x11182, GRAPHEME_SPACING_MARK},
+    {0x111B3, 0x111B5, GRAPHEME_SPACING_MARK},
+    {0x111B6, 0x111BE, GRAPHEME_EXTEND},
+    {0x111BF, 0x111C0, GRAPHEME_SPACING_MARK},
+    {0x111C2, 0x111C3, GRAPHEME_PREPEND},
+    {0x111C9, 0x111C9, GRAPHEME_EXTEND},
+    {0x111CA, 0x111CA, GRAPHEME_CONJUNCT_EXTEND},
+    {0x111CB, 0x111CC, GRAPHEME_EXTEND},
+    {0x111CE, 0x111CE, GRAPHEME_SPACING_MARK},
+    {0x111CF, 0x111CF, GRAPHEME_EXTEND},
+    {0x1122C, 0x1122E, GRAPHEME_SPACING_MARK},
+    {0x1122F, 0x11231, GRAPHEME_EXTEND},
+    {0x11232, 0x11233, GRAPHEME_SPACING_MARK},
+    {0x11234, 0x11234, GRAPHEME_EXTEND},
+    {0x11235, 0x11235, GRAPHEME_SPACING_MARK},
+    {0x11236, 0x11236, GRAPHEME_CONJUNCT_EXTEND},
+    {0x11237, 0x11237, GRAPHEME_EXTEND},
+    {0x1123E, 0x1123E, GRAPHEME_EXTEND},
+    {0x11241, 0x11241, GRAPHEME_EXTEND},
+    {0x112DF, 0x112DF, GRAPHEME_EXTEND},
+    {0x112E0, 0x112E2, GRAPHEME_SPACING_MARK},
+    {0x112E3, 0x112E8, GRAPHEME_EXTEND},
+    {0x112E9, 0x112EA, GRAPHEME_CONJUNCT_EXTEND},
+    {0x11300, 0x11301, GRAPHEME_EXTEND},
+    {0x11302, 0x11303, GRAPHEME_SPACING_MARK},
+    {0x1133B, 0x1133C, GRAPHEME_CONJUNCT_EXTEND},
+    {0x1133E, 0x1133E, GRAPHEME_EXTEND},
+    {0x1133F, 0x1133F, GRAPHEME_SPACING_MARK},
+    {0x11340, 0x11340, GRAPHEME_EXTEND},
+    {0x11341, 0x11344, GRAPHEME_SPACING_MARK},
+    {0x11347, 0x11348, GRAPHEME_SPACING_MARK},
+    {0x1134B, 0x1134D, GRAPHEME_SPACING_MARK},
+    {0x11357, 0x11357, GRAPHEME_EXTEND},
+    {0x11362, 0x11363, GRAPHEME_SPACING_MARK},
+    {0x11366, 0x1136C, GRAPHEME_CONJUNCT_EXTEND},
+    {0x11370, 0x11374, GRAPHEME_CONJUNCT_EXTEND},
+    {0x11435, 0x11437, GRAPHEME_SPACING_MARK},
+    {0x11438, 0x1143F, GRAPHEME_EXTEND},
+    {0x11440, 0x11441, GRAPHEME_SPACING_MARK},
+    {0x11442, 0x11442, GRAPHEME_CONJUNCT_EXTEND},
+    {0x11443, 0x11444, GRAPHEME_EXTEND},
+    {0x11445, 0x11445, GRAPHEME_SPACING_MARK},
+    {0x11446, 0x11446, GRAPHEME_CONJUNCT_EXTEND},
+    {0x1145E, 0x1145E, GRAPHEME_CONJUNCT_EXTEND},
+    {0x114B0, 0x114B0, GRAPHEME_EXTEND},
+    {0x114B1, 0x114B2, GRAPHEME_SPACING_MARK},
+    {0x114B3, 0x114B8, GRAPHEME_EXTEND},
+    {0x114B9, 0x114B9, GRAPHEME_SPACING_MARK},
+    {0x114BA, 0x114BA, GRAPHEME_EXTEND},
+    {0x114BB, 0x114BC, GRAPHEME_SPACING_MARK},
+    {0x114BD, 0x114BD, GRAPHEME_EXTEND},
+    {0x114BE, 0x114BE, GRAPHEME_SPACING_MARK},
+    {0x114BF, 0x114C0, GRAPHEME_EXTEND},
+    {0x114C1, 0x114C1, GRAPHEME_SPACING_MARK},
+    {0x114C2, 0x114C3, GRAPHEME_CONJUNCT_EXTEND},
+    {0x115AF, 0x115AF, GRAPHEME_EXTEND},
+    {0x115B0, 0x115B1, GRAPHEME_SPACING_MARK},
+    {0x115B2, 0x115B5, GRAPHEME_EXTEND},
+    {0x115B8, 0x115BB, GRAPHEME_SPACING_MARK},
+    {0x115BC, 0x115BD, GRAPHEME_EXTEND},
+    {0x115BE, 0x115BE, GRAPHEME_SPACING_MARK},
+    {0x115BF, 0x115C0, GRAPHEME_CONJUNCT_EXTEND},
+    {0x115DC, 0x115DD, GRAPHEME_EXTEND},
+    {0x11630, 0x11632, GRAPHEME_SPACING_MARK},
+    {0x11633, 0x1163A, GRAPHEME_EXTEND},
+    {0x1163B, 0x1163C, GRAPHEME_SPACING_MARK},
+    {0x1163D, 0x1163D, GRAPHEME_EXTEND},
+    {0x1163E, 0x1163E, GRAPHEME_SPACING_MARK},
+    {0x1163F, 0x1163F, GRAPHEME_CONJUNCT_EXTEND},
+    {0x11640, 0x11640, GRAPHEME_EXTEND},
+    {0x116AB, 0x116AB, GRAPHEME_EXTEND},
+    {0x116AC, 0x116AC, GRAPHEME_SPACING_MARK},
+    {0x116AD, 0x116AD, GRAPHEME_EXTEND},
+    {0x116AE, 0x116AF, GRAPHEME_SPACING_MARK},
+    {0x116B0, 0x116B5, GRAPHEME_EXTEND},
+    {0x116B6, 0x116B6, GRAPHEME_SPACING_MARK},
+    {0x116B7, 0x116B7, GRAPHEME_CONJUNCT_EXTEND},
+    {0x1171D, 0x1171F, GRAPHEME_EXTEND},
+    {0x11722, 0x11725, GRAPHEME_EXTEND},
+    {0x11726, 0x11726, GRAPHEME_SPACING_MARK},
+    {0x11727, 0x1172A, GRAPHEME_EXTEND},
+    {0x1172B, 0x1172B, GRAPHEME_CONJUNCT_EXTEND},
+    {0x1182C, 0x1182E, GRAPHEME_SPACING_MARK},
+    {0x1182F, 0x11837, GRAPHEME_EXTEND},
+    {0x11838, 0x11838, GRAPHEME_SPACING_MARK},
+    {0x11839, 0x1183A, GRAPHEME_CONJUNCT_EXTEND},
+    {0x11930, 0x11930, GRAPHEME_EXTEND},
+    {0x11931, 0x11935, GRAPHEME_SPACING_MARK},
+    {0x11937, 0x11938, GRAPHEME_SPACING_MARK},
+    {0x1193B, 0x1193C, GRAPHEME_EXTEND},
+    {0x1193D, 0x1193D, GRAPHEME_SPACING_MARK},
+    {0x1193E, 0x1193E, GRAPHEME_CONJUNCT_EXTEND},
+    {0x1193F, 0x1193F, GRAPHEME_PREPEND},
+    {0x11940, 0x11940, GRAPHEME_SPACING_MARK},
+    {0x11941, 0x11941, GRAPHEME_PREPEND},
+    {0x11942, 0x11942, GRAPHEME_SPACING_MARK},
+    {0x11943, 0x11943, GRAPHEME_CONJUNCT_EXTEND},
+    {0x119D1, 0x119D3, GRAPHEME_SPACING_MARK},
+    {0x119D4, 0x119D7, GRAPHEME_EXTEND},
+    {0x119DA, 0x119DB, GRAPHEME_EXTEND},
+    {0x119DC, 0x119DF, GRAPHEME_SPACING_MARK},
+    {0x119E0, 0x119E0, GRAPHEME_CONJUNCT_EXTEND},
+    {0x119E4, 0x119E4, GRAPHEME_SPACING_MARK},
+    {0x11A01, 0x11A0A, GRAPHEME_EXTEND},
+    {0x11A33, 0x11A33, GRAPHEME_EXTEND},
+    {0x11A34, 0x11A34, GRAPHEME_CONJUNCT_EXTEND},
+    {0x11A35, 0x11A38, GRAPHEME_EXTEND},
+    {0x11A39, 0x11A39, GRAPHEME_SPACING_MARK},
+    {0x11A3A, 0x11A3A, GRAPHEME_PREPEND},
+    {0x11A3B, 0x11A3E, GRAPHEME_EXTEND},
+    {0x11A47, 0x11A47, GRAPHEME_CONJUNCT_EXTEND},
+    {0x11A51, 0x11A56, GRAPHEME_EXTEND},
+    {0x11A57, 0x11A58, GRAPHEME_SPACING_MARK},
+    {0x11A59, 0x11A5B, GRAPHEME_EXTEND},
+    {0x11A84, 0x11A89, GRAPHEME_PREPEND},
+    {0x11A8A, 0x11A96, GRAPHEME_EXTEND},
+    {0x11A97, 0x11A97, GRAPHEME_SPACING_MARK},
+    {0x11A98, 0x11A98, GRAPHEME_EXTEND},
+    {0x11A99, 0x11A99, GRAPHEME_CONJUNCT_EXTEND},
+    {0x11C2F, 0x11C2F, GRAPHEME_SPACING_MARK},
+    {0x11C30, 0x11C36, GRAPHEME_EXTEND},
+    {0x11C38, 0x11C3D, GRAPHEME_EXTEND},
+    {0x11C3E, 0x11C3E, GRAPHEME_SPACING_MARK},
+    {0x11C3F, 0x11C3F, GRAPHEME_CONJUNCT_EXTEND},
+    {0x11C92, 0x11CA7, GRAPHEME_EXTEND},
+    {0x11CA9, 0x11CA9, GRAPHEME_SPACING_MARK},
+    {0x11CAA, 0x11CB0, GRAPHEME_EXTEND},
+    {0x11CB1, 0x11CB1, GRAPHEME_SPACING_MARK},
+    {0x11CB2, 0x11CB3, GRAPHEME_EXTEND},
+    {0x11CB4, 0x11CB4, GRAPHEME_SPACING_MARK},
+    {0x11CB5, 0x11CB6, GRAPHEME_EXTEND},
+    {0x11D31, 0x11D36, GRAPHEME_EXTEND},
+    {0x11D3A, 0x11D3A, GRAPHEME_EXTEND},
+    {0x11D3C, 0x11D3D, GRAPHEME_EXTEND},
+    {0x11D3F, 0x11D41, GRAPHEME_EXTEND},
+    {0x11D42, 0x11D42, GRAPHEME_CONJUNCT_EXTEND},
+    {0x11D43, 0x11D43, GRAPHEME_EXTEND},
+    {0x11D44, 0x11D45, GRAPHEME_CONJUNCT_EXTEND},
+    {0x11D46, 0x11D46, GRAPHEME_PREPEND},
+    {0x11D47, 0x11D47, GRAPHEME_EXTEND},
+    {0x11D8A, 0x11D8E, GRAPHEME_SPACING_MARK},
+    {0x11D90, 0x11D91, GRAPHEME_EXTEND},
+    {0x11D93, 0x11D94, GRAPHEME_SPACING_MARK},
+    {0x11D95, 0x11D95, GRAPHEME_EXTEND},
+    {0x11D96, 0x11D96, GRAPHEME_SPACING_MARK},
+    {0x11D97, 0x11D97, GRAPHEME_CONJUNCT_EXTEND},
+    {0x11EF3, 0x11EF4, GRAPHEME_EXTEND},
+    {0x11EF5, 0x11EF6, GRAPHEME_SPACING_MARK},
+    {0x11F00, 0x11F01, GRAPHEME_EXTEND},
+    {0x11F02, 0x11F02, GRAPHEME_PREPEND},
+    {0x11F03, 0x11F03, GRAPHEME_SPACING_MARK},
+    {0x11F34, 0x11F35, GRAPHEME_SPACING_MARK},
+    {0x11F36, 0x11F3A, GRAPHEME_EXTEND},
+    {0x11F3E, 0x11F3F, GRAPHEME_SPACING_MARK},
+    {0x11F40, 0x11F40, GRAPHEME_EXTEND},
+    {0x11F41, 0x11F41, GRAPHEME_SPACING_MARK},
+    {0x11F42, 0x11F42, GRAPHEME_CONJUNCT_EXTEND},
+    {0x13430, 0x1343F, GRAPHEME_CONTROL},
+    {0x13440, 0x13440, GRAPHEME_EXTEND},
+    {0x13447, 0x13455, GRAPHEME_EXTEND},
+    {0x16AF0, 0x16AF4, GRAPHEME_CONJUNCT_EXTEND},
+    {0x16B30, 0x16B36, GRAPHEME_CONJUNCT_EXTEND},
+    {0x16F4F, 0x16F4F, GRAPHEME_EXTEND},
+    {0x16F51, 0x16F87, GRAPHEME_SPACING_MARK},
+    {0x16F8F, 0x16F92, GRAPHEME_EXTEND},
+    {0x16FE4, 0x16FE4, GRAPHEME_EXTEND},
+    {0x16FF0, 0x16FF1, GRAPHEME_SPACING_MARK},
+    {0x1BC9D, 0x1BC9D, GRAPHEME_EXTEND},
+    {0x1BC9E, 0x1BC9E, GRAPHEME_CONJUNCT_EXTEND},
+    {0x1BCA0, 0x1BCA3, GRAPHEME_CONTROL},
+    {0x1CF00, 0x1CF2D, GRAPHEME_EXTEND},
+    {0x1CF30, 0x1CF46, GRAPHEME_EXTEND},
+    {0x1D165, 0x1D165, GRAPHEME_CONJUNCT_EXTEND},
+    {0x1D166, 0x1D166, GRAPHEME_SPACING_MARK},
+    {0x1D167, 0x1D169, GRAPHEME_CONJUNCT_EXTEND},
+    {0x1D16D, 0x1D16D, GRAPHEME_SPACING_MARK},
+    {0x1D16E, 0x1D172, GRAPHEME_CONJUNCT_EXTEND},
+    {0x1D173, 0x1D17A, GRAPHEME_CONTROL},
+    {0x1D17B, 0x1D182, GRAPHEME_CONJUNCT_EXTEND},
+    {0x1D185, 0x1D18B, GRAPHEME_CONJUNCT_EXTEND},
+    {0x1D1AA, 0x1D1AD, GRAPHEME_CONJUNCT_EXTEND},
+    {0x1D242, 0x1D244, GRAPHEME_CONJUNCT_EXTEND},
+    {0x1DA00, 0x1DA36, GRAPHEME_EXTEND},
+    {0x1DA3B, 0x1DA6C, GRAPHEME_EXTEND},
+    {0x1DA75, 0x1DA75, GRAPHEME_EXTEND},
+    {0x1DA84, 0x1DA84, GRAPHEME_EXTEND},
+    {0x1DA9B, 0x1DA9F, GRAPHEME_EXTEND},
+    {0x1DAA1, 0x1DAAF, GRAPHEME_EXTEND},
+    {0x1E000, 0x1E006, GRAPHEME_CONJUNCT_EXTEND},
+    {0x1E008, 0x1E018, GRAPHEME_CONJUNCT_EXTEND},
+    {0x1E01B, 0x1E021, GRAPHEME_CONJUNCT_EXTEND},
+    {0x1E023, 0x1E024, GRAPHEME_CONJUNCT_EXTEND},
+    {0x1E026, 0x1E02A, GRAPHEME_CONJUNCT_EXTEND},
+    {0x1E08F, 0x1E08F, GRAPHEME_CONJUNCT_EXTEND},
+    {0x1E130, 0x1E136, GRAPHEME_CONJUNCT_EXTEND},
+    {0x1E2AE, 0x1E2AE, GRAPHEME_CONJUNCT_EXTEND},
+    {0x1E2EC, 0x1E2EF, GRAPHEME_CONJUNCT_EXTEND},
+    {0x1E4EC, 0x1E4EF, GRAPHEME_CONJUNCT_EXTEND},
+    {0x1E8D0, 0x1E8D6, GRAPHEME_CONJUNCT_EXTEND},
+    {0x1E944, 0x1E94A, GRAPHEME_CONJUNCT_EXTEND},
+    {0x1F000, 0x1F0FF, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x1F10D, 0x1F10F, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x1F12F, 0x1F12F, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x1F16C, 0x1F171, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x1F17E, 0x1F17F, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x1F18E, 0x1F18E, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x1F191, 0x1F19A, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x1F1AD, 0x1F1E5, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x1F1E6, 0x1F1FF, GRAPHEME_REGIONAL_INDICATOR},
+    {0x1F201, 0x1F20F, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x1F21A, 0x1F21A, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x1F22F, 0x1F22F, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x1F232, 0x1F23A, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x1F23C, 0x1F23F, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x1F249, 0x1F3FA, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x1F3FB, 0x1F3FF, GRAPHEME_EXTEND},
+    {0x1F400, 0x1F53D, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x1F546, 0x1F64F, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x1F680, 0x1F6FF, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x1F774, 0x1F77F, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x1F7D5, 0x1F7FF, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x1F80C, 0x1F80F, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x1F848, 0x1F84F, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x1F85A, 0x1F85F, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x1F888, 0x1F88F, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x1F8AE, 0x1F8FF, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x1F90C, 0x1F93A, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x1F93C, 0x1F945, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x1F947, 0x1FAFF, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0x1FC00, 0x1FFFD, GRAPHEME_EXTENDED_PICTOGRAPHIC},
+    {0xE0000, 0xE001F, GRAPHEME_CONTROL},
+    {0xE0020, 0xE007F, GRAPHEME_EXTEND},
+    {0xE0080, 0xE00FF, GRAPHEME_CONTROL},
+    {0xE0100, 0xE01EF, GRAPHEME_EXTEND},
+    {0xE01F0, 0xE0FFF, GRAPHEME_CONTROL},
+};
+
+}
+
+#endif // OBS_SPEECH2TEXT_PLUGIN_UNICODE_TABLES_H
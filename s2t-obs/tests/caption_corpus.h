@@ -0,0 +1,52 @@
+// Copyright 2022 gab
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef OBS_SPEECH2TEXT_PLUGIN_CAPTION_CORPUS_H
+#define OBS_SPEECH2TEXT_PLUGIN_CAPTION_CORPUS_H
+
+// Texts in the scripts captions come in, for the tests that split them into clusters and lines.
+
+// as captions come in, also conjuncts through a nukta or ZWJ, and a virama that doesn't link
+static const char *const CAPTION_CORPUS[] = {
+    // CJK
+    "\xE4\xBB\x8A\xE6\x97\xA5\xE3\x81\xAF\xE3\x80\x81\xE4\xB8\x96\xE7\x95\x8C\xEF\xBC\x81",
+    "\xE4\xBD\xA0\xE5\xA5\xBD\xEF\xBC\x8C\xE6\x88\x91\xE4\xBB\xAC\xE5\xBC\x80\xE5\xA7\x8B\xE5\x90\xA7",
+    // Hangul syllables and conjoining jamo
+    "\xEC\x95\x88\xEB\x85\x95\xED\x95\x98\xEC\x84\xB8\xEC\x9A\x94 \xE1\x84\x80\xE1\x85\xA1\xE1\x86\xA8\xE1\x84\x82\xE1\x85\xA1",
+    // Devanagari, Bengali, Tamil, Telugu, Malayalam, Sinhala conjuncts and vowel signs
+    "\xE0\xA4\xA8\xE0\xA4\xAE\xE0\xA4\xB8\xE0\xA5\x8D\xE0\xA4\xA4\xE0\xA5\x87 \xE0\xA4\x95\xE0\xA5\x8D\xE0\xA4\xB7\xE0\xA4\xBF\xE0\xA4\xA4\xE0\xA4\xBF",
+    "\xE0\xA4\x95\xE0\xA4\xBC\xE0\xA5\x8D\xE0\xA4\xB7 \xE0\xA4\x95\xE0\xA5\x8D\xE2\x80\x8D\xE0\xA4\xB7 \xE0\xA4\x85\xE0\xA5\x8D\xE0\xA4\x95",
+    "\xE0\xA6\xB8\xE0\xA7\x8D\xE0\xA6\xAC\xE0\xA6\xBE\xE0\xA6\x97\xE0\xA6\xA4\xE0\xA6\xAE",
+    "\xE0\xAE\xB5\xE0\xAE\xA3\xE0\xAE\x95\xE0\xAF\x8D\xE0\xAE\x95\xE0\xAE\xAE\xE0\xAF\x8D",
+    "\xE0\xB0\xA8\xE0\xB0\xAE\xE0\xB0\xB8\xE0\xB1\x8D\xE0\xB0\x95\xE0\xB0\xBE\xE0\xB0\xB0\xE0\xB0\x82",
+    "\xE0\xB4\xA8\xE0\xB4\xAE\xE0\xB4\xB8\xE0\xB5\x8D\xE0\xB4\x95\xE0\xB4\xBE\xE0\xB4\xB0\xE0\xB4\x82",
+    "\xE0\xB6\x86\xE0\xB6\xBA\xE0\xB7\x94\xE0\xB6\xB6\xE0\xB7\x9D\xE0\xB7\x80\xE0\xB6\xB1\xE0\xB7\x8A",
+    // Thai, Arabic with harakat and a prepended number sign, Hebrew points
+    "\xE0\xB8\xAA\xE0\xB8\xA7\xE0\xB8\xB1\xE0\xB8\xAA\xE0\xB8\x94\xE0\xB8\xB5\xE0\xB8\x84\xE0\xB8\xA3\xE0\xB8\xB1\xE0\xB8\x9A",
+    "\xD9\x85\xD9\x8E\xD8\xB1\xD9\x92\xD8\xAD\xD9\x8E\xD8\xA8\xD9\x8B\xD8\xA7 \xD8\x80\xD9\xA1\xD9\xA2",
+    "\xD7\xA9\xD6\xB8\xD7\x81\xD7\x9C\xD7\x95\xD6\xB9\xD7\x9D",
+    // combining marks, decomposed Vietnamese and stacked diacritics
+    "Vie\xCC\xA3\xCC\x82t Nam, cafe\xCC\x81, Z\xCD\x91\xCD\x97\xCD\x86" "a\xCC\x8A\xCC\x8Al\xCC\xB4go",
+    // emoji ZWJ sequences, skin tones, a broken sequence, keycap, flags, subdivision flag
+    "\xF0\x9F\x91\xA8\xE2\x80\x8D\xF0\x9F\x91\xA9\xE2\x80\x8D\xF0\x9F\x91\xA7\xE2\x80\x8D\xF0\x9F\x91\xA6 family",
+    "\xF0\x9F\x91\x8D\xF0\x9F\x8F\xBD\xF0\x9F\x91\xA9\xF0\x9F\x8F\xBF\xE2\x80\x8D\xF0\x9F\x9A\x80 a\xE2\x80\x8D\xF0\x9F\x98\x80",
+    "\xF0\x9F\x98\x80\xE2\x80\x8D\xE2\x80\x8D\xF0\x9F\x98\x80 \xF0\x9F\x98\x80\xCC\x81\xE2\x80\x8D\xF0\x9F\x98\x80",
+    "1\xEF\xB8\x8F\xE2\x83\xA3 \xE2\x9D\xA4\xEF\xB8\x8F\xE2\x80\x8D\xF0\x9F\x94\xA5",
+    "\xF0\x9F\x87\xA9\xF0\x9F\x87\xAA\xF0\x9F\x87\xAB\xF0\x9F\x87\xB7\xF0\x9F\x87\xBA",
+    "\xF0\x9F\x8F\xB4\xF3\xA0\x81\xA7\xF3\xA0\x81\xA2\xF3\xA0\x81\xB3\xF3\xA0\x81\xA3\xF3\xA0\x81\xB4\xF3\xA0\x81\xBF",
+    // line endings and controls
+    "one\r\ntwo\n\rthree\x01\xCC\x81",
+};
+
+#endif // OBS_SPEECH2TEXT_PLUGIN_CAPTION_CORPUS_H
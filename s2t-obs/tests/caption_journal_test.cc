@@ -0,0 +1,196 @@
+// Copyright 2022 gab
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+// Writes caption journals and reads them back: every record, seek(), read_range(), with the index, without one and
+// with a journal cut off by a crash. Built with -DS2T_OBS_BUILD_TESTS=ON, run by ctest.
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <QFile>
+#include <QTemporaryDir>
+
+#include "backend/caption_journal.h"
+#include "test_checks.h"
+
+using backend::CaptionJournalReader;
+using backend::CaptionJournalRecord;
+using backend::CaptionJournalWriter;
+using backend::OutputCaptionResult;
+using backend::RawResult;
+
+#define TEST_RECORDS 100
+#define TEST_RECORD_INTERVAL_MS 1000
+#define TEST_STARTED_AT_UNIX_MS 1650000000000LL
+
+static std::string caption_text(int i) {
+    return "caption " + std::to_string(i);
+}
+
+// records received 0, 1000, ... ms into the session, an index entry every 10
+static void write_journal(const QString &path, int records) {
+    const auto started_at = std::chrono::steady_clock::now();
+    CaptionJournalWriter writer(started_at);
+    EXPECT(writer.open(path, TEST_STARTED_AT_UNIX_MS));
+
+    for (int i = 0; i < records; i++) {
+        const auto received_at = started_at + std::chrono::milliseconds(i * TEST_RECORD_INTERVAL_MS);
+        auto raw = std::make_shared<const RawResult>(i, i % 2 == 0, 0.5, caption_text(i), "",
+                                                     received_at - std::chrono::milliseconds(300), received_at);
+        OutputCaptionResult result(raw, i == records - 1);
+        result.clean_caption_text = "clean " + std::to_string(i);
+        result.output_line = "line " + std::to_string(i);
+        writer.append(result);
+    }
+    EXPECT(writer.flush());
+    writer.close();
+    EXPECT(!writer.failed());
+}
+
+static std::vector<int> range_indices(CaptionJournalReader &reader, int64_t from_ms, int64_t to_ms) {
+    std::vector<CaptionJournalRecord> records;
+    EXPECT(reader.read_range(from_ms, to_ms, records));
+
+    std::vector<int> indices;
+    for (const auto &record: records)
+        indices.push_back(record.index);
+    return indices;
+}
+
+static void expect_range(CaptionJournalReader &reader, int64_t from_ms, int64_t to_ms, int first, int last) {
+    const std::vector<int> indices = range_indices(reader, from_ms, to_ms);
+    EXPECT_EQ((int) indices.size(), last - first + 1);
+    for (size_t i = 0; i < indices.size(); i++)
+        EXPECT_EQ(indices[i], first + (int) i);
+}
+
+static void test_round_trip(const QString &path) {
+    write_journal(path, TEST_RECORDS);
+
+    CaptionJournalReader reader;
+    EXPECT(reader.open(path));
+    EXPECT_EQ(reader.started_at_unix_ms(), TEST_STARTED_AT_UNIX_MS);
+
+    CaptionJournalRecord record;
+    int count = 0;
+    while (reader.next(record)) {
+        EXPECT_EQ(record.index, count);
+        EXPECT(record.final == (count % 2 == 0));
+        EXPECT(record.interrupted == (count == TEST_RECORDS - 1));
+        EXPECT(record.stability == 0.5);
+        EXPECT_EQ(record.received_ms, count * TEST_RECORD_INTERVAL_MS);
+        EXPECT_EQ(record.first_received_ms, count * TEST_RECORD_INTERVAL_MS - 300);
+        EXPECT(record.caption_text == caption_text(count));
+        EXPECT(record.clean_caption_text == "clean " + std::to_string(count));
+        EXPECT(record.output_line == "line " + std::to_string(count));
+        count++;
+    }
+    EXPECT_EQ(count, TEST_RECORDS);
+}
+
+static void test_seek_and_ranges(const QString &path) {
+    CaptionJournalReader reader;
+    EXPECT(reader.open(path));
+
+    CaptionJournalRecord record;
+    EXPECT(reader.seek(25500));
+    EXPECT(reader.next(record));
+    EXPECT_EQ(record.index, 26);
+
+    // exactly on an index entry, and back to the start after reading on
+    EXPECT(reader.seek(30000));
+    EXPECT(reader.next(record));
+    EXPECT_EQ(record.index, 30);
+    EXPECT(reader.seek(0));
+    EXPECT(reader.next(record));
+    EXPECT_EQ(record.index, 0);
+
+    EXPECT(reader.seek(TEST_RECORDS * TEST_RECORD_INTERVAL_MS));
+    EXPECT(!reader.next(record));
+
+    expect_range(reader, 30000, 35000, 30, 35);
+    expect_range(reader, 9999, 10001, 10, 10);
+    expect_range(reader, 0, INT64_MAX, 0, TEST_RECORDS - 1);
+    EXPECT(range_indices(reader, 12100, 12900).empty());
+}
+
+// a missing or broken index is rebuilt from the journal, the results stay the same
+static void test_index_rebuild(const QString &path) {
+    const QString index_path = backend::caption_journal_index_path(path);
+
+    EXPECT(QFile::remove(index_path));
+    {
+        CaptionJournalReader reader;
+        EXPECT(reader.open(path));
+        expect_range(reader, 45500, 61000, 46, 61);
+    }
+
+    QFile index_file(index_path);
+    EXPECT(index_file.open(QIODevice::WriteOnly));
+    index_file.write("not an index");
+    index_file.close();
+    {
+        CaptionJournalReader reader;
+        EXPECT(reader.open(path));
+        expect_range(reader, 45500, 61000, 46, 61);
+    }
+}
+
+static void test_truncated(const QString &directory) {
+    // where record 90 starts, from a journal that ends right before it
+    const QString shorter_path = directory + "/shorter.s2tj";
+    write_journal(shorter_path, 90);
+    const qint64 record_90_offset = QFile(shorter_path).size();
+
+    // the last record cut off in the middle: the journal ends before it
+    const QString cut_path = directory + "/cut.s2tj";
+    write_journal(cut_path, TEST_RECORDS);
+    EXPECT(QFile::resize(cut_path, QFile(cut_path).size() - 5));
+    {
+        CaptionJournalReader reader;
+        EXPECT(reader.open(cut_path));
+        expect_range(reader, 0, INT64_MAX, 0, TEST_RECORDS - 2);
+        expect_range(reader, 95000, INT64_MAX, 95, TEST_RECORDS - 2);
+    }
+
+    // the index was flushed ahead of the journal, which ends before record 90: its entry for there is past the end
+    EXPECT(QFile::resize(cut_path, record_90_offset));
+    {
+        CaptionJournalReader reader;
+        EXPECT(reader.open(cut_path));
+        expect_range(reader, 0, INT64_MAX, 0, 89);
+        expect_range(reader, 85000, INT64_MAX, 85, 89);
+        EXPECT(range_indices(reader, 90000, INT64_MAX).empty());
+    }
+
+    // cut into the header, not a journal anymore
+    EXPECT(QFile::resize(cut_path, 10));
+    CaptionJournalReader reader;
+    EXPECT(!reader.open(cut_path));
+}
+
+int main() {
+    QTemporaryDir directory;
+    EXPECT(directory.isValid());
+
+    const QString path = directory.path() + "/session.s2tj";
+    test_round_trip(path);
+    test_seek_and_ranges(path);
+    test_index_rebuild(path);
+    test_truncated(directory.path());
+    return test_result();
+}
@@ -0,0 +1,313 @@
+// Copyright 2022 gab
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+// Checks the grapheme clusters of utils::GraphemeCursor against ICU's break iterator, the UAX #29 reference the
+// tables are generated from: the property of every code point, every sequence of up to five code points of
+// distinct properties, and a corpus of the scripts captions come in. Then that splitting words over lines only
+// ever breaks between clusters. Built with -DS2T_OBS_BUILD_TESTS=ON when ICU is found, run by ctest, skipped when
+// ICU has another Unicode version than the tables.
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <unicode/ubrk.h>
+#include <unicode/uchar.h>
+#include <unicode/uscript.h>
+#include <unicode/utf16.h>
+
+// strings.h relies on its includers for these
+using std::string;
+using std::vector;
+typedef unsigned int uint;
+
+namespace utils {
+enum CapitalizationType {
+    CAPITALIZATION_NORMAL = 0,
+    CAPITALIZATION_ALL_CAPS = 1,
+    CAPITALIZATION_ALL_LOWERCASE = 2,
+};
+}
+
+#include "utils/strings.h"
+#include "caption_corpus.h"
+
+#define SKIP_RETURN_CODE 77
+
+static int failures = 0;
+
+static std::string utf8(const std::u32string &code_points) {
+    std::string output;
+    for (const char32_t cp: code_points) {
+        if (cp < 0x80) {
+            output.push_back((char) cp);
+        } else if (cp < 0x800) {
+            output.push_back((char) (0xC0 | (cp >> 6)));
+            output.push_back((char) (0x80 | (cp & 0x3F)));
+        } else if (cp < 0x10000) {
+            output.push_back((char) (0xE0 | (cp >> 12)));
+            output.push_back((char) (0x80 | ((cp >> 6) & 0x3F)));
+            output.push_back((char) (0x80 | (cp & 0x3F)));
+        } else {
+            output.push_back((char) (0xF0 | (cp >> 18)));
+            output.push_back((char) (0x80 | ((cp >> 12) & 0x3F)));
+            output.push_back((char) (0x80 | ((cp >> 6) & 0x3F)));
+            output.push_back((char) (0x80 | (cp & 0x3F)));
+        }
+    }
+    return output;
+}
+
+static std::u32string utf32(std::string_view text) {
+    std::u32string output;
+    size_t pos = 0;
+    char32_t cp;
+    while (pos < text.size()) {
+        utils::utf8_decode(text, pos, cp);
+        output.push_back(cp);
+    }
+    return output;
+}
+
+static std::string describe(const std::u32string &code_points) {
+    std::string output;
+    char hex[16];
+    for (const char32_t cp: code_points) {
+        snprintf(hex, sizeof(hex), "%sU+%04X", output.empty() ? "" : " ", (unsigned int) cp);
+        output.append(hex);
+    }
+    return output;
+}
+
+// code point offsets where clusters end
+static std::vector<size_t> icu_boundaries(UBreakIterator *iterator, const std::u32string &code_points) {
+    std::vector<UChar> utf16;
+    std::vector<size_t> code_point_at;  // UTF-16 offset -> code point offset
+    for (size_t i = 0; i < code_points.size(); i++) {
+        UChar units[2];
+        int32_t length = 0;
+        U16_APPEND_UNSAFE(units, length, (UChar32) code_points[i]);
+        for (int32_t j = 0; j < length; j++) {
+            utf16.push_back(units[j]);
+            code_point_at.push_back(i);
+        }
+    }
+    code_point_at.push_back(code_points.size());
+
+    UErrorCode status = U_ZERO_ERROR;
+    ubrk_setText(iterator, utf16.data(), (int32_t) utf16.size(), &status);
+    std::vector<size_t> boundaries;
+    for (int32_t at = ubrk_next(iterator); at != UBRK_DONE; at = ubrk_next(iterator))
+        boundaries.push_back(code_point_at[at]);
+    return boundaries;
+}
+
+static std::vector<size_t> cursor_boundaries(const std::string &text, unsigned int &utf16_units) {
+    utils::GraphemeCursor cursor(text);
+    std::vector<size_t> boundaries;
+    std::string_view cluster;
+    size_t code_points = 0;
+    utf16_units = 0;
+    while (const unsigned int units = cursor.next(cluster)) {
+        code_points += utf32(cluster).size();
+        utf16_units += units;
+        boundaries.push_back(code_points);
+    }
+    return boundaries;
+}
+
+static void expect_same_clusters(UBreakIterator *iterator, const std::u32string &code_points) {
+    unsigned int units;
+    const auto expected = icu_boundaries(iterator, code_points);
+    const auto actual = cursor_boundaries(utf8(code_points), units);
+    if (actual == expected)
+        return;
+
+    if (failures++ < 20) {
+        std::string expected_text, actual_text;
+        for (const size_t at: expected)
+            expected_text.append(" " + std::to_string(at));
+        for (const size_t at: actual)
+            actual_text.append(" " + std::to_string(at));
+        fprintf(stderr, "%s: clusters end at%s, expected%s\n", describe(code_points).c_str(), actual_text.c_str(),
+                expected_text.c_str());
+    }
+}
+
+// CLDR's Indic conjunct rule (GB9c) covers consonants and viramas of these
+static bool conjunct_script(char32_t cp) {
+    UErrorCode status = U_ZERO_ERROR;
+    const UScriptCode script = uscript_getScript((UChar32) cp, &status);
+    return script == USCRIPT_BENGALI || script == USCRIPT_DEVANAGARI || script == USCRIPT_GUJARATI
+           || script == USCRIPT_MALAYALAM || script == USCRIPT_ORIYA || script == USCRIPT_TELUGU;
+}
+
+static utils::GraphemeBreakProperty icu_property(char32_t cp) {
+    const int gcb = u_getIntPropertyValue((UChar32) cp, UCHAR_GRAPHEME_CLUSTER_BREAK);
+    if (conjunct_script(cp)) {
+        const int category = u_getIntPropertyValue((UChar32) cp, UCHAR_INDIC_SYLLABIC_CATEGORY);
+        if (category == U_INSC_CONSONANT && gcb == U_GCB_OTHER)
+            return utils::GRAPHEME_CONJUNCT_CONSONANT;
+        if (category == U_INSC_VIRAMA && gcb == U_GCB_EXTEND)
+            return utils::GRAPHEME_CONJUNCT_LINKER;
+    }
+    if (gcb == U_GCB_EXTEND && u_getCombiningClass((UChar32) cp) != 0)
+        return utils::GRAPHEME_CONJUNCT_EXTEND;
+
+    if (u_hasBinaryProperty((UChar32) cp, UCHAR_EXTENDED_PICTOGRAPHIC))
+        return utils::GRAPHEME_EXTENDED_PICTOGRAPHIC;
+
+    switch (gcb) {
+        case U_GCB_CR: return utils::GRAPHEME_CR;
+        case U_GCB_LF: return utils::GRAPHEME_LF;
+        case U_GCB_CONTROL: return utils::GRAPHEME_CONTROL;
+        case U_GCB_EXTEND: return utils::GRAPHEME_EXTEND;
+        case U_GCB_ZWJ: return utils::GRAPHEME_ZWJ;
+        case U_GCB_REGIONAL_INDICATOR: return utils::GRAPHEME_REGIONAL_INDICATOR;
+        case U_GCB_PREPEND: return utils::GRAPHEME_PREPEND;
+        case U_GCB_SPACING_MARK: return utils::GRAPHEME_SPACING_MARK;
+        case U_GCB_L: return utils::GRAPHEME_L;
+        case U_GCB_V: return utils::GRAPHEME_V;
+        case U_GCB_T: return utils::GRAPHEME_T;
+        case U_GCB_LV: return utils::GRAPHEME_LV;
+        case U_GCB_LVT: return utils::GRAPHEME_LVT;
+        default: return utils::GRAPHEME_OTHER;
+    }
+}
+
+// one code point of each property, the rules only look at properties
+static const char32_t REPRESENTATIVES[] = {
+    'a',        // Other
+    '\r',       // CR
+    '\n',       // LF
+    0x0001,     // Control
+    0x0301,     // Extend, combining acute accent
+    0x200D,     // ZWJ
+    0x1F1E9,    // Regional_Indicator
+    0x0600,     // Prepend, Arabic number sign
+    0x093F,     // SpacingMark, Devanagari vowel sign i
+    0x1100,     // L
+    0x1161,     // V
+    0x11A8,     // T
+    0xAC00,     // LV
+    0xAC01,     // LVT
+    0x1F468,    // Extended_Pictographic, man
+    0x0915,     // conjunct consonant, Devanagari ka
+    0x094D,     // conjunct linker, Devanagari virama
+    0x093C,     // conjunct extend, Devanagari nukta
+};
+
+// returns how many it checked
+static size_t sequences(UBreakIterator *iterator, std::u32string &sequence, size_t length) {
+    if (sequence.size() == length) {
+        expect_same_clusters(iterator, sequence);
+        return 1;
+    }
+
+    size_t checked = 0;
+    for (const char32_t cp: REPRESENTATIVES) {
+        sequence.push_back(cp);
+        checked += sequences(iterator, sequence, length);
+        sequence.pop_back();
+    }
+    return checked;
+}
+
+// words longer than a line are split between clusters, never inside one
+static void expect_lines_split_between_clusters(UBreakIterator *iterator, const std::string &word) {
+    const std::u32string code_points = utf32(word);
+    const auto boundaries = icu_boundaries(iterator, code_points);
+
+    for (uint max_line_length = 1; max_line_length <= 8; max_line_length++) {
+        std::vector<std::string> lines;
+        utils::split_into_lines_utf8_valid(lines, word, max_line_length);
+
+        size_t at = 0;
+        std::string joined;
+        for (const auto &line: lines) {
+            joined.append(line);
+            at += utf32(line).size();
+            if (!std::binary_search(boundaries.begin(), boundaries.end(), at) && failures++ < 20)
+                fprintf(stderr, "%s: line of %u ends inside a cluster, after %zu code points\n",
+                        describe(code_points).c_str(), max_line_length, at);
+        }
+        if (joined != word && failures++ < 20)
+            fprintf(stderr, "%s: lines of %u don't add up to the word\n", describe(code_points).c_str(), max_line_length);
+    }
+}
+
+int main() {
+    if (strcmp(U_UNICODE_VERSION, UNICODE_TABLES_VERSION) != 0) {
+        printf("ICU has Unicode %s, the tables are %s, regenerate them with tools/gen_unicode_tables.cc\n",
+               U_UNICODE_VERSION, UNICODE_TABLES_VERSION);
+        return SKIP_RETURN_CODE;
+    }
+
+    UErrorCode status = U_ZERO_ERROR;
+    UBreakIterator *iterator = ubrk_open(UBRK_CHARACTER, "", nullptr, 0, &status);
+    if (U_FAILURE(status)) {
+        fprintf(stderr, "couldn't open ICU's break iterator: %s\n", u_errorName(status));
+        return 1;
+    }
+
+    size_t checked = 0;
+    for (char32_t cp = 0; cp <= 0x10FFFF; cp++) {
+        if (cp >= 0xD800 && cp <= 0xDFFF)
+            continue;
+
+        checked++;
+        const auto expected = icu_property(cp);
+        const auto actual = utils::grapheme_break_property(cp);
+        if (actual != expected && failures++ < 20)
+            fprintf(stderr, "U+%04X has property %d, expected %d\n", (unsigned int) cp, (int) actual, (int) expected);
+    }
+    printf("%zu code points\n", checked);
+
+    std::u32string sequence;
+    checked = 0;
+    for (size_t length = 1; length <= 5; length++)
+        checked += sequences(iterator, sequence, length);
+    printf("%zu sequences\n", checked);
+
+    for (const char *text: CAPTION_CORPUS) {
+        const std::u32string code_points = utf32(text);
+        expect_same_clusters(iterator, code_points);
+
+        std::string word;
+        for (const char32_t cp: code_points) {
+            if (utils::is_unicode_space(cp)) {
+                if (!word.empty())
+                    expect_lines_split_between_clusters(iterator, word);
+                word.clear();
+            } else {
+                word.append(utf8(std::u32string(1, cp)));
+            }
+        }
+        if (!word.empty())
+            expect_lines_split_between_clusters(iterator, word);
+    }
+    printf("%zu corpus texts\n", sizeof(CAPTION_CORPUS) / sizeof(CAPTION_CORPUS[0]));
+
+    ubrk_close(iterator);
+
+    if (failures) {
+        fprintf(stderr, "%d checks failed\n", failures);
+        return 1;
+    }
+    return 0;
+}
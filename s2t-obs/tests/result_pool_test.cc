@@ -0,0 +1,97 @@
+// Copyright 2022 gab
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+// Checks that a warmed up ResultPool hands out results without a heap allocation, the texts being moved in.
+// Built with -DS2T_OBS_BUILD_TESTS=ON, run by ctest.
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "backend/result_pool.h"
+#include "test_checks.h"
+
+// every operator new of the process, whoever makes it
+static std::atomic<uint64_t> new_calls{0};
+
+void *operator new(size_t bytes) {
+    new_calls.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(bytes ? bytes : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void *p, size_t) noexcept {
+    std::free(p);
+}
+
+#define RESULTS_IN_FLIGHT 8
+#define RESULTS 10000
+
+
+static backend::RawResult make_raw_result(int index) {
+    // long enough to not fit the small string buffer, moving them must not copy
+    return backend::RawResult(index, index % 4 == 0, 0.5,
+                              std::string(64, 'a' + index % 26), std::string(128, 'm'),
+                              std::chrono::steady_clock::now(), std::chrono::steady_clock::now());
+}
+
+int main() {
+    auto pool = backend::ResultPool::create();
+
+    // a window of results in flight, the oldest released once the newest is made, like the pipeline does
+    std::vector<backend::RawResultPtr> in_flight(RESULTS_IN_FLIGHT);
+
+    // warm up, like the first results of a session. One block more than in flight, for the one being made
+    for (int i = 0; i < 2 * RESULTS_IN_FLIGHT; i++)
+        in_flight[i % RESULTS_IN_FLIGHT] = pool->make(make_raw_result(i));
+    const backend::ResultPoolStats warmed = pool->stats();
+    EXPECT_EQ(warmed.heap_allocations, (uint64_t) RESULTS_IN_FLIGHT + 1);
+
+    std::vector<backend::RawResult> raw_results;
+    raw_results.reserve(RESULTS);
+    for (int i = 0; i < RESULTS; i++)
+        raw_results.push_back(make_raw_result(i));
+
+    const uint64_t new_calls_before = new_calls.load();
+    for (int i = 0; i < RESULTS; i++)
+        in_flight[i % RESULTS_IN_FLIGHT] = pool->make(std::move(raw_results[i]));
+    const uint64_t new_calls_after = new_calls.load();
+
+    const backend::ResultPoolStats stats = pool->stats();
+    EXPECT_EQ(stats.results - warmed.results, (uint64_t) RESULTS);
+    EXPECT_EQ(stats.heap_allocations - warmed.heap_allocations, (uint64_t) 0);
+    EXPECT_EQ(new_calls_after - new_calls_before, (uint64_t) 0);
+    EXPECT_EQ(in_flight[0]->caption_text.size(), (size_t) 64);
+
+    // results keep the pool alive after the session let go of it
+    backend::RawResultPtr outliving = in_flight[1];
+    in_flight.clear();
+    pool.reset();
+    EXPECT_EQ(outliving->raw_message.size(), (size_t) 128);
+
+    if (test_failures)
+        return test_result();
+    printf("%d results, %llu heap allocations after warming up\n", RESULTS,
+           (unsigned long long) (stats.heap_allocations - warmed.heap_allocations));
+    return 0;
+}
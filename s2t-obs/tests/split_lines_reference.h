@@ -0,0 +1,98 @@
+// Copyright 2022 gab
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef OBS_SPEECH2TEXT_PLUGIN_SPLIT_LINES_REFERENCE_H
+#define OBS_SPEECH2TEXT_PLUGIN_SPLIT_LINES_REFERENCE_H
+
+// The Qt line splitter utils::split_into_lines() used for non ASCII text before it went UTF-8 and table based, kept
+// for split_lines_reference_test.cc only. As it was, but for QRegExp, which Qt 6 only has in Core5Compat: split on
+// QRegularExpression("\\s+") instead, the same after simplified().
+
+#include <string>
+#include <vector>
+
+#include <QRegularExpression>
+#include <QString>
+#include <QStringList>
+#include <QTextBoundaryFinder>
+#include <QVector>
+
+namespace reference {
+
+static void splitSmallest(QVector<QString> &out_chars, const QString &word) {
+    QTextBoundaryFinder test(QTextBoundaryFinder::Grapheme, word);
+    int start = 0;
+    while (test.toNextBoundary() != -1 && test.position() <= word.length()) {
+        out_chars.push_back(word.mid(start, test.position() - start));
+        start = test.position();
+    }
+}
+
+static void split_into_lines_unicode_ish(std::vector<std::string> &output_lines, const std::string &text,
+                                         const unsigned int max_line_length) {
+    QString qtext = QString::fromStdString(text).simplified();
+
+    QStringList words = qtext.split(QRegularExpression("\\s+"));
+
+    QString line;
+    for (auto word: words) {
+
+        int new_len = line.size() + (line.isEmpty() ? 0 : 1) + word.size();
+        if (new_len <= max_line_length) {
+            // still fits into line
+            if (!line.isEmpty())
+                line.append(" ");
+            line.append(word);
+        } else {
+            if (word.length() > max_line_length) {
+                // current word longer than single line, split
+
+                if (!line.isEmpty()) {
+                    if (line.length() + 2 <= max_line_length) {
+                        // enough space for " " and more
+                        line.append(" ");
+                    } else {
+                        // current line is full (or would be with added space),
+                        // add it and clear
+                        output_lines.push_back(line.toStdString());
+                        line = "";
+                    }
+                }
+
+                QVector<QString> gms;
+                splitSmallest(gms, word);
+
+                for (auto i: gms) {
+                    if (line.length() + i.length() <= max_line_length) {
+                        line.append(i);
+                    } else {
+                        output_lines.push_back(line.toStdString());
+                        line = i;
+                    }
+                }
+            } else {
+                if (!line.isEmpty())
+                    output_lines.push_back(line.toStdString());
+                line = word;
+            }
+        }
+    }
+
+    if (!line.isEmpty())
+        output_lines.push_back(line.toStdString());
+}
+
+}
+
+#endif // OBS_SPEECH2TEXT_PLUGIN_SPLIT_LINES_REFERENCE_H
@@ -0,0 +1,146 @@
+// Copyright 2022 gab
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+// Compares utils::split_into_lines() with the Qt splitter it replaced for non ASCII text, see
+// split_lines_reference.h, on the caption corpus and a few whitespace runs. Built with -DS2T_OBS_BUILD_TESTS=ON,
+// run by ctest.
+//
+// Lines have to be the same, but for two deliberate differences, which are listed when they come up:
+// - clusters: words longer than a line are split between UAX #29 extended grapheme clusters as of the tables'
+//   Unicode version, with GB9c for Indic conjuncts, QTextBoundaryFinder draws them as the Qt version at hand does.
+//   Only allowed where a word doesn't fit a line, and the lines still have to hold the same text.
+// - empty lines: a cluster wider than a whole line went onto a line of its own after an empty one, now without
+//   the empty one.
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// strings.h relies on its includers for these
+using std::string;
+using std::vector;
+typedef unsigned int uint;
+
+namespace utils {
+enum CapitalizationType {
+    CAPITALIZATION_NORMAL = 0,
+    CAPITALIZATION_ALL_CAPS = 1,
+    CAPITALIZATION_ALL_LOWERCASE = 2,
+};
+}
+
+#include "utils/strings.h"
+#include "caption_corpus.h"
+#include "split_lines_reference.h"
+#include "test_checks.h"
+
+#define MAX_TESTED_LINE_LENGTH 24
+#define LISTED_DIFFERENCES 10
+
+// whitespace the splitters have to agree on: tabs, line breaks, no-break and ideographic spaces, runs of them
+static const char *const WHITESPACE_TEXTS[] = {
+    "  caf\xC3\xA9\tau lait\xC2\xA0noir \xE3\x80\x80 fin  ",
+    "\xC3\xBC" "ber\n\nstra\xC3\x9F" "e \xE2\x80\x94 ok\xE2\x80\x83x\xE2\x80\xA8y",
+    "\xE3\x80\x80\xE3\x80\x80",
+};
+
+// longest run of non whitespace, in UTF-16 code units like the line lengths
+static uint longest_word_length(std::string_view text) {
+    uint longest = 0;
+    uint length = 0;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        char32_t cp;
+        utils::utf8_decode(text, pos, cp);
+        length = utils::is_unicode_space(cp) ? 0 : length + utils::utf16_length(cp);
+        longest = std::max(longest, length);
+    }
+    return longest;
+}
+
+static std::string joined(const std::vector<std::string> &lines, const char *separator) {
+    std::string output;
+    for (size_t i = 0; i < lines.size(); i++) {
+        if (i)
+            output.append(separator);
+        output.append(lines[i]);
+    }
+    return output;
+}
+
+static std::string without_spaces(const std::vector<std::string> &lines) {
+    std::string output = joined(lines, "");
+    output.erase(std::remove(output.begin(), output.end(), ' '), output.end());
+    return output;
+}
+
+static int cluster_differences = 0;
+static int empty_line_differences = 0;
+
+static void list_difference(const char *kind, const std::string &text, uint max_line_length,
+                            const std::vector<std::string> &lines, const std::vector<std::string> &reference_lines) {
+    printf("%s, lines of %u for \"%s\":\n  now    \"%s\"\n  before \"%s\"\n", kind, max_line_length, text.c_str(),
+           joined(lines, "|").c_str(), joined(reference_lines, "|").c_str());
+}
+
+static void compare(const std::string &text) {
+    const uint longest_word = longest_word_length(text);
+
+    for (uint max_line_length = 1; max_line_length <= MAX_TESTED_LINE_LENGTH; max_line_length++) {
+        std::vector<std::string> lines;
+        utils::split_into_lines(lines, text, max_line_length);
+        std::vector<std::string> reference_lines;
+        reference::split_into_lines_unicode_ish(reference_lines, text, max_line_length);
+        if (lines == reference_lines)
+            continue;
+
+        std::vector<std::string> reference_without_empty;
+        for (const auto &line: reference_lines) {
+            if (!line.empty())
+                reference_without_empty.push_back(line);
+        }
+        if (lines == reference_without_empty) {
+            if (empty_line_differences++ < LISTED_DIFFERENCES)
+                list_difference("empty line", text, max_line_length, lines, reference_lines);
+            continue;
+        }
+
+        // every word fits a line, clusters don't come into it
+        EXPECT(longest_word > max_line_length);
+        EXPECT(without_spaces(lines) == without_spaces(reference_lines));
+        if (cluster_differences++ < LISTED_DIFFERENCES)
+            list_difference("clusters", text, max_line_length, lines, reference_lines);
+    }
+}
+
+int main() {
+    int compared = 0;
+    for (const char *text: CAPTION_CORPUS) {
+        // ASCII goes through split_into_lines_ascii(), which the Qt splitter never did
+        if (utils::is_ascii(text))
+            continue;
+        compare(text);
+        compared++;
+    }
+    for (const char *text: WHITESPACE_TEXTS) {
+        compare(text);
+        compared++;
+    }
+
+    printf("%d texts, lines of 1 to %d: %d split differently between clusters, %d without an empty line\n",
+           compared, MAX_TESTED_LINE_LENGTH, cluster_differences, empty_line_differences);
+    return test_result();
+}
@@ -0,0 +1,54 @@
+// Copyright 2022 gab
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef OBS_SPEECH2TEXT_PLUGIN_TEST_CHECKS_H
+#define OBS_SPEECH2TEXT_PLUGIN_TEST_CHECKS_H
+
+#include <cstdio>
+
+// Checks for the tests in tests/, each is a plain executable ctest runs. A failed check is reported and counted,
+// the test goes on, main() returns test_result().
+
+static int test_failures = 0;
+
+#define EXPECT(condition) \
+    do { \
+        if (!(condition)) { \
+            fprintf(stderr, "%s:%d: expected %s\n", __FILE__, __LINE__, #condition); \
+            test_failures++; \
+        } \
+    } while (0)
+
+// for integers
+#define EXPECT_EQ(actual, expected) \
+    do { \
+        const auto actual_ = (actual); \
+        const auto expected_ = (expected); \
+        if (actual_ != expected_) { \
+            fprintf(stderr, "%s:%d: %s is %lld, expected %lld\n", __FILE__, __LINE__, #actual, \
+                    (long long) actual_, (long long) expected_); \
+            test_failures++; \
+        } \
+    } while (0)
+
+static int test_result() {
+    if (!test_failures)
+        return 0;
+
+    fprintf(stderr, "%d checks failed\n", test_failures);
+    return 1;
+}
+
+#endif // OBS_SPEECH2TEXT_PLUGIN_TEST_CHECKS_H
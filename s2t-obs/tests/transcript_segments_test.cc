@@ -0,0 +1,148 @@
+// Copyright 2022 gab
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+// Checks when TranscriptSegmenter rolls a transcript over into its next segment. Built with
+// -DS2T_OBS_BUILD_TESTS=ON, run by ctest.
+
+#include <chrono>
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+
+#include "backend/transcript_segments.h"
+#include "test_checks.h"
+
+using backend::TranscriptSegmenter;
+using backend::TranscriptSegmentSettings;
+using backend::TranscriptSink;
+
+typedef std::chrono::steady_clock::time_point MonoTP;
+
+// what TranscriptFormatWriter::wake_at() asks for, without cues
+static MonoTP wake_at(const TranscriptSegmenter &segmenter, const TranscriptSink &sink) {
+    return std::min(sink.flush_due_at(), segmenter.due_at(sink));
+}
+
+static void append_entry(TranscriptSink &sink, const char *entry) {
+    sink.append_buffer().append(entry);
+    sink.entry_appended();
+}
+
+// a quiet stretch longer than a segment must not leave the writer with a wake up in the past, the output
+// executor would spin on it
+static void test_empty_segment_past_its_time(const QString &directory, bool header) {
+    const MonoTP started_at = std::chrono::steady_clock::now();
+    TranscriptSegmentSettings settings;
+    settings.max_minutes = 1;
+    TranscriptSegmenter segmenter(settings, started_at, std::chrono::system_clock::now(), nullptr);
+
+    TranscriptSink sink;
+    const QString first_path = segmenter.begin(directory + (header ? "/quiet.vtt" : "/quiet.srt"),
+                                               header ? "vtt" : "srt", started_at);
+    EXPECT(sink.open(first_path, true));
+    if (header)
+        append_entry(sink, "WEBVTT\n\n");
+    segmenter.header_written(sink);
+
+    const MonoTP an_hour_later = started_at + std::chrono::minutes(60);
+    sink.flush();
+    EXPECT(segmenter.due_at(sink) == MonoTP::max());
+    EXPECT(wake_at(segmenter, sink) == MonoTP::max());
+    EXPECT(!segmenter.due(an_hour_later, sink));
+
+    // the first caption after the quiet hour goes into the segment, which rolls over right after it
+    append_entry(sink, "1\n00:59:59,000 --> 01:00:00,000\nhello\n\n");
+    EXPECT(segmenter.due_at(sink) == started_at + std::chrono::minutes(1));
+    EXPECT(segmenter.due(an_hour_later, sink));
+
+    const QString next_path = segmenter.next(an_hour_later, sink);
+    EXPECT(next_path != first_path);
+    EXPECT(sink.open(next_path, true));
+    segmenter.header_written(sink);
+    EXPECT(segmenter.due_at(sink) == MonoTP::max());
+    EXPECT(!segmenter.due(an_hour_later + std::chrono::minutes(60), sink));
+
+    segmenter.finish(an_hour_later, sink);
+}
+
+static void test_size_limit(const QString &directory) {
+    const MonoTP started_at = std::chrono::steady_clock::now();
+    TranscriptSegmentSettings settings;
+    settings.max_megabytes = 1;
+    TranscriptSegmenter segmenter(settings, started_at, std::chrono::system_clock::now(), nullptr);
+
+    TranscriptSink sink;
+    EXPECT(sink.open(segmenter.begin(directory + "/big.txt", "txt", started_at), true));
+    segmenter.header_written(sink);
+    EXPECT(segmenter.due_at(sink) == MonoTP::max());
+
+    const std::string line(1024, 'x');
+    for (int i = 0; i < 1023; i++)
+        append_entry(sink, line.c_str());
+    EXPECT(!segmenter.due(started_at, sink));
+    append_entry(sink, line.c_str());
+    EXPECT(segmenter.due(started_at, sink));
+
+    segmenter.finish(started_at, sink);
+}
+
+static QJsonObject read_manifest(const QString &path) {
+    QFile file(path);
+    EXPECT(file.open(QIODevice::ReadOnly));
+    return QJsonDocument::fromJson(file.readAll()).object();
+}
+
+// formats written next to the same base name keep their segments in manifests of their own
+static void test_manifest_per_format(const QString &directory) {
+    const MonoTP started_at = std::chrono::steady_clock::now();
+    TranscriptSegmentSettings settings;
+    settings.max_minutes = 1;
+
+    for (const char *format: {"srt", "vtt"}) {
+        TranscriptSegmenter segmenter(settings, started_at, std::chrono::system_clock::now(), nullptr);
+        TranscriptSink sink;
+        EXPECT(sink.open(segmenter.begin(directory + "/show." + format, format, started_at), true));
+        segmenter.header_written(sink);
+        append_entry(sink, "hello\n");
+        EXPECT(sink.open(segmenter.next(started_at + std::chrono::minutes(1), sink), true));
+        segmenter.header_written(sink);
+        append_entry(sink, "again\n");
+        segmenter.finish(started_at + std::chrono::minutes(2), sink);
+    }
+
+    const QJsonObject srt = read_manifest(directory + "/show.srt.segments.json");
+    EXPECT(srt.value("format").toString() == "srt");
+    EXPECT_EQ(srt.value("segments").toArray().size(), 2);
+    EXPECT(srt.value("segments").toArray().at(0).toObject().value("file").toString() == "show_001.srt");
+
+    const QJsonObject vtt = read_manifest(directory + "/show.vtt.segments.json");
+    EXPECT(vtt.value("format").toString() == "vtt");
+    EXPECT_EQ(vtt.value("segments").toArray().size(), 2);
+    EXPECT(vtt.value("segments").toArray().at(1).toObject().value("file").toString() == "show_002.vtt");
+}
+
+int main() {
+    QTemporaryDir directory;
+    EXPECT(directory.isValid());
+
+    test_empty_segment_past_its_time(directory.path(), false);
+    test_empty_segment_past_its_time(directory.path(), true);
+    test_size_limit(directory.path());
+    test_manifest_per_format(directory.path());
+    return test_result();
+}
@@ -0,0 +1,187 @@
+// Copyright 2022 gab
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+// Writes src/utils/unicode_tables.h from the Unicode character database as compiled into ICU:
+//
+//   gen_unicode_tables > src/utils/unicode_tables.h
+//
+// Regenerate with the ICU of the Unicode version to move to, grapheme_test checks the result against it.
+// Built with -DS2T_OBS_BUILD_TESTS=ON when ICU is found.
+
+#include <cstdio>
+#include <vector>
+
+#include <unicode/uchar.h>
+#include <unicode/uscript.h>
+#include <unicode/uvernum.h>
+
+// as named in unicode.h
+static const char *const PROPERTY_NAMES[] = {
+    "GRAPHEME_OTHER",
+    "GRAPHEME_CR",
+    "GRAPHEME_LF",
+    "GRAPHEME_CONTROL",
+    "GRAPHEME_EXTEND",
+    "GRAPHEME_ZWJ",
+    "GRAPHEME_REGIONAL_INDICATOR",
+    "GRAPHEME_PREPEND",
+    "GRAPHEME_SPACING_MARK",
+    "GRAPHEME_L",
+    "GRAPHEME_V",
+    "GRAPHEME_T",
+    "GRAPHEME_LV",
+    "GRAPHEME_LVT",
+    "GRAPHEME_EXTENDED_PICTOGRAPHIC",
+    "GRAPHEME_CONJUNCT_CONSONANT",
+    "GRAPHEME_CONJUNCT_LINKER",
+    "GRAPHEME_CONJUNCT_EXTEND",
+};
+
+enum Property {
+    OTHER, CR, LF, CONTROL, EXTEND, ZWJ, REGIONAL_INDICATOR, PREPEND, SPACING_MARK, L, V, T, LV, LVT,
+    EXTENDED_PICTOGRAPHIC, CONJUNCT_CONSONANT, CONJUNCT_LINKER, CONJUNCT_EXTEND,
+};
+
+// where CLDR keeps consonants joined by a virama in one cluster, Unicode 15.1 made that GB9c
+static bool conjunct_script(UChar32 cp) {
+    UErrorCode status = U_ZERO_ERROR;
+    switch (uscript_getScript(cp, &status)) {
+        case USCRIPT_BENGALI:
+        case USCRIPT_DEVANAGARI:
+        case USCRIPT_GUJARATI:
+        case USCRIPT_MALAYALAM:
+        case USCRIPT_ORIYA:
+        case USCRIPT_TELUGU:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static int property(UChar32 cp) {
+    const bool pictographic = u_hasBinaryProperty(cp, UCHAR_EXTENDED_PICTOGRAPHIC);
+    int gcb;
+    switch (u_getIntPropertyValue(cp, UCHAR_GRAPHEME_CLUSTER_BREAK)) {
+        case U_GCB_CR: gcb = CR; break;
+        case U_GCB_LF: gcb = LF; break;
+        case U_GCB_CONTROL: gcb = CONTROL; break;
+        case U_GCB_EXTEND: gcb = EXTEND; break;
+        case U_GCB_ZWJ: gcb = ZWJ; break;
+        case U_GCB_REGIONAL_INDICATOR: gcb = REGIONAL_INDICATOR; break;
+        case U_GCB_PREPEND: gcb = PREPEND; break;
+        case U_GCB_SPACING_MARK: gcb = SPACING_MARK; break;
+        case U_GCB_L: gcb = L; break;
+        case U_GCB_V: gcb = V; break;
+        case U_GCB_T: gcb = T; break;
+        case U_GCB_LV: gcb = LV; break;
+        case U_GCB_LVT: gcb = LVT; break;
+        default: gcb = OTHER; break;
+    }
+
+    if (conjunct_script(cp)) {
+        const int category = u_getIntPropertyValue(cp, UCHAR_INDIC_SYLLABIC_CATEGORY);
+        if (category == U_INSC_CONSONANT && gcb == OTHER && !pictographic)
+            return CONJUNCT_CONSONANT;
+        if (category == U_INSC_VIRAMA && gcb == EXTEND)
+            return CONJUNCT_LINKER;
+    }
+    if (gcb == EXTEND && u_getCombiningClass(cp) != 0)
+        return CONJUNCT_EXTEND;
+
+    if (!pictographic)
+        return gcb;
+
+    // one property per code point in the table
+    if (gcb != OTHER) {
+        fprintf(stderr, "U+%04X is Extended_Pictographic and %s\n", (unsigned int) cp, PROPERTY_NAMES[gcb]);
+        return -1;
+    }
+    return EXTENDED_PICTOGRAPHIC;
+}
+
+struct Range {
+    UChar32 first;
+    UChar32 last;
+    int property;
+};
+
+int main() {
+    std::vector<Range> ranges;
+    for (UChar32 cp = 0; cp <= 0x10FFFF; cp++) {
+        const int cp_property = property(cp);
+        if (cp_property < 0)
+            return 1;
+
+        // Hangul syllables are computed, see grapheme_break_property()
+        const bool syllable = cp >= 0xAC00 && cp <= 0xD7A3;
+        if (cp_property == LV || cp_property == LVT) {
+            if (!syllable || (cp_property == LV) != ((cp - 0xAC00) % 28 == 0)) {
+                fprintf(stderr, "U+%04X is %s outside of the computed Hangul syllables\n", (unsigned int) cp,
+                        PROPERTY_NAMES[cp_property]);
+                return 1;
+            }
+            continue;
+        }
+        if (syllable || cp_property == OTHER)
+            continue;
+
+        if (!ranges.empty() && ranges.back().last == cp - 1 && ranges.back().property == cp_property)
+            ranges.back().last = cp;
+        else
+            ranges.push_back({cp, cp, cp_property});
+    }
+
+    // same license header as the sources
+    printf("// Copyright 2022 gab\n");
+    printf("// \n");
+    printf("// Licensed under the Apache License, Version 2.0 (the \"License\");\n");
+    printf("// you may not use this file except in compliance with the License.\n");
+    printf("// You may obtain a copy of the License at\n");
+    printf("// \n");
+    printf("//     http://www.apache.org/licenses/LICENSE-2.0\n");
+    printf("// \n");
+    printf("// Unless required by applicable law or agreed to in writing, software\n");
+    printf("// distributed under the License is distributed on an \"AS IS\" BASIS,\n");
+    printf("// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.\n");
+    printf("// See the License for the specific language governing permissions and\n");
+    printf("// limitations under the License.\n\n");
+    printf("// Generated by tools/gen_unicode_tables.cc from the Unicode %s character database of ICU %s, don't edit.\n\n",
+           U_UNICODE_VERSION, U_ICU_VERSION);
+    printf("#ifndef OBS_SPEECH2TEXT_PLUGIN_UNICODE_TABLES_H\n");
+    printf("#define OBS_SPEECH2TEXT_PLUGIN_UNICODE_TABLES_H\n\n");
+    printf("namespace utils {\n\n");
+    printf("#define UNICODE_TABLES_VERSION \"%s\"\n\n", U_UNICODE_VERSION);
+    printf("// Grapheme_Cluster_Break, and Extended_Pictographic from emoji-data.txt, which never overlap.\n");
+    printf("// Other and the Hangul syllables (LV, LVT) are left out.\n");
+    printf("// For the Indic conjunct rule (GB9c): consonants of the scripts it covers, taken out of Other, and their\n");
+    printf("// viramas and the other Extend code points with a non zero combining class, taken out of Extend.\n");
+    printf("enum GraphemeBreakProperty {\n");
+    for (const char *name: PROPERTY_NAMES)
+        printf("    %s,\n", name);
+    printf("};\n\n");
+    printf("struct GraphemeBreakRange {\n");
+    printf("    char32_t first;\n");
+    printf("    char32_t last;\n");
+    printf("    GraphemeBreakProperty property;\n");
+    printf("};\n\n");
+    printf("static const GraphemeBreakRange GRAPHEME_BREAK_RANGES[] = {\n");
+    for (const Range &range: ranges)
+        printf("    {0x%04X, 0x%04X, %s},\n", (unsigned int) range.first, (unsigned int) range.last,
+               PROPERTY_NAMES[range.property]);
+    printf("};\n\n");
+    printf("}\n\n");
+    printf("#endif // OBS_SPEECH2TEXT_PLUGIN_UNICODE_TABLES_H\n");
+    return 0;
+}